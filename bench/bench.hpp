@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Microbenchmarks of the games' hot paths. Each game has a suite in bench/<game>-bench.cpp that
+// compiles the game in (without its main, see BOMAQS_NO_MAIN) and times its functions at a few data
+// sizes.
+//
+// A bench is a call run in batches: the batch doubles until it takes BENCH_BATCH_SECONDS, then
+// BENCH_BATCHES batches are timed and the fastest one is kept, noise only ever adds time. Results
+// are ns per call, or per item for benches that pass how many items a call goes over. Benches that
+// change their input restore it inside the call, that's part of the time and the same in every
+// run, comparisons against a baseline stay fair.
+//
+// Suites print a table and write results to the JSON file they're given, one result per line:
+//   {"suite": "...", "name": "...", "size": 100, "ns_per_op": 123.4, "calls": 65536}
+// bench-compare reads those against a stored baseline.
+
+#define BENCH_BATCH_SECONDS 0.02
+#define BENCH_BATCHES 7
+#define BENCH_MAX_BATCH (1LL << 30)
+
+namespace bomaqs {
+
+typedef struct {
+  std::string name;
+  int size;  // entities, bullets, words, ... whatever the bench scales with
+  double ns_per_op;
+  long long calls;  // per batch
+} BenchResult;
+
+typedef struct {
+  std::string suite;
+  std::string filter;  // only benches whose name contains it
+  std::vector<BenchResult> results;
+} BenchRun;
+
+// Makes value look used, so the compiler can't drop the call that computed it
+template <typename T>
+inline void bench_keep(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static const void *volatile sink;
+  sink = &value;
+#endif
+}
+
+inline double bench_now() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(now).count();
+}
+
+template <typename Call>
+inline double time_bench_batch(Call &call, long long calls) {
+  double start = bench_now();
+  for (long long i = 0; i < calls; i++) {
+    call();
+  }
+  return bench_now() - start;
+}
+
+template <typename Call>
+inline void run_bench(BenchRun &run, std::string name, int size, Call call, int items = 1) {
+  if (!run.filter.empty() && name.find(run.filter) == std::string::npos) {
+    return;
+  }
+
+  long long calls = 1;
+  while (time_bench_batch(call, calls) < BENCH_BATCH_SECONDS && calls < BENCH_MAX_BATCH) {
+    calls *= 2;
+  }
+  double best = time_bench_batch(call, calls);
+  for (int i = 1; i < BENCH_BATCHES; i++) {
+    best = std::min(best, time_bench_batch(call, calls));
+  }
+
+  BenchResult result = {name, size, best * 1e9 / calls / items, calls};
+  printf("%-36s %8d %14.1f ns\n", name.data(), size, result.ns_per_op);
+  fflush(stdout);
+  run.results.push_back(result);
+}
+
+inline bool write_bench_results(const BenchRun &run, const char *path) {
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    fprintf(stderr, "error: [%s] can't write results\n", path);
+    return false;
+  }
+  fprintf(file, "[\n");
+  for (size_t i = 0; i < run.results.size(); i++) {
+    const BenchResult &result = run.results[i];
+    fprintf(file,
+            "  {\"suite\": \"%s\", \"name\": \"%s\", \"size\": %d, \"ns_per_op\": %.3f, "
+            "\"calls\": %lld}%s\n",
+            run.suite.data(), result.name.data(), result.size, result.ns_per_op, result.calls,
+            i + 1 < run.results.size() ? "," : "");
+  }
+  fprintf(file, "]\n");
+  return fclose(file) == 0;
+}
+
+// Usage of every suite: bench-<suite> [results.json] [--filter name]. run_suite(run) adds the
+// benches, exits 1 when the results can't be written.
+template <typename Suite>
+inline int run_bench_suite(int argc, char **argv, const char *suite, Suite run_suite) {
+  BenchRun run = {suite, "", {}};
+  const char *out = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      run.filter = argv[++i];
+    } else {
+      out = argv[i];
+    }
+  }
+
+  printf("%-36s %8s %17s\n", suite, "size", "time per call");
+  run_suite(run);
+  return out && !write_bench_results(run, out);
+}
+}  // namespace bomaqs
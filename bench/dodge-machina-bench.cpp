@@ -0,0 +1,334 @@
+// Dodge Machina's per-tick systems: steering math, bullets, collision sweeps, enemies, spawning and
+// timers.
+//
+// Usage: bench-dodge-machina [results.json] [--filter name]
+//
+// Worlds are filled with enemies scattered over the screen, a third of each type, moving in random
+// directions. Sizes go from a normal game up to every archetype at capacity, built with
+// BOMAQS_STRESS_CAPACITY that's the stress scenarios' pools.
+
+#define BOMAQS_NO_MAIN
+#include "dodge-machina.cpp"
+
+#include "bench.hpp"
+
+#define BENCH_SEED 7
+
+int bench_enemy_counts[] = {12, 192, ENEMY_ARCHETYPE_CAPACITY * 3};
+int bench_bullet_counts[] = {MAX_BULLETS, 1024, BULLET_CAPACITY};
+int bench_point_counts[] = {16, 256, 4096};
+#define BENCH_TIMERS_MAX 100000
+int bench_timer_counts[] = {64, 512, MAX_WORLD_TIMERS, BENCH_TIMERS_MAX};
+int bench_emitter_counts[] = {40, ENEMY_ARCHETYPE_CAPACITY};
+
+// In the top of the screen and moving in a random direction, the player is at the bottom so misses
+// are the common case
+int add_bench_enemy(GameWorld &world, EnemyType type, ActorState homer_state) {
+  Vector2 position = {(float)world_random(world, 0, SCREEN_WIDTH),
+                      (float)world_random(world, 0, SCREEN_HEIGHT - 300)};
+  Vector2 velocity = {(float)world_random(world, -DASHER_VELOCITY, DASHER_VELOCITY),
+                      (float)world_random(world, -DASHER_VELOCITY, DASHER_VELOCITY)};
+  EnemyCore core = {
+      .position = position,
+      .velocity = velocity,
+      .last_position = {position.x - velocity.x, position.y - velocity.y},
+      .state = type == EnemyType::HOMING ? homer_state : ActorState::LIVE,
+      .timer = {0, 0},
+      .id = world.next_entity_id++,
+      .next_think = 0,
+  };
+  return add_enemy(world, type, core, enemy_colors[(int)type],
+                   bomaqs::create_emitter(0, BULLET_FIRE_RATE_MIN, BULLET_VELOCITY));
+}
+
+// A third of each type, homers already counting down to their blast unless told otherwise
+void fill_bench_world(GameWorld &world, int enemies,
+                      ActorState homer_state = ActorState::DESTRUCT) {
+  reset_game_world(world, BENCH_SEED);
+  for (int i = 0; i < enemies; i++) {
+    add_bench_enemy(world, (EnemyType)(i % 3), homer_state);
+  }
+}
+
+void fill_bench_bullets(GameWorld &world, BulletList &bullets, int count) {
+  bullets.clear();
+  for (int i = 0; i < count; i++) {
+    Vector2 position = {(float)world_random(world, 0, SCREEN_WIDTH),
+                        (float)world_random(world, 0, SCREEN_HEIGHT - 300)};
+    Vector2 velocity = {(float)world_random(world, -BULLET_VELOCITY, BULLET_VELOCITY),
+                        (float)world_random(world, -BULLET_VELOCITY, BULLET_VELOCITY)};
+    bullets.push_back({position, BLACK, velocity, ActorState::LIVE,
+                       {position.x - velocity.x, position.y - velocity.y}, (unsigned int)i});
+  }
+}
+
+void bench_math(bomaqs::BenchRun &run, GameWorld &world) {
+  for (int count : bench_point_counts) {
+    std::vector<Vector2> points(count + 1);
+    for (auto &point : points) {
+      point = {(float)world_random(world, 0, SCREEN_WIDTH),
+               (float)world_random(world, 0, SCREEN_HEIGHT)};
+    }
+
+    bomaqs::run_bench(run, "coordinate_angle", count, [&] {
+      float sum = 0;
+      for (int i = 0; i < count; i++) {
+        sum += bomaqs::coordinate_angle(points[i], points[i + 1]);
+      }
+      bomaqs::bench_keep(sum);
+    });
+    bomaqs::run_bench(run, "distance_2d", count, [&] {
+      float sum = 0;
+      for (int i = 0; i < count; i++) {
+        sum += bomaqs::distance_2d(points[i], points[i + 1]);
+      }
+      bomaqs::bench_keep(sum);
+    });
+    bomaqs::run_bench(run, "get_homing_velocity", count, [&] {
+      Vector2 sum = {0, 0};
+      for (int i = 0; i < count; i++) {
+        Vector2 velocity = get_homing_velocity(points[i], points[i + 1], HOMING_VELOCITY);
+        sum.x += velocity.x;
+        sum.y += velocity.y;
+      }
+      bomaqs::bench_keep(sum);
+    });
+  }
+}
+
+void bench_bullets(bomaqs::BenchRun &run, GameWorld &world) {
+  for (int count : bench_bullet_counts) {
+    static BulletList start, bullets;
+    fill_bench_bullets(world, start, count);
+
+    // Only the live bullets are put back, copying the whole list would cost more than the update
+    bomaqs::run_bench(run, "update_bullets", count, [&] {
+      std::copy(start.begin(), start.end(), bullets.begin());
+      bullets.count = start.count;
+      update_bullets(bullets);
+      bomaqs::bench_keep(bullets);
+    });
+    std::copy(start.begin(), start.end(), bullets.begin());
+    bullets.count = start.count;
+    // A hit kills the bullet, bring it back so every call sweeps the same bullets
+    bomaqs::run_bench(run, "check_bullet_collisions", count, [&] {
+      bool hit = check_bullet_collisions(world.player, bullets);
+      if (hit) {
+        for (auto &bullet : bullets) {
+          bullet.state = ActorState::LIVE;
+        }
+      }
+      bomaqs::bench_keep(hit);
+    });
+  }
+}
+
+// log_event from the tick, into a log of the bench's own without a file or a writer thread. The
+// bench empties the ring after each event like the writer would, the disk isn't timed. A full ring
+// drops events instead, that's timed too.
+void bench_telemetry(bomaqs::BenchRun &run) {
+  static bomaqs::Telemetry log;
+  log.start = std::chrono::steady_clock::now();
+  log.running = true;
+  bomaqs::TelemetryRing *ring = bomaqs::own_telemetry_ring(log);
+
+  bomaqs::run_bench(run, "log_event", 1, [&] {
+    bomaqs::log_event(bomaqs::TELEMETRY_ENEMY_KILLED, 1, bomaqs::CAUSE_BULLET, 100, log);
+    ring->read.store(ring->write.load());
+  });
+  ring->read.store(ring->write.load() - TELEMETRY_RING_RECORDS);
+  bomaqs::run_bench(run, "log_event_ring_full", 1, [&] {
+    bomaqs::log_event(bomaqs::TELEMETRY_ENEMY_KILLED, 1, bomaqs::CAUSE_BULLET, 100, log);
+  });
+  log.running = false;
+}
+
+// The bullet sweeps on a full pool with 1..N threads, size is the thread count (the calling thread
+// and size - 1 workers). The job system is restarted for each and left at the last count.
+void bench_job_scaling(bomaqs::BenchRun &run, GameWorld &world) {
+  static BulletList start, bullets;
+  fill_bench_bullets(world, start, BULLET_CAPACITY);
+  int threads_max = std::min(std::max(1, (int)std::thread::hardware_concurrency()),
+                             JOB_THREADS_MAX + 1);
+  for (int threads = 1; threads <= threads_max; threads++) {
+    bomaqs::shutdown_job_system(bomaqs::job_system);
+    bomaqs::init_job_system(bomaqs::job_system, threads - 1);
+
+    bomaqs::run_bench(run, "update_bullets_threads", threads, [&] {
+      std::copy(start.begin(), start.end(), bullets.begin());
+      bullets.count = start.count;
+      update_bullets(bullets);
+      bomaqs::bench_keep(bullets);
+    });
+    std::copy(start.begin(), start.end(), bullets.begin());
+    bullets.count = start.count;
+    bomaqs::run_bench(run, "check_bullet_collisions_threads", threads, [&] {
+      bool hit = check_bullet_collisions(world.player, bullets);
+      if (hit) {
+        for (auto &bullet : bullets) {
+          bullet.state = ActorState::LIVE;
+        }
+      }
+      bomaqs::bench_keep(hit);
+    });
+  }
+}
+
+void bench_collisions(bomaqs::BenchRun &run, GameWorld &world) {
+  for (int count : bench_enemy_counts) {
+    fill_bench_world(world, count);
+
+    bomaqs::run_bench(run, "check_enemy_collisions", count, [&] {
+      bomaqs::bench_keep(check_enemy_collisions(world.player, world));
+    });
+    bomaqs::run_bench(run, "check_homer_blast_collisions", count, [&] {
+      bomaqs::bench_keep(check_homer_blast_collisions(world.player, world));
+    });
+    bomaqs::run_bench(run, "check_enemy_enemy_collisions", count, [&] {
+      bomaqs::bench_keep(check_enemy_enemy_collisions(world));
+    });
+  }
+}
+
+// The enemy systems per enemy, so counts compare against each other. Past MAX_ENEMIES of each type
+// only fits in BOMAQS_STRESS_CAPACITY builds like this one, a game never gets there.
+//
+// move_enemies and the AI run on dashers and homers, shooters never move or think. Past
+// AI_THINK_BUDGET of a type the rest wait, so the AI's cost per enemy drops. The tick runs the
+// whole world with every type: enemies that die are replaced after it and the player is put back,
+// the world stays at count enemies and RUNNING. Replacing them is timed with the tick, it costs
+// about what the game's own spawning would.
+void bench_enemies(bomaqs::BenchRun &run, GameWorld &world) {
+  bomaqs::PatternLibrary library = bomaqs::load_pattern_library(shooter_patterns);
+  TickInput input = {.taps = 0, .in_background = false, .frame_time = 1.0f / FRAME_RATE,
+                     .patterns = &library};
+
+  for (int count : bench_enemy_counts) {
+    fill_bench_world(world, count, ActorState::LIVE);
+    int moving = world.dashers.size() + world.homers.size();
+
+    bomaqs::run_bench(run, "move_enemies_per_enemy", count, [&] {
+      move_enemies(world.dashers);
+      move_enemies(world.homers);
+      bomaqs::bench_keep(world.homers.hot[0]);
+    }, moving);
+    bomaqs::run_bench(run, "run_ai_schedule_per_enemy", count, [&] {
+      bomaqs::run_ai_schedule(world.dasher_ai, world.dashers.hot, world.dashers.size(),
+                              world.frames_count,
+                              [&](int i) { return think_dasher(world, world.dashers.hot[i]); });
+      bomaqs::run_ai_schedule(world.homer_ai, world.homers.hot, world.homers.size(),
+                              world.frames_count, [&](int i) { return think_homer(world, i); });
+      world.frames_count++;
+      bomaqs::bench_keep(world.homers.hot[0]);
+    }, moving);
+
+    fill_bench_world(world, count, ActorState::LIVE);
+    Player player = world.player;
+    bomaqs::run_bench(run, "update_game_world_per_enemy", count, [&] {
+      update_game_world(world, input);
+      world.player = player;
+      world.state = WorldState::RUNNING;
+      for (int i = world.shooters.size(); i < count / 3; i++) {
+        add_bench_enemy(world, EnemyType::SHOOTER, ActorState::LIVE);
+      }
+      for (int i = world.dashers.size(); i < count / 3; i++) {
+        add_bench_enemy(world, EnemyType::DASHER, ActorState::LIVE);
+      }
+      for (int i = world.homers.size(); i < count / 3; i++) {
+        add_bench_enemy(world, EnemyType::HOMING, ActorState::LIVE);
+      }
+      bomaqs::bench_keep(world.score);
+    }, count);
+  }
+}
+
+// The spawn grid holds SPAWN_GRID_MAX_OCCUPANTS, enemies past that aren't in it
+void bench_spawning(bomaqs::BenchRun &run, GameWorld &world) {
+  static bomaqs::SpawnGrid grid;
+  for (int count : bench_enemy_counts) {
+    fill_bench_world(world, count);
+
+    bomaqs::run_bench(run, "build_spawn_grid", count, [&] {
+      build_spawn_grid(world, grid);
+      bomaqs::bench_keep(grid);
+    });
+    bomaqs::run_bench(run, "sample_spawn_point", count, [&] {
+      Vector2 position;
+      bomaqs::sample_spawn_point(grid, DASHER_BOUNDS, SPAWN_DISTANCE,
+                                 [&](int min, int max) { return world_random(world, min, max); },
+                                 &position);
+      bomaqs::bench_keep(position);
+    });
+  }
+}
+
+// Every pattern the game ships, storm included. Emitters keep running between calls like they do
+// in the game, patterns loop forever so every call is a tick of a running pattern. Bullets are only
+// counted.
+void bench_patterns(bomaqs::BenchRun &run, GameWorld &world) {
+  std::vector<std::string> names = shooter_patterns;
+  names.push_back("storm");
+  bomaqs::PatternLibrary library = bomaqs::load_pattern_library(names);
+  for (int pattern = 0; pattern < (int)names.size(); pattern++) {
+    for (int count : bench_emitter_counts) {
+      std::vector<bomaqs::PatternEmitter> emitters(
+          count, bomaqs::create_emitter(pattern, BULLET_FIRE_RATE_MIN, BULLET_VELOCITY));
+      std::vector<Vector2> origins(count), targets(count, world.player.position);
+      for (auto &origin : origins) {
+        origin = {(float)world_random(world, 0, SCREEN_WIDTH),
+                  (float)world_random(world, 0, SCREEN_HEIGHT - 300)};
+      }
+
+      bomaqs::run_bench(run, "step_emitters_" + names[pattern], count, [&] {
+        int fired = 0;
+        bomaqs::step_emitters(library, emitters.data(), origins.data(), targets.data(), count,
+                              [&](Vector2, Vector2) { fired += 1; });
+        bomaqs::bench_keep(fired);
+      });
+    }
+  }
+}
+
+// Timers restart as they fire, the wheel stays at count timers with reload-like lengths. The wheel
+// is bigger than the world's so the counts go past it.
+void bench_timers(bomaqs::BenchRun &run, GameWorld &world) {
+  static bomaqs::TimerWheel<BENCH_TIMERS_MAX> timers;
+  for (int count : bench_timer_counts) {
+    bomaqs::init_timer_wheel(timers, 0);
+    for (int i = 0; i < count; i++) {
+      uint32_t ticks = world_random(world, 1, ENEMY_RELOAD_TICKS * 2);
+      bomaqs::start_timer(timers, ticks, ticks, i);
+    }
+
+    bomaqs::run_bench(run, "advance_timers", count, [&] {
+      int fired = 0;
+      bomaqs::advance_timers(timers, timers.now + 1, [&](uint32_t ticks, uint32_t data) {
+        bomaqs::start_timer(timers, ticks, ticks, data);
+        fired += 1;
+      });
+      bomaqs::bench_keep(fired);
+    });
+  }
+}
+
+int main(int argc, char **argv) {
+  SetTraceLogLevel(LOG_WARNING);
+  bomaqs::init_job_system(bomaqs::job_system);
+  static GameWorld world;
+  reset_game_world(world, BENCH_SEED);
+
+  int status = bomaqs::run_bench_suite(argc, argv, "dodge-machina", [&](bomaqs::BenchRun &run) {
+    bench_math(run, world);
+    bench_bullets(run, world);
+    bench_collisions(run, world);
+    bench_enemies(run, world);
+    bench_spawning(run, world);
+    bench_timers(run, world);
+    bench_patterns(run, world);
+    bench_telemetry(run);
+    bench_job_scaling(run, world);
+  });
+
+  bomaqs::shutdown_job_system(bomaqs::job_system);
+  return status;
+}
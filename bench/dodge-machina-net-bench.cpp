@@ -0,0 +1,69 @@
+// Dodge Machina's loopback server: world snapshots and rollback re-simulation.
+//
+// Usage: bench-dodge-machina-net [results.json] [--filter name]
+//
+// Built with the game's own capacities, unlike the dodge-machina suite, so snapshots copy the world
+// a game runs. The world is the scripted --hash-ticks game a few seconds in, enemies up and firing.
+
+#define BOMAQS_NO_MAIN
+#include "dodge-machina.cpp"
+
+#include "bench.hpp"
+
+#define BENCH_WARMUP_TICKS (FRAME_RATE * 10)
+
+typedef bomaqs::Rollback<GameWorld, TickInput, NET_ROLLBACK_FRAMES> BenchRollback;
+
+int bench_resimulate_frames[] = {1, 8, NET_ROLLBACK_TICKS};
+
+// Same script as run_hash_ticks
+TickInput bench_tick_input(int tick, unsigned int &script,
+                           const bomaqs::PatternLibrary &patterns) {
+  script = script * 1664525 + 1013904223;
+  return {
+      .taps = tick % HASH_RUN_TAP_TICKS == 0,
+      .tap_positions = {{(float)((script >> 8) % SCREEN_WIDTH),
+                         (float)((script >> 20) % SCREEN_HEIGHT)}},
+      .in_background = false,
+      .frame_time = 1.0f / FRAME_RATE,
+      .patterns = &patterns,
+  };
+}
+
+void bench_rollback(bomaqs::BenchRun &run, BenchRollback &rollback) {
+  static GameWorld world;
+  bomaqs::run_bench(run, "save_state", sizeof(GameWorld), [&] {
+    bomaqs::save_state(rollback.before, rollback.frame, rollback.world);
+  });
+  bomaqs::run_bench(run, "load_state", sizeof(GameWorld), [&] {
+    bomaqs::bench_keep(bomaqs::load_state(rollback.before, rollback.frame, world));
+  });
+
+  // Steps back to the present with the same inputs, the rollback ends where it started
+  for (int frames : bench_resimulate_frames) {
+    bomaqs::run_bench(run, "resimulate_from", frames, [&] {
+      bomaqs::bench_keep(bomaqs::resimulate_from(rollback, rollback.frame - frames));
+    });
+  }
+}
+
+int main(int argc, char **argv) {
+  SetTraceLogLevel(LOG_WARNING);
+  bomaqs::init_job_system(bomaqs::job_system);
+  bomaqs::PatternLibrary patterns = bomaqs::load_pattern_library(shooter_patterns);
+  static GameWorld world;
+  reset_game_world(world, HASH_RUN_SEED);
+  auto rollback = std::make_unique<BenchRollback>();
+  bomaqs::start_rollback(*rollback, world, update_game_world);
+  unsigned int script = HASH_RUN_SEED;
+  for (int tick = 1; tick <= BENCH_WARMUP_TICKS; tick++) {
+    bomaqs::advance_rollback(*rollback, bench_tick_input(tick, script, patterns));
+  }
+
+  int status = bomaqs::run_bench_suite(argc, argv, "dodge-machina-net", [&](bomaqs::BenchRun &run) {
+    bench_rollback(run, *rollback);
+  });
+
+  bomaqs::shutdown_job_system(bomaqs::job_system);
+  return status;
+}
@@ -0,0 +1,46 @@
+// Snake Dancer's snake movement and music decoding.
+//
+// Usage: bench-snake-dancer [results.json] [--filter name]
+//
+// Run from the repository root, the track is read from resources/. No audio device is opened, the
+// music streamer decodes into a null sink.
+
+#define BOMAQS_NO_MAIN
+#include "snake-dancer.cpp"
+
+#include "bench.hpp"
+
+int bench_snake_lengths[] = {16, 256, 4096};
+
+// Size is the frames decoded per call
+void bench_music(bomaqs::BenchRun &run) {
+  bomaqs::MusicStreamer streamer;
+  if (!bomaqs::open_music_streamer(streamer, "Funky-Chiptune.mp3", true)) {
+    TraceLog(LOG_WARNING, "BENCH: Funky-Chiptune.mp3 didn't open, run from the repository root");
+    return;
+  }
+  bomaqs::run_bench(run, "decode_music", 2 * MUSIC_FEED_FRAMES,
+                    [&] { bomaqs::decode_music_null_sink(streamer); });
+  bomaqs::close_music_streamer(streamer);
+}
+
+int main(int argc, char **argv) {
+  SetTraceLogLevel(LOG_WARNING);
+  return bomaqs::run_bench_suite(argc, argv, "snake-dancer", [](bomaqs::BenchRun &run) {
+    bench_music(run);
+    for (int length : bench_snake_lengths) {
+      vector<Vector2> snake(length);
+      for (int i = 0; i < length; i++) {
+        snake[i] = {(float)SCREEN_WIDTH / 2, (float)(SCREEN_HEIGHT / 2 + i * SNAKE_SCALE)};
+      }
+
+      // Turning every call keeps it near where it started
+      Vector2 turns[4] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+      int turn = 0;
+      bomaqs::run_bench(run, "move_snake", length, [&] {
+        move_snake(snake, turns[turn++ & 3]);
+        bomaqs::bench_keep(snake[0]);
+      });
+    }
+  });
+}
@@ -0,0 +1,75 @@
+// Word Scramble's level generation and dictionary loading.
+//
+// Usage: bench-word-scramble [results.json] [--filter name]
+//
+// Run from the repository root, the dictionary is read from resources/word-list.txt. Dictionaries
+// of other sizes are written next to it for the run (bench-words-<size>.txt) and removed after.
+
+#define BOMAQS_NO_MAIN
+#include "word-scramble.cpp"
+
+#include "bench.hpp"
+
+#define BENCH_DICTIONARY "word-list.txt"
+#define BENCH_SEED 7
+
+int bench_dictionary_sizes[] = {1000, 10000, 100000};
+int bench_word_lengths[] = {3, 5, 8};
+
+// The real list repeated up to size words
+string write_bench_dictionary(const string& words, int size) {
+  string out;
+  int count = 0;
+  for (size_t start = 0; count < size; count++) {
+    size_t end = words.find('\n', start);
+    if (end == string::npos) {
+      start = 0;
+      end = words.find('\n');
+    }
+    out.append(words, start, end - start + 1);
+    start = end + 1;
+  }
+  string file = "bench-words-" + to_string(size) + ".txt";
+  SaveFileText(bomaqs::get_real_path(file).data(), out.data());
+  return file;
+}
+
+void bench_dictionary(bomaqs::BenchRun& run) {
+  string words = bomaqs::load_text_file(BENCH_DICTIONARY);
+  for (int size : bench_dictionary_sizes) {
+    string file = write_bench_dictionary(words, size);
+    bomaqs::run_bench(run, "load_word_dictionary", size, [&] {
+      bomaqs::bench_keep(bomaqs::load_word_dictionary(file));
+    });
+    remove(bomaqs::get_real_path(file).data());
+  }
+}
+
+void bench_levels(bomaqs::BenchRun& run) {
+  bomaqs::word_dict dictionary = bomaqs::load_word_dictionary(BENCH_DICTIONARY);
+  mt19937 rng(BENCH_SEED);
+  for (int length : bench_word_lengths) {
+    string answer = get_random_word(dictionary, length, rng);
+    bomaqs::run_bench(run, "generate_letters", length, [&] {
+      bomaqs::bench_keep(generate_letters(answer, ALL_ALPHABETS, rng));
+    });
+  }
+
+  // Words come out of get_random_word, a level owns them
+  for (int difficulty : bench_word_lengths) {
+    bomaqs::run_bench(run, "generate_level", difficulty, [&] {
+      GameLevel level = generate_level(dictionary, difficulty, rng());
+      bomaqs::bench_keep(level);
+      delete[] level.word1_button.title;
+      delete[] level.word2_button.title;
+    });
+  }
+}
+
+int main(int argc, char** argv) {
+  SetTraceLogLevel(LOG_WARNING);
+  return bomaqs::run_bench_suite(argc, argv, "word-scramble", [](bomaqs::BenchRun& run) {
+    bench_dictionary(run);
+    bench_levels(run);
+  });
+}
@@ -0,0 +1,63 @@
+# Profile guided release build of a game, with LTO. Builds the game plain into build/<game>-release
+# and instrumented into build/<game>-pgo, trains the instrumented one headless on its scripted
+# --hash-ticks session, its cold start and its stress scenarios, then rebuilds build/<game>-pgo
+# with the profile. Both builds then run the scenarios and bench-compare prints the tick time
+# change, exits 1 when the PGO build's p50 or p99 is more than 10% slower (max is only reported,
+# one outlier tick). --render times frames rather than headless ticks (needs a display).
+# usage: ./build-pgo.sh <game-name> [--render]
+GAME=$1
+RENDER=$2
+RELEASE=build/$GAME-release
+PGO=build/$GAME-pgo
+set -e
+
+configure() {
+  conan install . -if $1
+  cmake -S . -B $1 -G "Unix Makefiles" -DCMAKE_BUILD_TYPE=Release -DGAME_ENTRY_FILE=src/$GAME.cpp \
+    "${@:2}"
+  cmake --build $1 --target game bench-compare
+}
+
+# Runs every scenario of the game and keeps the results in $2, dropping an earlier run's
+run_scenarios() {
+  rm -rf $2
+  mkdir -p $2
+  for SCENARIO in bench/scenarios/$GAME-*.txt; do
+    [ -e "$SCENARIO" ] || continue
+    $1 --scenario $SCENARIO $RENDER || true
+    # A run that failed before timing anything (e.g. refused by the build) leaves no results
+    NAME=$(basename $SCENARIO .txt)
+    if [ -e scenario-$NAME.json ]; then
+      mv scenario-$NAME.json $2/
+    fi
+  done
+}
+
+configure $RELEASE -DBOMAQS_PGO= -DBOMAQS_LTO=OFF
+
+# Training, games only have the runs their source supports
+rm -rf $PGO/pgo
+configure $PGO -DBOMAQS_PGO=GENERATE -DBOMAQS_LTO=OFF
+if grep -q -- '"--hash-ticks"' src/$GAME.cpp; then
+  $PGO/game --hash-ticks 20000 > /dev/null
+fi
+$PGO/game --startup-check 100000 > /dev/null || true
+run_scenarios $PGO/game $PGO/training
+if ls $PGO/pgo/*.profraw > /dev/null 2>&1; then
+  llvm-profdata merge -output=$PGO/pgo/default.profdata $PGO/pgo/*.profraw
+fi
+
+configure $PGO -DBOMAQS_PGO=USE -DBOMAQS_LTO=ON
+
+run_scenarios $RELEASE/game $RELEASE/scenarios
+run_scenarios $PGO/game $PGO/scenarios
+set +e
+FAILED=0
+if ! ls $RELEASE/scenarios/*.json > /dev/null 2>&1; then
+  echo "No scenarios for $GAME, built $PGO/game without comparing it"
+fi
+for RESULT in $RELEASE/scenarios/*.json; do
+  [ -e "$RESULT" ] || continue
+  $PGO/bench-compare $RESULT $PGO/scenarios/$(basename $RESULT) --gate p50,p99 || FAILED=1
+done
+exit $FAILED
@@ -1,5 +1,13 @@
+# Pack assets into a bundle when the game has a list, needs the host tools built with build.sh
+RESOURCES_DIR=resources
+if [ -f resources/bundles/$1.txt ]; then
+  RESOURCES_DIR=build/$1-resources
+  rm -rf $RESOURCES_DIR
+  build/bundle-assets resources/bundles/$1.txt resources $RESOURCES_DIR
+fi
+
 # Build using emscripten
-make PLATFORM=PLATFORM_WEB RAYLIB_PATH=$RAYLIB_HOME -B PROJECT_NAME=$1 $1
+make PLATFORM=PLATFORM_WEB RAYLIB_PATH=$RAYLIB_HOME -B PROJECT_NAME=$1 RESOURCES_DIR=$RESOURCES_DIR $1
 
 # Move build artifacts to public
 mkdir -p public/$1
@@ -0,0 +1,22 @@
+# Runs two builds of a game with --hash-ticks and compares their per tick state hashes
+# usage: ./check-determinism.sh "<command a>" "<command b>" [ticks]
+TICKS=${3:-3600}
+A=$(mktemp)
+B=$(mktemp)
+trap 'rm -f $A $B' EXIT
+
+# Only hash lines count, builds may log other things to stdout
+$1 --hash-ticks $TICKS | grep -E '^[0-9]+ [0-9a-f]{16}$' > $A
+$2 --hash-ticks $TICKS | grep -E '^[0-9]+ [0-9a-f]{16}$' > $B
+
+if [ $(wc -l < $A) -ne $TICKS ] || [ $(wc -l < $B) -ne $TICKS ]; then
+  echo "A build didn't run all $TICKS ticks ($(wc -l < $A) and $(wc -l < $B))"
+  exit 1
+fi
+
+DIVERGED=$(diff $A $B | grep -m1 '^<' | cut -d' ' -f2)
+if [ -n "$DIVERGED" ]; then
+  echo "Builds diverge at tick $DIVERGED"
+  exit 1
+fi
+echo "Builds match for $TICKS ticks"
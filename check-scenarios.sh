@@ -0,0 +1,30 @@
+# Runs every stress scenario in bench/scenarios for each game given and fails if any goes over its
+# tick time or memory budget. Each run writes scenario-<name>.json.
+# usage: ./check-scenarios.sh <game>="<game command>"... [--render]
+RENDER=""
+GAMES=()
+for ARG in "$@"; do
+  if [ "$ARG" == "--render" ]; then
+    RENDER=$ARG
+  else
+    GAMES+=("$ARG")
+  fi
+done
+
+FAILED=0
+RUNS=0
+for GAME in "${GAMES[@]}"; do
+  NAME=${GAME%%=*}
+  for SCENARIO in bench/scenarios/$NAME-*.txt; do
+    [ -e "$SCENARIO" ] || continue
+    RUNS=$((RUNS + 1))
+    if ! ${GAME#*=} --scenario $SCENARIO $RENDER; then
+      echo "Over budget: $SCENARIO"
+      FAILED=1
+    fi
+  done
+done
+if [ $FAILED -eq 0 ]; then
+  echo "All $RUNS scenarios within their budgets"
+fi
+exit $FAILED
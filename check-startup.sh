@@ -0,0 +1,24 @@
+# Runs the windowless part of each game's cold start (--startup-check) and fails if any goes over
+# its budget. Phases of each run are in startup-<game>.csv.
+# usage: ./check-startup.sh "<game command>"... [budget ms, overrides the games' own]
+BUDGET=""
+GAMES=()
+for ARG in "$@"; do
+  if [[ $ARG =~ ^[0-9.]+$ ]]; then
+    BUDGET=$ARG
+  else
+    GAMES+=("$ARG")
+  fi
+done
+
+FAILED=0
+for GAME in "${GAMES[@]}"; do
+  if ! $GAME --startup-check $BUDGET; then
+    echo "Over the cold-start budget: $GAME"
+    FAILED=1
+  fi
+done
+if [ $FAILED -eq 0 ]; then
+  echo "All ${#GAMES[@]} games within their cold-start budgets"
+fi
+exit $FAILED
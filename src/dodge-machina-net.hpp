@@ -0,0 +1,701 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "dodge-machina.hpp"
+#include "utils/net.hpp"
+#include "utils/rollback.hpp"
+
+// Two player Dodge Machina over loopback. `dodge-machina --server [port]` runs the authoritative
+// GameWorld headless, `dodge-machina --connect [port]` joins it: the first client plays, the second
+// is the partner.
+//
+// Clients send their input every frame. Taps travel as a running count, so a lost packet delays a
+// tap instead of dropping it. Every NET_SNAPSHOT_TICKS the server sends each client a snapshot with
+// positions quantized to 1/NET_POSITION_SCALE px, delta encoded against the newest snapshot that
+// client acknowledged. Unchanged fields cost nothing, and bullets are predicted from their velocity
+// so only corrections are sent. Clients draw NET_INTERP_TICKS behind the newest snapshot, blending
+// the two snapshots around that time.
+//
+// A tap is applied on the tick the player was looking at when they tapped, not when it reached the
+// server: the server keeps the last NET_ROLLBACK_FRAMES worlds, writes the tap into the past and
+// re-simulates up to the present. Taps older than NET_ROLLBACK_TICKS land that far back.
+
+#define NET_DEFAULT_PORT 47400
+#define NET_SNAPSHOT_TICKS 2
+#define NET_HISTORY 64  // snapshots kept as baselines
+#define NET_INTERP_TICKS 6
+#define NET_CLIENT_TIMEOUT_TICKS (FRAME_RATE * 2)
+#define NET_REPORT_SECONDS 5
+#define NET_POSITION_SCALE 8
+#define NET_ROLLBACK_FRAMES 16  // worlds kept by the server
+#define NET_ROLLBACK_TICKS 10   // furthest a tap is moved into the past, covers the render delay
+
+enum NetPacketType : uint8_t {
+  NET_PACKET_INPUT = 1,
+  NET_PACKET_SNAPSHOT,
+};
+
+// Fields sent for an entity, the rest is taken from (or predicted off) the baseline
+enum NetFields : uint8_t {
+  NET_FIELD_POSITION = 1,
+  NET_FIELD_VELOCITY = 2,
+  NET_FIELD_LOOKS = 4,  // type, state, color
+  NET_FIELD_TIMER = 8,
+};
+
+typedef struct {
+  uint16_t id;
+  int16_t x, y, vx, vy;
+} NetBullet;
+
+typedef struct {
+  uint16_t id;
+  int16_t x, y;
+  uint8_t type, state, r, g, b;
+  uint8_t timer;  // reload or fuse left, 255 is ENEMY_RELOAD_TICKS
+} NetEnemy;
+
+typedef struct {
+  int16_t x, y;
+  int8_t shield;
+  uint8_t state;
+} NetPlayer;
+
+typedef struct {
+  uint32_t tick;  // 0 for an empty history slot
+  uint8_t state;
+  int32_t score;
+  uint32_t teleports, explosions;
+  NetPlayer players[2];
+  std::vector<NetEnemy> enemies;
+  std::vector<NetBullet> bullets;
+} NetSnapshot;
+
+inline int16_t quantize(float value) {
+  return (int16_t)std::clamp(lroundf(value * NET_POSITION_SCALE), -32768l, 32767l);
+}
+
+inline float dequantize(int value) { return (float)value / NET_POSITION_SCALE; }
+
+inline NetSnapshot capture_snapshot(const GameWorld &world, uint32_t tick) {
+  NetSnapshot snapshot = {};
+  snapshot.tick = tick;
+  snapshot.state = world.state;
+  snapshot.score = lroundf(world.score);
+  snapshot.teleports = world.teleports;
+  snapshot.explosions = world.explosions;
+
+  const Player *players[2] = {&world.player, &world.partner};
+  for (int i = 0; i < 2; i++) {
+    snapshot.players[i] = {quantize(players[i]->position.x), quantize(players[i]->position.y),
+                           (int8_t)std::clamp(players[i]->shield, -1, 127),
+                           (uint8_t)players[i]->state};
+  }
+
+  for_each_archetype(world, [&](EnemyType type, const auto &enemies) {
+    for (int i = 0; i < enemies.size(); i++) {
+      const EnemyCore &enemy = enemies.hot[i];
+      Color color = enemies.cold[i].color;
+      float timer = 1 - bomaqs::timer_progress(world.timers, enemy.timer);
+      snapshot.enemies.push_back({(uint16_t)enemy.id, quantize(enemy.position.x),
+                                  quantize(enemy.position.y), (uint8_t)type, (uint8_t)enemy.state,
+                                  color.r, color.g, color.b, (uint8_t)lroundf(timer * 255)});
+    }
+  });
+  // Archetypes reorder enemies on removal, sorted by id they keep their relative order
+  std::sort(snapshot.enemies.begin(), snapshot.enemies.end(),
+            [](const NetEnemy &a, const NetEnemy &b) { return a.id < b.id; });
+  for (auto &bullet : world.bullets) {
+    snapshot.bullets.push_back({(uint16_t)bullet.id, quantize(bullet.position.x),
+                                quantize(bullet.position.y), quantize(bullet.velocity.x),
+                                quantize(bullet.velocity.y)});
+  }
+  return snapshot;
+}
+
+// Entities keep their relative order between snapshots, so matching walks the baseline forward from
+// the last match. Encoder and decoder run the same walk over the same baseline.
+template <typename T>
+const T *match_baseline(const std::vector<T> &baseline, size_t &cursor, uint16_t id) {
+  for (size_t i = cursor; i < baseline.size(); i++) {
+    if (baseline[i].id == id) {
+      cursor = i + 1;
+      return &baseline[i];
+    }
+  }
+  return NULL;
+}
+
+// Delta encodes snapshot against baseline (NULL for a full snapshot) into writer
+inline void encode_snapshot(bomaqs::NetWriter &writer, const NetSnapshot &snapshot,
+                            const NetSnapshot *baseline, int slot) {
+  static const NetSnapshot empty = {};
+  const NetSnapshot &base = baseline ? *baseline : empty;
+  int elapsed = baseline ? snapshot.tick - baseline->tick : 0;
+
+  bomaqs::write_u8(writer, NET_PACKET_SNAPSHOT);
+  bomaqs::write_u32(writer, snapshot.tick);
+  bomaqs::write_u32(writer, base.tick);
+  bomaqs::write_u8(writer, slot);
+  bomaqs::write_u8(writer, snapshot.state);
+  bomaqs::write_signed(writer, snapshot.score - base.score);
+  bomaqs::write_varint(writer, snapshot.teleports - base.teleports);
+  bomaqs::write_varint(writer, snapshot.explosions - base.explosions);
+  for (int i = 0; i < 2; i++) {
+    bomaqs::write_signed(writer, snapshot.players[i].x - base.players[i].x);
+    bomaqs::write_signed(writer, snapshot.players[i].y - base.players[i].y);
+    bomaqs::write_u8(writer, snapshot.players[i].shield);
+    bomaqs::write_u8(writer, snapshot.players[i].state);
+  }
+
+  size_t cursor = 0;
+  uint16_t previous_id = 0;
+  bomaqs::write_varint(writer, snapshot.enemies.size());
+  for (auto &enemy : snapshot.enemies) {
+    static const NetEnemy none = {};
+    const NetEnemy *match = match_baseline(base.enemies, cursor, enemy.id);
+    const NetEnemy &from = match ? *match : none;
+
+    uint8_t fields = 0;
+    fields |= (enemy.x != from.x || enemy.y != from.y) ? NET_FIELD_POSITION : 0;
+    fields |= (enemy.type != from.type || enemy.state != from.state || enemy.r != from.r ||
+               enemy.g != from.g || enemy.b != from.b)
+                  ? NET_FIELD_LOOKS
+                  : 0;
+    fields |= enemy.timer != from.timer ? NET_FIELD_TIMER : 0;
+
+    bomaqs::write_varint(writer, (uint16_t)(enemy.id - previous_id));
+    bomaqs::write_u8(writer, fields);
+    if (fields & NET_FIELD_POSITION) {
+      bomaqs::write_signed(writer, enemy.x - from.x);
+      bomaqs::write_signed(writer, enemy.y - from.y);
+    }
+    if (fields & NET_FIELD_LOOKS) {
+      bomaqs::write_u8(writer, enemy.type);
+      bomaqs::write_u8(writer, enemy.state);
+      bomaqs::write_u8(writer, enemy.r);
+      bomaqs::write_u8(writer, enemy.g);
+      bomaqs::write_u8(writer, enemy.b);
+    }
+    if (fields & NET_FIELD_TIMER) {
+      bomaqs::write_u8(writer, enemy.timer);
+    }
+    previous_id = enemy.id;
+  }
+
+  cursor = 0;
+  previous_id = 0;
+  bomaqs::write_varint(writer, snapshot.bullets.size());
+  for (auto &bullet : snapshot.bullets) {
+    static const NetBullet none = {};
+    const NetBullet *match = match_baseline(base.bullets, cursor, bullet.id);
+    const NetBullet &from = match ? *match : none;
+    int predicted_x = from.x + (from.vx * elapsed);
+    int predicted_y = from.y + (from.vy * elapsed);
+
+    uint8_t fields = 0;
+    fields |= (bullet.x != predicted_x || bullet.y != predicted_y) ? NET_FIELD_POSITION : 0;
+    fields |= (bullet.vx != from.vx || bullet.vy != from.vy) ? NET_FIELD_VELOCITY : 0;
+
+    bomaqs::write_varint(writer, (uint16_t)(bullet.id - previous_id));
+    bomaqs::write_u8(writer, fields);
+    if (fields & NET_FIELD_POSITION) {
+      bomaqs::write_signed(writer, bullet.x - predicted_x);
+      bomaqs::write_signed(writer, bullet.y - predicted_y);
+    }
+    if (fields & NET_FIELD_VELOCITY) {
+      bomaqs::write_signed(writer, bullet.vx - from.vx);
+      bomaqs::write_signed(writer, bullet.vy - from.vy);
+    }
+    previous_id = bullet.id;
+  }
+}
+
+// Decodes a snapshot packet, find_baseline(tick) returns the snapshot it was encoded against or
+// NULL. False if the packet is malformed or its baseline is gone.
+template <typename FindBaseline>
+bool decode_snapshot(bomaqs::NetReader &reader, NetSnapshot &snapshot, int &slot,
+                     FindBaseline find_baseline) {
+  static const NetSnapshot empty = {};
+  snapshot = {};
+  snapshot.tick = bomaqs::read_u32(reader);
+  uint32_t baseline_tick = bomaqs::read_u32(reader);
+  const NetSnapshot *baseline = baseline_tick ? find_baseline(baseline_tick) : &empty;
+  if (!baseline || reader.error) {
+    return false;
+  }
+  const NetSnapshot &base = *baseline;
+  int elapsed = baseline_tick ? snapshot.tick - baseline_tick : 0;
+
+  slot = bomaqs::read_u8(reader);
+  snapshot.state = bomaqs::read_u8(reader);
+  snapshot.score = base.score + bomaqs::read_signed(reader);
+  snapshot.teleports = base.teleports + bomaqs::read_varint(reader);
+  snapshot.explosions = base.explosions + bomaqs::read_varint(reader);
+  for (int i = 0; i < 2; i++) {
+    snapshot.players[i].x = base.players[i].x + bomaqs::read_signed(reader);
+    snapshot.players[i].y = base.players[i].y + bomaqs::read_signed(reader);
+    snapshot.players[i].shield = bomaqs::read_u8(reader);
+    snapshot.players[i].state = bomaqs::read_u8(reader);
+  }
+
+  size_t cursor = 0;
+  uint16_t previous_id = 0;
+  uint32_t count = std::min<uint32_t>(bomaqs::read_varint(reader), NET_MAX_PACKET);
+  for (uint32_t i = 0; i < count && !reader.error; i++) {
+    static const NetEnemy none = {};
+    uint16_t id = previous_id + bomaqs::read_varint(reader);
+    const NetEnemy *match = match_baseline(base.enemies, cursor, id);
+    NetEnemy enemy = match ? *match : none;
+    enemy.id = id;
+
+    uint8_t fields = bomaqs::read_u8(reader);
+    if (fields & NET_FIELD_POSITION) {
+      enemy.x += bomaqs::read_signed(reader);
+      enemy.y += bomaqs::read_signed(reader);
+    }
+    if (fields & NET_FIELD_LOOKS) {
+      enemy.type = bomaqs::read_u8(reader);
+      enemy.state = bomaqs::read_u8(reader);
+      enemy.r = bomaqs::read_u8(reader);
+      enemy.g = bomaqs::read_u8(reader);
+      enemy.b = bomaqs::read_u8(reader);
+    }
+    if (fields & NET_FIELD_TIMER) {
+      enemy.timer = bomaqs::read_u8(reader);
+    }
+    snapshot.enemies.push_back(enemy);
+    previous_id = id;
+  }
+
+  cursor = 0;
+  previous_id = 0;
+  count = std::min<uint32_t>(bomaqs::read_varint(reader), NET_MAX_PACKET);
+  for (uint32_t i = 0; i < count && !reader.error; i++) {
+    static const NetBullet none = {};
+    uint16_t id = previous_id + bomaqs::read_varint(reader);
+    const NetBullet *match = match_baseline(base.bullets, cursor, id);
+    NetBullet bullet = match ? *match : none;
+    bullet.id = id;
+    bullet.x += bullet.vx * elapsed;
+    bullet.y += bullet.vy * elapsed;
+
+    uint8_t fields = bomaqs::read_u8(reader);
+    if (fields & NET_FIELD_POSITION) {
+      bullet.x += bomaqs::read_signed(reader);
+      bullet.y += bomaqs::read_signed(reader);
+    }
+    if (fields & NET_FIELD_VELOCITY) {
+      bullet.vx += bomaqs::read_signed(reader);
+      bullet.vy += bomaqs::read_signed(reader);
+    }
+    snapshot.bullets.push_back(bullet);
+    previous_id = id;
+  }
+
+  return !reader.error;
+}
+
+// World for drawing, t blends from a (0) to b (1). Entities only in b show up at b's position.
+inline void interpolate_snapshots(const NetSnapshot &a, const NetSnapshot &b, float t,
+                                  GameWorld &world) {
+  auto blend = [t](int from, int to) { return dequantize(from + ((to - from) * t)); };
+
+  reset_game_world(world, 1);
+  world.state = (WorldState)b.state;
+  world.score = b.score;
+  world.teleports = b.teleports;
+  world.explosions = b.explosions;
+
+  Player *players[2] = {&world.player, &world.partner};
+  for (int i = 0; i < 2; i++) {
+    players[i]->position = {blend(a.players[i].x, b.players[i].x),
+                            blend(a.players[i].y, b.players[i].y)};
+    players[i]->shield = b.players[i].shield;
+    players[i]->state = (ActorState)b.players[i].state;
+  }
+
+  // Velocities stay zero, so enemies are drawn without trails
+  size_t cursor = 0;
+  for (auto &to : b.enemies) {
+    const NetEnemy *from = match_baseline(a.enemies, cursor, to.id);
+    EnemyCore enemy = {};
+    enemy.position = from ? (Vector2){blend(from->x, to.x), blend(from->y, to.y)}
+                          : (Vector2){dequantize(to.x), dequantize(to.y)};
+    enemy.last_position = enemy.position;
+    enemy.state = (ActorState)to.state;
+    enemy.id = to.id;
+    EnemyType type = (EnemyType)to.type;
+    int slot = add_enemy(world, type, enemy, {to.r, to.g, to.b, 255}, {});
+    if (slot >= 0 && to.timer) {
+      // Runs in the view's wheel so progress queries work, the view is never stepped
+      uint32_t left = to.timer * ENEMY_RELOAD_TICKS / 255;
+      enemy_core(world, {type, slot}).timer =
+          bomaqs::start_timer(world.timers, ENEMY_RELOAD_TICKS, enemy_timer_tag(type), slot,
+                              ENEMY_RELOAD_TICKS - left);
+    }
+  }
+
+  cursor = 0;
+  for (auto &to : b.bullets) {
+    const NetBullet *from = match_baseline(a.bullets, cursor, to.id);
+    Vector2 position = from ? (Vector2){blend(from->x, to.x), blend(from->y, to.y)}
+                            : (Vector2){dequantize(to.x), dequantize(to.y)};
+    Vector2 velocity = {dequantize(to.vx), dequantize(to.vy)};
+    world.bullets.push_back({position, BLACK, velocity, ActorState::LIVE, position, to.id});
+  }
+}
+
+//---- Server
+
+typedef struct {
+  bool connected;
+  bomaqs::NetAddress address;
+  uint32_t taps;  // running tap count last applied
+  bool tap;
+  Vector2 tap_position;
+  uint32_t tap_tick;  // tick the client was looking at when it tapped
+  uint32_t acked;     // newest snapshot tick the client has
+  uint32_t last_heard;
+  unsigned long long bytes_sent;
+  unsigned long long snapshots_sent;
+  unsigned long long full_bytes;  // what the same snapshots would have cost without deltas
+} NetClient;
+
+inline volatile std::sig_atomic_t net_server_stopping = 0;
+
+// Input packets: type, running tap count, last tap position and tick, newest snapshot tick received
+inline void read_client_input(NetClient &client, bomaqs::NetReader &reader, uint32_t tick) {
+  uint32_t taps = bomaqs::read_varint(reader);
+  Vector2 position = {dequantize(bomaqs::read_signed(reader)),
+                      dequantize(bomaqs::read_signed(reader))};
+  uint32_t tap_tick = bomaqs::read_u32(reader);
+  uint32_t acked = bomaqs::read_u32(reader);
+  if (reader.error) {
+    return;
+  }
+
+  if (taps != client.taps) {
+    client.taps = taps;
+    client.tap = true;
+    client.tap_position = position;
+    client.tap_tick = tap_tick;
+  }
+  client.acked = std::max(client.acked, acked);
+  client.last_heard = tick;
+}
+
+// Runs the authoritative world until interrupted, the game pauses while no one plays slot 0
+inline int run_dodge_server(uint16_t port, const bomaqs::PatternLibrary &patterns,
+                            unsigned int seed) {
+  bomaqs::UdpSocket socket;
+  if (!bomaqs::open_udp_socket(socket, port)) {
+    return 1;
+  }
+  std::signal(SIGINT, [](int) { net_server_stopping = 1; });
+  std::signal(SIGTERM, [](int) { net_server_stopping = 1; });
+  TraceLog(LOG_INFO, "NET: Server listening on 127.0.0.1:%u", port);
+
+  typedef bomaqs::Rollback<GameWorld, TickInput, NET_ROLLBACK_FRAMES> ServerRollback;
+  auto rollback = std::make_unique<ServerRollback>();
+  auto start_world = std::make_unique<GameWorld>();
+  reset_game_world(*start_world, seed);
+  bomaqs::start_rollback(*rollback, *start_world, update_game_world);
+  std::vector<NetSnapshot> history(NET_HISTORY);
+  NetClient clients[2] = {};
+  uint32_t tick = 0;
+
+  double tick_seconds = 0, tick_seconds_max = 0;
+  auto tick_length = std::chrono::microseconds(1000000 / FRAME_RATE);
+  auto next_tick = std::chrono::steady_clock::now();
+
+  while (!net_server_stopping) {
+    // frame tick - 1 produces the world of snapshot tick
+    tick = rollback->frame + 1;
+
+    uint8_t buffer[NET_MAX_PACKET];
+    bomaqs::NetAddress from;
+    int size;
+    while ((size = bomaqs::receive_packet(socket, from, buffer, sizeof(buffer))) > 0) {
+      bomaqs::NetReader reader = {buffer, size, 0, false};
+      if (bomaqs::read_u8(reader) != NET_PACKET_INPUT) {
+        continue;
+      }
+
+      NetClient *client = NULL;
+      for (auto &slot : clients) {
+        if (slot.connected && bomaqs::same_address(slot.address, from)) {
+          client = &slot;
+        }
+      }
+      for (int i = 0; i < 2 && !client; i++) {
+        if (!clients[i].connected) {
+          client = &clients[i];
+          *client = {};
+          client->connected = true;
+          client->address = from;
+          TraceLog(LOG_INFO, "NET: Player %d joined from port %u", i + 1, from.port);
+        }
+      }
+      if (client) {
+        bool first = client->last_heard == 0;
+        read_client_input(*client, reader, tick);
+        // the count a client starts with isn't a tap
+        client->tap = client->tap && !first;
+      }
+    }
+
+    for (int i = 0; i < 2; i++) {
+      if (clients[i].connected && tick - clients[i].last_heard > NET_CLIENT_TIMEOUT_TICKS) {
+        clients[i].connected = false;
+        TraceLog(LOG_INFO, "NET: Player %d timed out", i + 1);
+      }
+    }
+
+    auto started = std::chrono::steady_clock::now();
+
+    // Late taps go into the frame after the snapshot the player saw, then the world catches up
+    uint32_t earliest =
+        rollback->frame > NET_ROLLBACK_TICKS ? rollback->frame - NET_ROLLBACK_TICKS : 0;
+    uint32_t resimulate = rollback->frame;
+    for (int i = 0; i < 2; i++) {
+      TickInput *past = NULL;
+      if (clients[i].tap) {
+        uint32_t frame = std::max(clients[i].tap_tick, earliest);
+        past = bomaqs::past_input(*rollback, frame);
+        resimulate = past ? std::min(resimulate, frame) : resimulate;
+      }
+      if (past && i == 0 && past->taps < MAX_TICK_TAPS) {
+        past->tap_positions[past->taps++] = clients[i].tap_position;
+      } else if (past && i == 1) {
+        past->partner_tap = true;
+        past->partner_touch_position = clients[i].tap_position;
+      }
+      clients[i].tap = clients[i].tap && !past;
+    }
+    bomaqs::resimulate_from(*rollback, resimulate);
+
+    TickInput input = {
+        .taps = clients[0].tap,
+        .tap_positions = {clients[0].tap_position},
+        .in_background = !clients[0].connected,
+        .frame_time = 1.0f / FRAME_RATE,
+        .patterns = &patterns,
+        .partner_present = clients[1].connected,
+        .partner_tap = clients[1].tap,
+        .partner_touch_position = clients[1].tap_position,
+    };
+    clients[0].tap = false;
+    clients[1].tap = false;
+    bomaqs::advance_rollback(*rollback, input);
+    const GameWorld &world = rollback->world;
+
+    if (tick % NET_SNAPSHOT_TICKS == 0) {
+      NetSnapshot &snapshot = history[(tick / NET_SNAPSHOT_TICKS) % NET_HISTORY];
+      snapshot = capture_snapshot(world, tick);
+
+      for (int i = 0; i < 2; i++) {
+        NetClient &client = clients[i];
+        if (!client.connected) {
+          continue;
+        }
+        const NetSnapshot &acked = history[(client.acked / NET_SNAPSHOT_TICKS) % NET_HISTORY];
+        const NetSnapshot *baseline = client.acked && acked.tick == client.acked ? &acked : NULL;
+
+        static bomaqs::NetWriter writer, full;
+        writer.size = 0;
+        writer.overflow = false;
+        encode_snapshot(writer, snapshot, baseline, i);
+        full.size = 0;
+        full.overflow = false;
+        encode_snapshot(full, snapshot, NULL, i);
+
+        if (writer.overflow) {
+          TraceLog(LOG_WARNING, "NET: Snapshot %u doesn't fit in a packet", tick);
+        } else if (bomaqs::send_packet(socket, client.address, writer.data, writer.size)) {
+          client.bytes_sent += writer.size;
+          client.full_bytes += full.size;
+          client.snapshots_sent += 1;
+        }
+      }
+    }
+
+    std::chrono::duration<double> cost = std::chrono::steady_clock::now() - started;
+    tick_seconds += cost.count();
+    tick_seconds_max = std::max(tick_seconds_max, cost.count());
+
+    if (tick % (NET_REPORT_SECONDS * FRAME_RATE) == 0) {
+      TraceLog(LOG_INFO, "NET: tick %.1fus avg, %.1fus max, %llu rollbacks (%llu frames)",
+               tick_seconds * 1e6 / (NET_REPORT_SECONDS * FRAME_RATE), tick_seconds_max * 1e6,
+               rollback->rollbacks, rollback->frames_resimulated);
+      for (int i = 0; i < 2; i++) {
+        NetClient &client = clients[i];
+        if (client.connected && client.snapshots_sent) {
+          TraceLog(LOG_INFO, "NET: player %d %.2f KB/s, %llu bytes/snapshot (%llu without deltas)",
+                   i + 1, client.bytes_sent / 1024.0 / NET_REPORT_SECONDS,
+                   client.bytes_sent / client.snapshots_sent,
+                   client.full_bytes / client.snapshots_sent);
+        }
+        client.bytes_sent = 0;
+        client.full_bytes = 0;
+        client.snapshots_sent = 0;
+      }
+      tick_seconds = 0;
+      tick_seconds_max = 0;
+    }
+
+    next_tick += tick_length;
+    std::this_thread::sleep_until(next_tick);
+  }
+
+  TraceLog(LOG_INFO, "NET: Server stopped after %u ticks", tick);
+  bomaqs::close_udp_socket(socket);
+  return 0;
+}
+
+//---- Client
+
+typedef struct {
+  bomaqs::UdpSocket socket;
+  bomaqs::NetAddress server;
+  uint32_t taps;
+  Vector2 tap_position;
+  uint32_t tap_tick;
+
+  std::vector<NetSnapshot> history;  // decoded snapshots by tick, baselines and interpolation
+  uint32_t newest;                   // 0 until the first snapshot arrives
+  int slot;
+  float render_tick;
+  GameWorld view;
+
+  double report_time;
+  unsigned long long report_bytes;
+} NetClientState;
+
+inline bool start_net_client(NetClientState &client, uint16_t port, int drop_percent) {
+  if (!bomaqs::open_udp_socket(client.socket, 0)) {
+    return false;
+  }
+  client.socket.drop_percent = drop_percent;
+  client.server = bomaqs::loopback_address(port);
+  client.taps = 0;
+  client.tap_position = {0, 0};
+  client.tap_tick = 0;
+  client.history.assign(NET_HISTORY, {});
+  client.newest = 0;
+  client.slot = 0;
+  client.render_tick = 0;
+  reset_game_world(client.view, 1);
+  client.report_time = GetTime();
+  client.report_bytes = 0;
+  TraceLog(LOG_INFO, "NET: Connecting to 127.0.0.1:%u", port);
+  return true;
+}
+
+inline void send_net_input(NetClientState &client, const TickInput &input) {
+  if (input.taps) {
+    client.taps += input.taps;
+    client.tap_position = input.tap_positions[input.taps - 1];
+    client.tap_tick = std::max(client.render_tick, 0.0f);
+  }
+
+  bomaqs::NetWriter writer;
+  writer.size = 0;
+  writer.overflow = false;
+  bomaqs::write_u8(writer, NET_PACKET_INPUT);
+  bomaqs::write_varint(writer, client.taps);
+  bomaqs::write_signed(writer, quantize(client.tap_position.x));
+  bomaqs::write_signed(writer, quantize(client.tap_position.y));
+  bomaqs::write_u32(writer, client.tap_tick);
+  bomaqs::write_u32(writer, client.newest);
+  bomaqs::send_packet(client.socket, client.server, writer.data, writer.size);
+}
+
+inline NetSnapshot *find_client_snapshot(NetClientState &client, uint32_t tick) {
+  NetSnapshot &snapshot = client.history[(tick / NET_SNAPSHOT_TICKS) % NET_HISTORY];
+  return snapshot.tick == tick ? &snapshot : NULL;
+}
+
+// Takes in new snapshots and returns the world to draw this frame
+inline const GameWorld &receive_net_world(NetClientState &client, float frame_time) {
+  uint8_t buffer[NET_MAX_PACKET];
+  bomaqs::NetAddress from;
+  int size;
+  while ((size = bomaqs::receive_packet(client.socket, from, buffer, sizeof(buffer))) > 0) {
+    bomaqs::NetReader reader = {buffer, size, 0, false};
+    if (!bomaqs::same_address(from, client.server) ||
+        bomaqs::read_u8(reader) != NET_PACKET_SNAPSHOT) {
+      continue;
+    }
+
+    NetSnapshot snapshot;
+    int slot;
+    auto find_baseline = [&](uint32_t tick) { return find_client_snapshot(client, tick); };
+    if (!decode_snapshot(reader, snapshot, slot, find_baseline) || snapshot.tick <= client.newest) {
+      continue;
+    }
+    if (!client.newest) {
+      client.render_tick = snapshot.tick - NET_INTERP_TICKS;
+    }
+    client.history[(snapshot.tick / NET_SNAPSHOT_TICKS) % NET_HISTORY] = snapshot;
+    client.newest = snapshot.tick;
+    client.slot = slot;
+  }
+
+  if (!client.newest) {
+    return client.view;
+  }
+
+  // Render clock follows the newest snapshot NET_INTERP_TICKS behind, drifting gently back on
+  // track and snapping after stalls
+  client.render_tick += frame_time * FRAME_RATE;
+  float target = (float)client.newest - NET_INTERP_TICKS;
+  if (std::abs(client.render_tick - target) > NET_INTERP_TICKS * 2) {
+    client.render_tick = target;
+  } else {
+    client.render_tick += (target - client.render_tick) * 0.05f;
+  }
+
+  // Snapshots around the render tick, lost ones are bridged by the nearest pair
+  const NetSnapshot *a = NULL, *b = NULL;
+  for (auto &snapshot : client.history) {
+    if (!snapshot.tick) {
+      continue;
+    }
+    if (snapshot.tick <= client.render_tick && (!a || snapshot.tick > a->tick)) {
+      a = &snapshot;
+    }
+    if (snapshot.tick > client.render_tick && (!b || snapshot.tick < b->tick)) {
+      b = &snapshot;
+    }
+  }
+  if (!a) {
+    a = b;
+  }
+  if (!b) {
+    b = a;
+  }
+  float t = b->tick > a->tick ? (client.render_tick - a->tick) / (b->tick - a->tick) : 1;
+  interpolate_snapshots(*a, *b, std::clamp(t, 0.0f, 1.0f), client.view);
+
+  if (GetTime() - client.report_time >= NET_REPORT_SECONDS) {
+    unsigned long long bytes = client.socket.stats.bytes_received - client.report_bytes;
+    TraceLog(LOG_INFO, "NET: receiving %.2f KB/s, %llu packets dropped",
+             bytes / 1024.0 / (GetTime() - client.report_time),
+             client.socket.stats.packets_dropped);
+    client.report_bytes = client.socket.stats.bytes_received;
+    client.report_time = GetTime();
+  }
+  return client.view;
+}
+
+inline void stop_net_client(NetClientState &client) { bomaqs::close_udp_socket(client.socket); }
@@ -3,412 +3,1137 @@
 #include <raylib.h>
 #include <raymath.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
 #include <set>
 #include <string>
 #include <vector>
 
-#include "utils/data-loader.hpp"
+#include "dodge-machina-net.hpp"
+#include "utils/asset-manager.hpp"
+#include "utils/collision.hpp"
+#include "utils/fixed.hpp"
+#include "utils/frame-pacer.hpp"
+#include "utils/input-queue.hpp"
+#include "utils/job-system.hpp"
+#include "utils/latency-probe.hpp"
 #include "utils/math.hpp"
+#include "utils/scenario.hpp"
+#include "utils/session.hpp"
+#include "utils/sim-pipeline.hpp"
+#include "utils/startup-trace.hpp"
+#include "utils/state-hash.hpp"
+#include "utils/telemetry.hpp"
+
+// Shooter patterns from resources/patterns, loaded in this order, every new shooter takes the next
+std::vector<std::string> shooter_patterns = {"rifle", "fan", "spiral", "ring", "burst"};
+
+typedef struct {
+  bomaqs::AssetHandle background;
+  bomaqs::AssetHandle teleport_sfx;
+  bomaqs::AssetHandle boom_sfx;
+  bomaqs::AssetHandle bgm_music;
+} GameAssets;
+
+// Everything the game streams in, for the game and for --startup-check
+GameAssets queue_game_assets(bomaqs::AssetManager &assets) {
+  bomaqs::set_asset_budget(assets, bomaqs::ASSET_TEXTURE, ASSET_TEXTURE_BUDGET);
+  bomaqs::set_asset_budget(assets, bomaqs::ASSET_SOUND, ASSET_SOUND_BUDGET);
+  return {
+      .background = bomaqs::queue_texture(assets, "bg-grid.png"),
+      .teleport_sfx = bomaqs::queue_sound(assets, "teleport2.wav"),
+      .boom_sfx = bomaqs::queue_sound(assets, "boom1.wav"),
+      .bgm_music = bomaqs::queue_music(assets, "n-Dimensions (Main Theme).mp3"),
+  };
+}
 
-int main() {
-  InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Dodge Machina");
-  InitAudioDevice();
+// The windowless part of a cold start: audio device, bundle and asset decodes, no uploads.
+// Exits with 1 when that alone takes longer than budget_ms.
+int run_startup_check(double budget_ms) {
+  bomaqs::start_startup_trace("dodge-machina", budget_ms);
+  bomaqs::trace_startup_phase("init_audio", [] { InitAudioDevice(); });
+  bomaqs::trace_startup_phase("mount_bundle", [] { bomaqs::mount_bundle("dodge-machina.pak"); });
+  bomaqs::AssetManager assets;
+  bomaqs::init_asset_manager(assets);
+  queue_game_assets(assets);
+  bomaqs::wait_for_asset_decodes(assets);
+  double startup_ms = bomaqs::finish_startup_trace();
+
+  bomaqs::unload_assets(assets);
+  CloseAudioDevice();
+  return startup_ms > budget_ms;
+}
 
-  // load resources
-  Texture2D background = bomaqs::load_texture("bg-grid.png");
-  Sound teleport_sfx = bomaqs::load_sound("teleport2.wav");
-  Sound boom_sfx = bomaqs::load_sound("boom1.wav");
-  Music bgm_music = bomaqs::load_music("n-Dimensions (Main Theme).mp3");
-  bgm_music.looping = true;
-  SetMusicVolume(bgm_music, 0.25f);
+#ifndef BOMAQS_NO_MAIN  // bench/ and tests/ compile the game in without its main
+int main(int argc, char **argv) {
+  // dodge-machina [--server [port] | --connect [port] [--loss percent] | --hash-ticks ticks |
+  //                --startup-check [budget ms] | --scenario file [--render]]
+  bool serving = argc > 1 && strcmp(argv[1], "--server") == 0;
+  bool networked = argc > 1 && strcmp(argv[1], "--connect") == 0;
+  int port = argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : NET_DEFAULT_PORT;
+  int loss = 0;
+  for (int i = 1; i + 1 < argc; i++) {
+    loss = strcmp(argv[i], "--loss") == 0 ? atoi(argv[i + 1]) : loss;
+  }
 
-  PlayMusicStream(bgm_music);
-  SetTargetFPS(60);
+  // Headless scripted run printing a state hash per tick, for comparing builds
+  if (argc > 2 && strcmp(argv[1], "--hash-ticks") == 0) {
+    return run_hash_ticks(atoi(argv[2]));
+  }
+  if (argc > 1 && strcmp(argv[1], "--startup-check") == 0) {
+    return run_startup_check(argc > 2 ? atof(argv[2]) : STARTUP_BUDGET_MS);
+  }
+  if (argc > 2 && strcmp(argv[1], "--scenario") == 0) {
+    return run_scenario(argv[2], argc > 3 && strcmp(argv[3], "--render") == 0);
+  }
 
-  unsigned long long int frames_count = 0;
-  float score = 0;
+  // Headless authoritative server for networked games
+  if (serving) {
+    bomaqs::init_job_system(bomaqs::job_system);
+    int status = run_dodge_server(port, bomaqs::load_pattern_library(shooter_patterns), time(NULL));
+    bomaqs::shutdown_job_system(bomaqs::job_system);
+    return status;
+  }
 
-  GameWorld game_world = create_game_world();
-  int total_enemies_spawned = 0;
+  bomaqs::start_startup_trace("dodge-machina", STARTUP_BUDGET_MS);
+  bomaqs::trace_startup_phase("init_window",
+                              [] { InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Dodge Machina"); });
+  bomaqs::trace_startup_phase("init_audio", [] { InitAudioDevice(); });
+  bomaqs::init_input_queue(bomaqs::input_queue);
+
+  // load resources, the game is playable right away and assets stream in as they're ready
+  bomaqs::trace_startup_phase("mount_bundle", [] { bomaqs::mount_bundle("dodge-machina.pak"); });
+  bomaqs::AssetManager assets;
+  bomaqs::init_asset_manager(assets);
+  GameAssets game_assets = queue_game_assets(assets);
+  bool music_playing = false;
+  bool interactive = false;
+
+  bomaqs::FramePacer pacer;
+  bomaqs::init_frame_pacer(pacer, FRAME_RATE);
+  bomaqs::init_job_system(bomaqs::job_system);
+  bomaqs::start_telemetry("dodge-machina");
+
+  // Every reload makes a new library, the simulation may still be a few ticks behind on an older
+  // one so they're all kept until exit
+  std::deque<bomaqs::PatternLibrary> pattern_libraries;
+  bomaqs::trace_startup_phase("load_patterns", [&] {
+    pattern_libraries.push_back(bomaqs::load_pattern_library(shooter_patterns));
+  });
+  int pattern_check_countdown = PATTERN_RELOAD_CHECK_FRAMES;
+
+  // Pick up where the last session was sent to the background, or start a new game
+  bomaqs::mount_session_storage();
+  static GameWorld start_world;
+  reset_game_world(start_world, time(NULL));
+  bomaqs::trace_startup_phase("load_session", [] { load_session(start_world); });
+  bool was_background = false;
+
+  // The simulation runs a tick ahead on a worker while this thread draws the last snapshot
+  static bomaqs::SimPipeline<GameWorld, TickInput> simulation;
+  bomaqs::start_sim_pipeline(simulation, start_world, step_timed_game_world);
+  unsigned int teleports_seen = 0;
+  unsigned int explosions_seen = 0;
+  auto latency_probe = bomaqs::create_latency_probe("dodge-machina");
+
+  // Networked games draw the server's world instead, the local simulation idles
+  static NetClientState net_client;
+  networked = networked && start_net_client(net_client, port, loss);
 
   // Main game loop runs FRAME_RATE times a second
   while (!WindowShouldClose()) {
-    UpdateMusicStream(bgm_music);
+    bomaqs::update_asset_manager(assets);
+    if (IsKeyPressed(KEY_F9)) {
+      bomaqs::log_asset_memory_report(assets);
+    }
 
-    auto is_game_running = game_world.state == WorldState::RUNNING;
-    auto is_game_over = game_world.state == WorldState::GAME_OVER;
+    if (!music_playing && bomaqs::asset_ready(assets, game_assets.bgm_music)) {
+      auto &music = bomaqs::get_music(assets, game_assets.bgm_music);
+      bomaqs::set_music_streamer_volume(music, 0.25f);
+      bomaqs::play_music_streamer(music);
+      music_playing = true;
+    }
+    if (music_playing) {
+      bomaqs::update_music_streamer(bomaqs::get_music(assets, game_assets.bgm_music));
+    }
 
-    if (is_game_running) {
-      frames_count += 1;
-      score += 0.20f;
+    // Hot reload shooter patterns edited on disk, emitters restart on the new code
+    if (--pattern_check_countdown == 0) {
+      pattern_check_countdown = PATTERN_RELOAD_CHECK_FRAMES;
+      bomaqs::PatternLibrary library = pattern_libraries.back();
+      if (bomaqs::reload_changed_patterns(library)) {
+        pattern_libraries.push_back(library);
+      }
     }
 
-    // Reset game on tap after game over screen shows
-    if (GetGestureDetected() == GESTURE_TAP && is_game_over) {
-      game_world = create_game_world();
-      frames_count = 0;
-      score = 0;
-      total_enemies_spawned = 0;
+    // Input handling, the tick itself runs on the simulation thread
+    TickInput input = {
+        .taps = 0,
+        .in_background = IsWindowMinimized() || !IsWindowFocused(),
+        .frame_time = pacer.frame_time,
+        .patterns = &pattern_libraries.back(),
+    };
+#ifdef BOMAQS_FIXED_SIM
+    // Ticks can't depend on how long this machine's frames took
+    input.frame_time = 1.0f / FRAME_RATE;
+#endif
+    // Every tap since the last tick in order, taps past MAX_TICK_TAPS wait for the next one
+    bomaqs::poll_input_events(bomaqs::input_queue);
+    bomaqs::InputEvent event;
+    while (input.taps < MAX_TICK_TAPS && bomaqs::pop_input_event(bomaqs::input_queue, &event)) {
+      if (event.type == bomaqs::INPUT_PRESS) {
+        input.tap_positions[input.taps++] = event.position;
+        bomaqs::latency_input(latency_probe, event.time);
+      }
+    }
+    if (networked) {
+      send_net_input(net_client, input);
+    } else {
+      bomaqs::submit_sim_input(simulation, input);
     }
 
-    // Input handling
-    auto current_gesture = GetGestureDetected();
-    auto touch_position = GetTouchPosition(0);
+    const GameWorld &game_world = networked ? receive_net_world(net_client, input.frame_time)
+                                            : bomaqs::acquire_sim_snapshot(simulation);
 
-    // Tapping anywhere will teleport player to that position
-    if (game_world.player.state == LIVE && current_gesture == GESTURE_TAP) {
-      // PlaySoundMulti(teleport_sfx);
-      game_world.player.position.x = touch_position.x;
-      game_world.player.position.y = touch_position.y;
+    // Going to the background may be the last thing the app does, save the session now
+    if (input.in_background && !was_background && !networked) {
+      save_session(game_world);
     }
+    was_background = input.in_background;
 
-    // If player collides with bullet, shield loss for player
-    if (check_bullet_collisions(game_world.player, game_world.bullets)) {
-      game_world.player.shield -= 1;
+    // Effects for events that happened since the last snapshot we drew
+    if (game_world.teleports != teleports_seen) {
+      // PlaySoundMulti(game_assets.teleport_sfx);
+      bomaqs::latency_effect(latency_probe);
+      teleports_seen = game_world.teleports;
+    }
+    if (game_world.explosions != explosions_seen) {
+      if (bomaqs::asset_ready(assets, game_assets.boom_sfx)) {
+        PlaySoundMulti(bomaqs::get_sound(assets, game_assets.boom_sfx));
+      }
+      explosions_seen = game_world.explosions;
+    }
+    // Taps while the player is out (game over, dead) don't teleport, they start a new game at most
+    if (game_world.player.state != ActorState::LIVE) {
+      bomaqs::latency_no_effect(latency_probe);
     }
 
-    // Check if player is caught in blast radius of a homer enemy
-    if (check_homer_blast_collisions(game_world.player, game_world.enemies)) {
-      game_world.player.shield -= 1;
+    //---- Draw
+    // The world only changes while running, or after game over while bullets are still flying
+    // and reloading enemies flicker. Otherwise the last frame is presented at idle rate.
+    bool world_animating = game_world.state == WorldState::RUNNING || !game_world.bullets.empty();
+    for_each_archetype(game_world, [&](EnemyType, const auto &enemies) {
+      for (int i = 0; i < enemies.size(); i++) {
+        world_animating = world_animating || enemies.hot[i].state == ActorState::RELOADING;
+      }
+    });
+    if (world_animating || bomaqs::asset_progress(assets) < 1) {
+      bomaqs::mark_frame_dirty(pacer);
     }
 
-    // Player collisions with enemies
-    auto collided_enemies = check_enemy_collisions(game_world.player, game_world.enemies);
+    if (bomaqs::begin_scene(pacer)) {
+      ClearBackground(BLACK);
+      if (bomaqs::asset_ready(assets, game_assets.background)) {
+        DrawTexture(bomaqs::get_texture(assets, game_assets.background), 0, 0, (Color){15, 15, 15, 255});
+      }
 
-    if (collided_enemies.size()) {
-      for (auto idx : collided_enemies) {
-        // If enemy is reloading, kill enemy, otherwise game over for player
-        if (game_world.enemies[idx].state == ActorState::RELOADING) {
-          game_world.enemies[idx].state = ActorState::DEAD;
-        } else {
-          game_world.player.shield -= 1;
-        }
+      draw_game_world(game_world);
+      DrawFPS(10, 10);
+      if (networked) {
+        DrawText(net_client.newest ? TextFormat("Player %d", net_client.slot + 1) : "Connecting...",
+                 10, 35, 20, net_client.slot ? SKYBLUE : RED);
       }
+
+      EndMode2D();
     }
+    bomaqs::present_scene(pacer);
+    bomaqs::latency_frame_end(latency_probe);
+    if (!interactive) {
+      // Playable from the first frame, assets still loading don't hold it up
+      double startup_ms = bomaqs::finish_startup_trace();
+      bomaqs::log_event(bomaqs::TELEMETRY_STARTUP, startup_ms > STARTUP_BUDGET_MS, 0, startup_ms);
+      interactive = true;
+    }
+    bomaqs::wait_next_frame(pacer);
+    // draw(player, enemy);
+  }
 
-    // When player is out of shields and get hit, game over
-    if (game_world.player.shield < 0 && game_world.player.state != ActorState::DEAD) {
-      game_world.player.state = ActorState::DEAD;
-      game_world.state = WorldState::GAME_OVER;
+  //---- De-Init
+  if (networked) {
+    stop_net_client(net_client);
+  }
+  bomaqs::stop_sim_pipeline(simulation);
+  if (!networked) {
+    save_session(bomaqs::acquire_sim_snapshot(simulation));
+  }
+  bomaqs::shutdown_job_system(bomaqs::job_system);
+  bomaqs::stop_telemetry();
+  bomaqs::save_latency_histogram(latency_probe);
+  bomaqs::unload_frame_pacer(pacer);
+  StopSoundMulti();
+  bomaqs::unload_assets(assets);
+  bomaqs::unmount_bundle();
+  CloseAudioDevice();
+  CloseWindow();
+}
+#endif
+
+// One simulation tick. Runs on the simulation thread, so it only reads input and world: no raylib
+// input, clock, RNG or audio calls in here or in anything it calls.
+void update_game_world(GameWorld &world, const TickInput &input) {
+  // Pause while the window is in the background, resume when it's back
+  if (world.state == WorldState::RUNNING && input.in_background) {
+    world.state = WorldState::PAUSED;
+  } else if (world.state == WorldState::PAUSED && !input.in_background) {
+    world.state = WorldState::RUNNING;
+  }
+
+  // Nothing moves while paused
+  if (world.state == WorldState::PAUSED) {
+    return;
+  }
+
+  if (world.state == WorldState::RUNNING) {
+    world.frames_count += 1;
+    world.score += 0.20f;
+  } else if (input.taps || input.partner_tap) {
+    // Reset game on tap after game over screen shows, event counts and entity ids keep running
+    unsigned int teleports = world.teleports;
+    unsigned int explosions = world.explosions;
+    unsigned int next_entity_id = world.next_entity_id;
+    int bullet_limit = world.bullet_limit;
+    reset_game_world(world, world.rng);
+    world.teleports = teleports;
+    world.explosions = explosions;
+    world.next_entity_id = next_entity_id;
+    world.bullet_limit = bullet_limit;
+  }
+
+  // A second player joins while connected, and sits out the rest of the game once out of shields
+  if (!input.partner_present) {
+    world.partner.state = ActorState::DEAD;
+  } else if (world.partner.state == ActorState::DEAD && world.partner.shield >= 0) {
+    world.partner.state = ActorState::LIVE;
+  }
+
+  // Tapping anywhere will teleport player to that position, one teleport per tap
+  for (int i = 0; world.player.state == LIVE && i < input.taps; i++) {
+    world.player.position = input.tap_positions[i];
+    world.teleports += 1;
+  }
+  if (world.partner.state == LIVE && input.partner_tap) {
+    world.partner.position = input.partner_touch_position;
+    world.teleports += 1;
+  }
+
+  // Cause of the last shield lost this tick, reported if it ends the game
+  int hit_cause = check_player_hits(world, world.player);
+  if (world.partner.state == ActorState::LIVE) {
+    check_player_hits(world, world.partner);
+    if (world.partner.shield < 0) {
+      world.partner.state = ActorState::DEAD;
     }
+  }
 
-    // Enemy-enemy collisions, both enemies die, player receives bonus score
-    collided_enemies = check_enemy_enemy_collisions(game_world.enemies);
+  // When player is out of shields and get hit, game over
+  if (world.player.shield < 0 && world.player.state != ActorState::DEAD) {
+    world.player.state = ActorState::DEAD;
+    world.state = WorldState::GAME_OVER;
+    bomaqs::log_event(bomaqs::TELEMETRY_GAME_OVER, hit_cause, world.frames_count, world.score);
+  }
 
-    if (collided_enemies.size()) {
-      for (auto idx : collided_enemies) {
-        game_world.enemies[idx].state = ActorState::DEAD;
-        score += ENEMY_SELF_KILL_BONUS;
-        // TODO: PlaySound(bonus_score_sfx);
-      }
+  // Enemy-enemy collisions, both enemies die, player receives bonus score
+  auto collided_enemies = check_enemy_enemy_collisions(world);
+
+  if (collided_enemies.size()) {
+    for (auto enemy : collided_enemies) {
+      enemy_core(world, enemy).state = ActorState::DEAD;
+      world.score += ENEMY_SELF_KILL_BONUS;
+      bomaqs::log_event(bomaqs::TELEMETRY_ENEMY_KILLED, enemy.type, bomaqs::CAUSE_ENEMY_COLLISION,
+                        world.score);
+      // TODO: PlaySound(bonus_score_sfx);
     }
+  }
 
-    if (game_world.state == WorldState::RUNNING) {
-      // spawn new enemy
-      int enemies_count = game_world.enemies.size();
-      if (enemies_count < MAX_ENEMIES &&
-          frames_count % (FRAME_RATE * (enemies_count ? 5 : 1)) == 0) {
-        game_world.enemies.push_back(create_enemy(total_enemies_spawned));
-        enemies_count += 1;
-        total_enemies_spawned += 1;
+  if (world.state == WorldState::RUNNING) {
+    // spawn new enemy
+    int enemies_count = enemy_count(world);
+    if (enemies_count < MAX_ENEMIES &&
+        world.frames_count % (FRAME_RATE * (enemies_count ? 5 : 1)) == 0) {
+      bomaqs::SpawnGrid spawn_grid;
+      build_spawn_grid(world, spawn_grid);
+      if (create_enemy(world, spawn_grid)) {
+        world.total_enemies_spawned += 1;
       }
+    }
 
-      // update enemy, shoot, dash, follow
-      for (int i = 0; i < enemies_count; i++) {
-        Enemy *enemy = &game_world.enemies[i];
+    // Reloads and fuses that run out this tick, the rest cost nothing
+    bomaqs::advance_timers(world.timers, world.frames_count, [&](uint32_t tag, uint32_t slot) {
+      fire_enemy_timer(world, tag, slot);
+    });
 
-        // Dead enemies can't shoot or dash
-        if (enemy->state == ActorState::DEAD) {
-          continue;
-        }
+    // Each enemy type runs its own systems over its own arrays, no per-enemy type switches.
 
-        if (enemy->reload_timer >= 0) {
-          enemy->reload_timer -= GetFrameTime();
-          if (enemy->reload_timer <= 0) {
-            // shooters and dashers gets back to their business
-            if (enemy->state == ActorState::RELOADING) {
-              enemy->state = ActorState::LIVE;
-            }
-            // explode homers
-            if (enemy->state == ActorState::DESTRUCT) {
-              enemy->state = ActorState::DEAD;
-              // TODO: play explosion sound effect/trigger vfx
-              PlaySoundMulti(boom_sfx);
-              continue;
-            }
-          }
-        }
+    // firing is up to the shooter's pattern, run for all shooters after movement. Patterns that
+    // `wait rate` speed up at set intervals
+    if (world.frames_count % FIRE_RATE_RAMPUP_INTERVAL == 0) {
+      ramp_up_shooters(world.shooters);
+    }
 
-        if (enemy->state == ActorState::RELOADING || enemy->state == ActorState::DESTRUCT) {
-          continue;
-        }
+    // Dash and follow decisions, time-sliced: enemies far from the players think less often
+    bomaqs::run_ai_schedule(world.dasher_ai, world.dashers.hot, world.dashers.size(),
+                            world.frames_count,
+                            [&](int i) { return think_dasher(world, world.dashers.hot[i]); });
+    bomaqs::run_ai_schedule(world.homer_ai, world.homers.hot, world.homers.size(),
+                            world.frames_count, [&](int i) { return think_homer(world, i); });
 
-        switch (enemy->type) {
-          case EnemyType::SHOOTER: {
-            // enemy can shoot at set intervals (based on enemy.fire_rate)
-            if (frames_count == 0 || frames_count % enemy->fire_rate == 0) {
-              if (game_world.bullets.size() < MAX_BULLETS) {
-                enemy->shots_fired += 1;
-                game_world.bullets.push_back(create_bullet(*enemy, game_world.player));
-              }
-              // Set enemy state to RELOADING after x amount of bullets
-              if (enemy->shots_fired >= enemy->shots_per_round) {
-                enemy->shots_fired = 0;
-                enemy->state = ActorState::RELOADING;
-                enemy->reload_timer = ENEMY_RELOAD_TIMER;
-              }
-            }
+    // Movement is integrated every tick whether or not the enemy thought, shooters stand still
+    stop_dashers_at_bounds(world);
+    move_enemies(world.dashers);
+    move_enemies(world.homers);
 
-            // Increase fire rate at set interval
-            if (frames_count % FIRE_RATE_RAMPUP_INTERVAL == 0) {
-              enemy->fire_rate = std::max(enemy->fire_rate - 1, BULLET_FIRE_RATE_MAX);
-            }
-            break;
-          }
-          case EnemyType::DASHER: {
-            // TODO: tweak bound rect, may be check enemy rect center point
-            // inside dasher bounds?
-            Rectangle enemy_rect = {
-                .x = enemy->position.x - 10,
-                .y = enemy->position.y - 10,
-                .width = 20,
-                .height = 20,
-            };
-
-            // skip enemy that is already dashing
-            if (enemy->velocity.x == 0 && enemy->velocity.y == 0) {
-              auto vel =
-                  get_homing_velocity(game_world.player.position, enemy->position, DASHER_VELOCITY);
-              enemy->velocity.x = vel.x;
-              enemy->velocity.y = vel.y;
-            }
-            // check dasher bounds, if inside continue to move, or stop moving
-            else if (!CheckCollisionRecs(DASHER_BOUNDS, enemy_rect)) {
-              enemy->velocity.x = 0;
-              enemy->velocity.y = 0;
-              enemy->state = ActorState::RELOADING;
-              enemy->reload_timer = ENEMY_RELOAD_TIMER;
-            }
-            break;
-          }
-          case EnemyType::HOMING: {
-            auto vel =
-                get_homing_velocity(game_world.player.position, enemy->position, HOMING_VELOCITY);
-            enemy->velocity.x = vel.x;
-            enemy->velocity.y = vel.y;
-
-            // If homer is at a set distance from player, trigger explosion with a set blast radius
-            auto distance = std::abs(Vector2Distance(game_world.player.position, enemy->position));
-            if (distance <= HOMER_BLAST_TRIGGER_DISTANCE) {
-              enemy->state = ActorState::DESTRUCT;
-              enemy->reload_timer = ENEMY_RELOAD_TIMER;
-              enemy->trail_pos.clear();
-            }
-            break;
+    fire_shooter_patterns(world, *input.patterns);
+  }
+
+  // TODO: remove enemy after a delay
+  remove_dead_enemies(world);
+
+  // bullets update, remove out of bound bullets
+  update_bullets(world.bullets);
+}
+
+// The game's pipeline step: the tick, timed from out here for the AI budget report so the tick itself
+// never reads the clock
+void step_timed_game_world(GameWorld &world, const TickInput &input) {
+  auto start = std::chrono::steady_clock::now();
+  update_game_world(world, input);
+  std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+  bomaqs::report_ai_budget(world.dasher_ai.deferred + world.homer_ai.deferred, elapsed.count());
+}
+
+// Cadence of the next think follows the distance to the closest player
+int enemy_think_cadence(const GameWorld &world, Vector2 position) {
+  float distance_squared = INFINITY;
+  for (const Player *player : {&world.player, &world.partner}) {
+    if (player->state == ActorState::LIVE) {
+      float dx = player->position.x - position.x;
+      float dy = player->position.y - position.y;
+      distance_squared = std::min(distance_squared, (dx * dx) + (dy * dy));
+    }
+  }
+  return bomaqs::ai_lod_cadence(distance_squared);
+}
+
+// One AI think, dashers aim a dash. Returns the ticks until the dasher should think again.
+int think_dasher(const GameWorld &world, EnemyCore &dasher) {
+  // skip dasher that is already dashing, movement stops it at the bounds
+  if (dasher.state == ActorState::LIVE && dasher.velocity.x == 0 && dasher.velocity.y == 0) {
+    dasher.velocity = get_homing_velocity(world.player.position, dasher.position, DASHER_VELOCITY);
+  }
+  return enemy_think_cadence(world, dasher.position);
+}
+
+// One AI think, homers re-aim at the player and arm when close enough
+int think_homer(GameWorld &world, int slot) {
+  EnemyCore &homer = world.homers.hot[slot];
+  if (homer.state == ActorState::LIVE) {
+    homer.velocity = get_homing_velocity(world.player.position, homer.position, HOMING_VELOCITY);
+
+    // If homer is at a set distance from player, trigger explosion with a set blast radius
+    if (within_distance(world.player.position, homer.position, HOMER_BLAST_TRIGGER_DISTANCE)) {
+      homer.state = ActorState::DESTRUCT;
+      start_enemy_timer(world, TIMER_HOMER_FUSE, slot);
+      world.homers.cold[slot].trail.count = 0;
+    }
+  }
+  return enemy_think_cadence(world, homer.position);
+}
+
+// ENEMY_RELOAD_TICKS for the enemy in slot of the archetype tag belongs to
+void start_enemy_timer(GameWorld &world, EnemyTimer tag, int slot) {
+  EnemyCore &enemy = tag == TIMER_SHOOTER_RELOAD ? world.shooters.hot[slot]
+                     : tag == TIMER_DASHER_RELOAD ? world.dashers.hot[slot]
+                                                  : world.homers.hot[slot];
+  bomaqs::cancel_timer(world.timers, enemy.timer);
+  enemy.timer = bomaqs::start_timer(world.timers, ENEMY_RELOAD_TICKS, tag, slot);
+}
+
+void fire_enemy_timer(GameWorld &world, uint32_t tag, uint32_t slot) {
+  if (tag == TIMER_HOMER_FUSE) {
+    // explode homers
+    EnemyCore &homer = world.homers.hot[slot];
+    if (homer.state == ActorState::DESTRUCT) {
+      homer.state = ActorState::DEAD;
+      // TODO: trigger vfx
+      world.explosions += 1;
+    }
+    return;
+  }
+
+  // shooters and dashers gets back to their business
+  EnemyCore &enemy = tag == TIMER_SHOOTER_RELOAD ? world.shooters.hot[slot] : world.dashers.hot[slot];
+  if (enemy.state == ActorState::RELOADING) {
+    enemy.state = ActorState::LIVE;
+  }
+}
+
+// Swap-removes dead enemies, cancelling their timers. Timers of the enemies moved into their slots
+// follow them.
+void remove_dead_enemies(GameWorld &world) {
+  for_each_archetype(world, [&](EnemyType, auto &enemies) {
+    enemies.remove_if(
+        [&](const EnemyCore &enemy) {
+          if (enemy.state != ActorState::DEAD) {
+            return false;
           }
-          default:
-            break;
-        }
+          bomaqs::cancel_timer(world.timers, enemy.timer);
+          return true;
+        },
+        [&](int slot) { bomaqs::set_timer_data(world.timers, enemies.hot[slot].timer, slot); });
+  });
+}
 
-        // store enemy current pos to it's trail
-        if (enemy->trail_pos.size() == MAX_ENEMY_TRAIL) {
-          enemy->trail_pos.erase(enemy->trail_pos.begin());
-        }
-        enemy->trail_pos.push_back(enemy->position);
+void ramp_up_shooters(ShooterArchetype &shooters) {
+  for (int i = 0; i < shooters.size(); i++) {
+    if (shooters.hot[i].state == ActorState::LIVE) {
+      ShooterExtra &shooter = shooters.cold[i];
+      shooter.fire_rate = std::max(shooter.fire_rate - 1, BULLET_FIRE_RATE_MAX);
+      shooter.emitter.rate = shooter.fire_rate;
+    }
+  }
+}
 
-        // Moves enemy with respect to it's velocity and direction
-        enemy->position.x += enemy->velocity.x;
-        enemy->position.y += enemy->velocity.y;
-      }
+// dashers stop once they leave the dasher bounds
+void stop_dashers_at_bounds(GameWorld &world) {
+  EnemyArchetype &dashers = world.dashers;
+  for (int i = 0; i < dashers.size(); i++) {
+    EnemyCore &dasher = dashers.hot[i];
+    // TODO: tweak bound rect, may be check enemy rect center point inside dasher bounds?
+    Rectangle dasher_rect = {
+        .x = dasher.position.x - 10,
+        .y = dasher.position.y - 10,
+        .width = 20,
+        .height = 20,
+    };
+    if (dasher.state == ActorState::LIVE && (dasher.velocity.x != 0 || dasher.velocity.y != 0) &&
+        !CheckCollisionRecs(DASHER_BOUNDS, dasher_rect)) {
+      dasher.velocity.x = 0;
+      dasher.velocity.y = 0;
+      dasher.state = ActorState::RELOADING;
+      start_enemy_timer(world, TIMER_DASHER_RELOAD, i);
+    }
+  }
+}
+
+// Moves live enemies with respect to their velocity and direction, leaving a trail
+void move_enemies(EnemyArchetype &enemies) {
+  for (int i = 0; i < enemies.size(); i++) {
+    EnemyCore &enemy = enemies.hot[i];
+    enemy.last_position = enemy.position;
+    if (enemy.state != ActorState::LIVE) {
+      continue;
     }
+    push_trail(enemies.cold[i].trail, enemy.position);
+    enemy.position.x += enemy.velocity.x;
+    enemy.position.y += enemy.velocity.y;
+  }
+}
+
+void push_trail(EnemyTrail &trail, Vector2 position) {
+  if (trail.count < MAX_ENEMY_TRAIL) {
+    trail.positions[(trail.start + trail.count++) % MAX_ENEMY_TRAIL] = position;
+  } else {
+    trail.positions[trail.start] = position;
+    trail.start = (trail.start + 1) % MAX_ENEMY_TRAIL;
+  }
+}
 
-    // Remove dead enemies
-    std::vector<Enemy> updated_list;
-    for (auto enemy : game_world.enemies) {
-      // TODO: remove enemy after a delay
-      if (enemy.state != ActorState::DEAD) {
-        updated_list.push_back(enemy);
+// Bullets, homer blasts and enemy contact for one player. Returns the cause of the last shield
+// lost, CAUSE_NONE if none was.
+int check_player_hits(GameWorld &world, Player &player) {
+  int hit_cause = bomaqs::CAUSE_NONE;
+
+  // If player collides with bullet, shield loss for player
+  if (check_bullet_collisions(player, world.bullets)) {
+    player.shield -= 1;
+    hit_cause = bomaqs::CAUSE_BULLET;
+    bomaqs::log_event(bomaqs::TELEMETRY_SHIELD_LOST, hit_cause, player.shield);
+  }
+
+  // Check if player is caught in blast radius of a homer enemy
+  if (check_homer_blast_collisions(player, world)) {
+    player.shield -= 1;
+    hit_cause = bomaqs::CAUSE_HOMER_BLAST;
+    bomaqs::log_event(bomaqs::TELEMETRY_SHIELD_LOST, hit_cause, player.shield);
+  }
+
+  // Player collisions with enemies
+  auto collided_enemies = check_enemy_collisions(player, world);
+
+  if (collided_enemies.size()) {
+    for (auto enemy : collided_enemies) {
+      // If enemy is reloading, kill enemy, otherwise game over for player
+      EnemyCore &core = enemy_core(world, enemy);
+      if (core.state == ActorState::RELOADING) {
+        core.state = ActorState::DEAD;
+        bomaqs::log_event(bomaqs::TELEMETRY_ENEMY_KILLED, enemy.type, bomaqs::CAUSE_ENEMY_CONTACT,
+                          world.score);
+      } else {
+        player.shield -= 1;
+        hit_cause = bomaqs::CAUSE_ENEMY_CONTACT;
+        bomaqs::log_event(bomaqs::TELEMETRY_SHIELD_LOST, hit_cause, player.shield);
       }
     }
-    game_world.enemies = updated_list;
+  }
 
-    // bullets update, remove out of bound bullets
-    game_world.bullets = update_bullets(game_world.bullets);
+  return hit_cause;
+}
 
-    //---- Draw
-    BeginDrawing();
-    ClearBackground(BLACK);
-    DrawTexture(background, 0, 0, (Color){15, 15, 15, 255});
-
-    // Draw game world
-    DrawCircleLines(game_world.player.position.x, game_world.player.position.y, PLAYER_RADIUS,
-                    game_world.player.color);
-    draw_enemies(game_world.enemies);
-    draw_bullets(game_world.bullets);
-    // debug dasher bounds
-    DrawRectangleLinesEx(DASHER_BOUNDS, 2, GREEN);
-
-    // game over
-    if (game_world.player.state == DEAD) {
-      DrawText("You Died!", (SCREEN_WIDTH / 2) - 100, (SCREEN_HEIGHT / 2) - 25, 40, YELLOW);
-    }
-
-    DrawFPS(10, 10);
-    std::string score_text = "Score: ";
-    score_text.append(TextFormat("%02.00f", score));
-    DrawText(score_text.data(), SCREEN_WIDTH - 120, 10, 20, ORANGE);
-
-    std::string shield_string = "Shields: ";
-    shield_string.append(std::to_string(std::max(0, game_world.player.shield)));
-    DrawText(shield_string.data(), SCREEN_WIDTH / 2 - 50, 10, 20, GRAY);
-
-    EndMode2D();
-    EndDrawing();
-    // draw(player, enemy);
+void draw_game_world(const GameWorld &world) {
+  // Draw game world
+  DrawCircleLines(world.player.position.x, world.player.position.y, PLAYER_RADIUS,
+                  world.player.color);
+  if (world.partner.state == ActorState::LIVE) {
+    DrawCircleLines(world.partner.position.x, world.partner.position.y, PLAYER_RADIUS,
+                    world.partner.color);
+  }
+  draw_enemies(world);
+  draw_bullets(world.bullets);
+  // debug dasher bounds
+  DrawRectangleLinesEx(DASHER_BOUNDS, 2, GREEN);
+
+  // game over
+  if (world.player.state == DEAD) {
+    DrawText("You Died!", (SCREEN_WIDTH / 2) - 100, (SCREEN_HEIGHT / 2) - 25, 40, YELLOW);
   }
 
-  //---- De-Init
-  StopSoundMulti();
-  UnloadMusicStream(bgm_music);
-  UnloadSound(teleport_sfx);
-  UnloadSound(boom_sfx);
-  UnloadTexture(background);
-  CloseAudioDevice();
-  CloseWindow();
+  std::string score_text = "Score: ";
+  score_text.append(TextFormat("%02.00f", world.score));
+  DrawText(score_text.data(), SCREEN_WIDTH - 120, 10, 20, ORANGE);
+
+  std::string shield_string = "Shields: ";
+  shield_string.append(std::to_string(std::max(0, world.player.shield)));
+  DrawText(shield_string.data(), SCREEN_WIDTH / 2 - 50, 10, 20, GRAY);
 }
 
 Vector2 get_homing_velocity(Vector2 pos1, Vector2 pos2, int velocity) {
+#ifdef BOMAQS_FIXED_SIM
+  return bomaqs::fixed_direction(pos2, pos1, bomaqs::int_to_fixed(velocity));
+#else
   auto angle = bomaqs::coordinate_angle(pos1, pos2);
   return {(float)cos(angle) * velocity, (float)sin(angle) * velocity};
+#endif
 }
 
-GameWorld create_game_world() {
-  Player player = {.position = {.x = SCREEN_WIDTH / 2, .y = SCREEN_HEIGHT - 200},
-                   .color = RED,
-                   .state = ActorState::LIVE,
-                   .shield = INITIAL_PLAYER_SHIELDS};
-  std::vector<Bullet> bullets;
-  std::vector<Enemy> enemies;
+bool within_distance(Vector2 pos1, Vector2 pos2, float distance) {
+#ifdef BOMAQS_FIXED_SIM
+  return bomaqs::fixed_distance(pos1, pos2) <= bomaqs::to_fixed(distance);
+#else
+  return Vector2Distance(pos1, pos2) <= distance;
+#endif
+}
 
-  return {
-      .player = player,
-      .enemies = enemies,
-      .bullets = bullets,
-      .state = WorldState::RUNNING,
-  };
+// The world is flat, it's saved as a single record and read back straight from the file
+bool save_session(const GameWorld &world) {
+  bomaqs::SessionWriter writer;
+  bomaqs::begin_session(writer, SESSION_SCHEMA_VERSION);
+  bomaqs::add_session_records(writer, "WRLD", &world, 1);
+  return bomaqs::write_session(writer, bomaqs::session_path("dodge-machina").data());
 }
 
-Bullet create_bullet(Enemy enemy, Player player) {
-  Bullet bullet = {
-      .position = enemy.position,
-      .color = BLACK,
-      .velocity = get_homing_velocity(player.position, enemy.position, BULLET_VELOCITY),
-  };
+bool load_session(GameWorld &world) {
+  bomaqs::SessionFile session;
+  if (!bomaqs::open_session(session, bomaqs::session_path("dodge-machina").data(),
+                            SESSION_SCHEMA_VERSION)) {
+    return false;
+  }
 
-  return bullet;
+  int count = 0;
+  const GameWorld *saved = bomaqs::session_records<GameWorld>(session, "WRLD", &count);
+  if (count == 1) {
+    world = *saved;
+  }
+  bomaqs::close_session(session);
+  return count == 1;
+}
+
+// Every field that affects later ticks, in a fixed order
+uint64_t hash_game_world(const GameWorld &world) {
+  bomaqs::StateHash hash = bomaqs::start_state_hash();
+  for (const Player *player : {&world.player, &world.partner}) {
+    bomaqs::hash_value(hash, player->position);
+    bomaqs::hash_value(hash, player->state);
+    bomaqs::hash_value(hash, player->shield);
+  }
+  for_each_archetype(world, [&](EnemyType, const auto &enemies) {
+    bomaqs::hash_value(hash, enemies.size());
+    for (int i = 0; i < enemies.size(); i++) {
+      const EnemyCore &enemy = enemies.hot[i];
+      bomaqs::hash_value(hash, enemy.position);
+      bomaqs::hash_value(hash, enemy.velocity);
+      bomaqs::hash_value(hash, enemy.last_position);
+      bomaqs::hash_value(hash, enemy.state);
+      bomaqs::hash_value(hash, bomaqs::timer_remaining(world.timers, enemy.timer));
+      bomaqs::hash_value(hash, enemy.id);
+      bomaqs::hash_value(hash, enemy.next_think);
+    }
+  });
+  for (int i = 0; i < world.shooters.size(); i++) {
+    const ShooterExtra &shooter = world.shooters.cold[i];
+    bomaqs::hash_value(hash, shooter.fire_rate);
+    bomaqs::hash_value(hash, shooter.emitter.pc);
+    bomaqs::hash_value(hash, shooter.emitter.wait);
+    bomaqs::hash_value(hash, shooter.emitter.angle);
+    bomaqs::hash_value(hash, shooter.emitter.speed);
+  }
+  bomaqs::hash_value(hash, world.bullets.size());
+  bomaqs::hash_value(hash, world.bullet_limit);
+  for (auto &bullet : world.bullets) {
+    bomaqs::hash_value(hash, bullet.position);
+    bomaqs::hash_value(hash, bullet.velocity);
+    bomaqs::hash_value(hash, bullet.state);
+    bomaqs::hash_value(hash, bullet.id);
+  }
+  bomaqs::hash_value(hash, world.state);
+  bomaqs::hash_value(hash, world.frames_count);
+  bomaqs::hash_value(hash, world.score);
+  bomaqs::hash_value(hash, world.total_enemies_spawned);
+  bomaqs::hash_value(hash, world.rng);
+  bomaqs::hash_value(hash, world.next_entity_id);
+  bomaqs::hash_value(hash, world.timers.now);
+  bomaqs::hash_value(hash, world.timers.active);
+  for (const bomaqs::AiSchedule *ai : {&world.dasher_ai, &world.homer_ai}) {
+    bomaqs::hash_value(hash, ai->cursor);
+    bomaqs::hash_value(hash, ai->deferred);
+  }
+  return hash.value;
+}
+
+// Fixed seed and a tap every HASH_RUN_TAP_TICKS at scripted positions, so every build plays the
+// same game. Taps also restart it after game over.
+int run_hash_ticks(int ticks) {
+  bomaqs::init_job_system(bomaqs::job_system);
+  bomaqs::PatternLibrary patterns = bomaqs::load_pattern_library(shooter_patterns);
+  static GameWorld world;
+  reset_game_world(world, HASH_RUN_SEED);
+  unsigned int script = HASH_RUN_SEED;
+
+  for (int tick = 1; tick <= ticks; tick++) {
+    script = script * 1664525 + 1013904223;
+    TickInput input = {
+        .taps = tick % HASH_RUN_TAP_TICKS == 0,
+        .tap_positions = {{(float)((script >> 8) % SCREEN_WIDTH),
+                           (float)((script >> 20) % SCREEN_HEIGHT)}},
+        .in_background = false,
+        .frame_time = 1.0f / FRAME_RATE,
+        .patterns = &patterns,
+    };
+    update_game_world(world, input);
+    bomaqs::print_state_hash(tick, {hash_game_world(world)});
+  }
+
+  bomaqs::shutdown_job_system(bomaqs::job_system);
+  return 0;
+}
+
+// Stress scenario (see src/utils/scenario.hpp), on this thread so ticks are timed where they run.
+// Dodge Machina's directives:
+//   bullets <n>                            live bullet limit, up to BULLET_CAPACITY
+//   shields <n>                            player shields, plenty keeps the player alive all run
+//   spawn shooter|dasher|homer <n> [pattern]  enemies placed like the game's, shooters firing the
+//                                          named pattern (any in resources/patterns), the game's
+//                                          first one otherwise
+//   tap every <ticks>                      taps at scripted positions, like --hash-ticks
+//   tap <tick> <x> <y>
+// The game spawns as usual when under MAX_ENEMIES, taps after game over start a new game. Only
+// BOMAQS_STRESS_CAPACITY builds have room for more bullets and enemies than a game.
+int run_scenario(const char *path, bool rendered) {
+  bomaqs::Scenario scenario;
+  if (!bomaqs::load_scenario(path, "dodge-machina", scenario)) {
+    return 1;
+  }
+
+  static GameWorld world;
+  reset_game_world(world, scenario.seed);
+  bomaqs::SpawnGrid grid;
+  build_spawn_grid(world, grid);
+  std::vector<std::string> pattern_names = shooter_patterns;
+  int tap_every = 0;
+  std::vector<std::pair<int, Vector2>> taps;
+  bool valid = true;
+  std::vector<float> numbers;
+  for (auto &line : scenario.lines) {
+    if (line.directive == "bullets" || line.directive == "shields") {
+      if (!bomaqs::scenario_numbers(scenario, line, 1, 1, numbers)) {
+        valid = false;
+      } else if (line.directive == "bullets" && numbers[0] > BULLET_CAPACITY) {
+        bomaqs::scenario_warning(scenario, line,
+                                 TextFormat("is over this build's %d bullets, build with "
+                                            "BOMAQS_STRESS_CAPACITY",
+                                            BULLET_CAPACITY));
+        valid = false;
+      } else if (line.directive == "bullets") {
+        world.bullet_limit = (int)numbers[0];
+      } else {
+        world.player.shield = (int)numbers[0];
+      }
+    } else if (line.directive == "spawn") {
+      const char *types[] = {"shooter", "dasher", "homer"};
+      int type = line.words.empty() ? 3 : 0;
+      while (type < 3 && line.words[0] != types[type]) {
+        type += 1;
+      }
+      std::string name = line.words.size() > 2 ? line.words[2] : shooter_patterns[0];
+      if (type == 3 || line.words.size() < 2 ||
+          !FileExists(bomaqs::get_real_path(bomaqs::pattern_path(name)).data())) {
+        bomaqs::scenario_warning(scenario, line, "takes a type, a count and a known pattern");
+        valid = false;
+        continue;
+      }
+      int pattern = std::find(pattern_names.begin(), pattern_names.end(), name) -
+                    pattern_names.begin();
+      if (pattern == (int)pattern_names.size()) {
+        pattern_names.push_back(name);
+      }
+      for (int i = atoi(line.words[1].data()); i > 0 && valid; i--) {
+        if (spawn_enemy(world, grid, (EnemyType)type, spawn_region(world, (EnemyType)type),
+                        pattern) < 0) {
+          bomaqs::scenario_warning(scenario, line,
+                                   TextFormat("is over this build's %d %ss, build with "
+                                              "BOMAQS_STRESS_CAPACITY",
+                                              ENEMY_ARCHETYPE_CAPACITY, types[type]));
+          valid = false;
+        }
+      }
+    } else if (line.directive == "tap" && !line.words.empty() && line.words[0] == "every") {
+      tap_every = line.words.size() > 1 ? atoi(line.words[1].data()) : 0;
+    } else if (line.directive == "tap") {
+      if (bomaqs::scenario_numbers(scenario, line, 3, 3, numbers)) {
+        taps.push_back({(int)numbers[0], {numbers[1], numbers[2]}});
+      } else {
+        valid = false;
+      }
+    } else {
+      bomaqs::scenario_warning(scenario, line, "isn't a Dodge Machina directive");
+      valid = false;
+    }
+  }
+  if (!valid) {
+    return 1;
+  }
+  std::stable_sort(taps.begin(), taps.end(),
+                   [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  bomaqs::init_job_system(bomaqs::job_system);
+  bomaqs::PatternLibrary patterns = bomaqs::load_pattern_library(pattern_names);
+  if (rendered) {
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Dodge Machina");
+  }
+
+  bomaqs::ScenarioStats stats;
+  bomaqs::start_scenario_stats(stats, scenario);
+  unsigned int script = scenario.seed;
+  size_t next_tap = 0;
+  int peak_bullets = 0, peak_enemies = 0;
+  for (int tick = 1; tick <= scenario.ticks && !(rendered && WindowShouldClose()); tick++) {
+    script = script * 1664525 + 1013904223;
+    TickInput input = {
+        .taps = 0,
+        .in_background = false,
+        .frame_time = 1.0f / FRAME_RATE,
+        .patterns = &patterns,
+    };
+    if (tap_every > 0 && tick % tap_every == 0) {
+      input.tap_positions[input.taps++] = {(float)((script >> 8) % SCREEN_WIDTH),
+                                           (float)((script >> 20) % SCREEN_HEIGHT)};
+    }
+    for (; next_tap < taps.size() && taps[next_tap].first <= tick; next_tap++) {
+      if (input.taps < MAX_TICK_TAPS) {
+        input.tap_positions[input.taps++] = taps[next_tap].second;
+      }
+    }
+    update_game_world(world, input);
+
+    if (rendered) {
+      BeginDrawing();
+      ClearBackground(BLACK);
+      draw_game_world(world);
+      DrawFPS(10, 10);
+      EndDrawing();
+    }
+    peak_bullets = std::max(peak_bullets, world.bullets.size());
+    peak_enemies = std::max(peak_enemies, enemy_count(world));
+    bomaqs::record_scenario_tick(stats);
+  }
+
+  if (rendered) {
+    CloseWindow();
+  }
+  bomaqs::shutdown_job_system(bomaqs::job_system);
+  return bomaqs::report_scenario(
+      scenario, stats, rendered,
+      TextFormat("peak %d bullets, %d enemies, %u explosions, score %.0f", peak_bullets,
+                 peak_enemies, world.explosions, world.score));
+}
+
+// In place, worlds are too big to build on the stack and copy
+void reset_game_world(GameWorld &world, unsigned int seed) {
+  world.player = {.position = {.x = SCREEN_WIDTH / 2, .y = SCREEN_HEIGHT - 200},
+                  .color = RED,
+                  .state = ActorState::LIVE,
+                  .shield = INITIAL_PLAYER_SHIELDS};
+  world.partner = {.position = {.x = SCREEN_WIDTH / 2, .y = SCREEN_HEIGHT - 120},
+                   .color = SKYBLUE,
+                   .state = ActorState::DEAD,
+                   .shield = INITIAL_PLAYER_SHIELDS};
+  world.shooters.clear();
+  world.dashers.clear();
+  world.homers.clear();
+  world.bullets.clear();
+  world.bullet_limit = MAX_BULLETS;
+  world.state = WorldState::RUNNING;
+  world.frames_count = 0;
+  world.score = 0;
+  world.total_enemies_spawned = 0;
+  world.rng = seed ? seed : 1;
+  world.next_entity_id = 1;
+  world.dasher_ai = bomaqs::create_ai_schedule(AI_THINK_BUDGET);
+  world.homer_ai = bomaqs::create_ai_schedule(AI_THINK_BUDGET);
+  bomaqs::init_timer_wheel(world.timers, 0);
+  world.teleports = 0;
+  world.explosions = 0;
+}
+
+// Steps the pattern of every shooter that's live this tick, new bullets go straight into the pool
+void fire_shooter_patterns(GameWorld &world, const bomaqs::PatternLibrary &patterns) {
+  ShooterArchetype &shooters = world.shooters;
+  for (int i = 0; i < shooters.size(); i++) {
+    EnemyCore &shooter = shooters.hot[i];
+    if (shooter.state != ActorState::LIVE) {
+      continue;
+    }
+
+    int signals = bomaqs::step_emitter(
+        patterns, shooters.cold[i].emitter, shooter.position, world.player.position,
+        [&](Vector2 position, Vector2 velocity) {
+          if (world.bullets.size() < world.bullet_limit) {
+            world.bullets.push_back(
+                {position, BLACK, velocity, ActorState::LIVE, position, world.next_entity_id++});
+          }
+        });
+
+    // Reloading shooters can be killed by running into them
+    if (signals & PATTERN_RELOAD) {
+      shooter.state = ActorState::RELOADING;
+      start_enemy_timer(world, TIMER_SHOOTER_RELOAD, i);
+    }
+  }
+}
+
+// xorshift32, deterministic per world so ticks replay the same on any thread
+int world_random(GameWorld &world, int min, int max) {
+  world.rng ^= world.rng << 13;
+  world.rng ^= world.rng >> 17;
+  world.rng ^= world.rng << 5;
+  return min + (int)(world.rng % (unsigned int)(max - min + 1));
 }
 
 Color enemy_colors[3] = {DARKGREEN, BLUE, VIOLET};
 EnemyType enemy_order[MAX_ENEMIES] = {EnemyType::SHOOTER, EnemyType::HOMING, EnemyType::DASHER,
                                       EnemyType::DASHER};
 
-Enemy create_enemy(int total_spawned) {
-  // Avoid overlapping enemy and player, as well as other enemies
-  // Keep min x distance from other enemies and player
+// Everything a new enemy has to keep away from
+void build_spawn_grid(const GameWorld &world, bomaqs::SpawnGrid &grid) {
+  bomaqs::init_spawn_grid(grid, {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT}, SPAWN_CELL_SIZE);
+  for (const Player *player : {&world.player, &world.partner}) {
+    if (player->state == ActorState::LIVE) {
+      bomaqs::add_spawn_occupant(grid, player->position, SPAWN_PLAYER_CLEARANCE);
+    }
+  }
+  for_each_archetype(world, [&](EnemyType, const auto &enemies) {
+    for (int i = 0; i < enemies.size(); i++) {
+      if (enemies.hot[i].state != ActorState::DEAD) {
+        bomaqs::add_spawn_occupant(grid, enemies.hot[i].position, SPAWN_ENEMY_CLEARANCE);
+      }
+    }
+  });
+}
+
+// The new enemy is added to grid, so further spawns in the same tick keep clear of it too. False if
+// its type is at capacity.
+bool create_enemy(GameWorld &world, bomaqs::SpawnGrid &grid) {
   // Some randonmess in fire rate and other timings
   // Enemy spawn probability
-  float x, y;
+  Rectangle region;
+  int total_spawned = world.total_enemies_spawned;
   EnemyType type = enemy_order[total_spawned % MAX_ENEMIES];
   if (total_spawned == 0) {
     // First enemy is fixed
-    x = (SCREEN_WIDTH / 2) + GetRandomValue(-100, 100);
-    y = 100 + GetRandomValue(-25, 25);
+    region = {(SCREEN_WIDTH / 2) - 100, 75, 200, 50};
     // type = EnemyType::SHOOTER;
   } else {
-    // type = static_cast<EnemyType>(GetRandomValue(0, 2));
+    // type = static_cast<EnemyType>(world_random(world, 0, 2));
+    region = spawn_region(world, type);
+  }
 
-    // Spawn shooters close to edges
-    if (type == EnemyType::SHOOTER || type == EnemyType::DASHER) {
-      auto left_align = GetRandomValue(0, 1);
-      x = left_align ? 50 : SCREEN_WIDTH - 50;
-      y = GetRandomValue(50, SCREEN_HEIGHT - 50);
-    } else {
-      x = GetRandomValue(50, SCREEN_WIDTH - 50);
-      y = GetRandomValue(50, SCREEN_HEIGHT - 50);
-    }
+  int pattern = (total_spawned / MAX_ENEMIES) % shooter_patterns.size();
+  return spawn_enemy(world, grid, type, region, pattern) >= 0;
+}
+
+Rectangle spawn_region(GameWorld &world, EnemyType type) {
+  // Spawn shooters close to edges
+  if (type == EnemyType::SHOOTER || type == EnemyType::DASHER) {
+    auto left_align = world_random(world, 0, 1);
+    return {left_align ? 50.0f : SCREEN_WIDTH - 50.0f, 50, 0, SCREEN_HEIGHT - 100};
   }
+  return DASHER_BOUNDS;
+}
 
-  Enemy enemy = {
+// At a clear point of region, pattern is the shooter pattern. Returns the slot, -1 if the type's
+// archetype is full.
+int spawn_enemy(GameWorld &world, bomaqs::SpawnGrid &grid, EnemyType type, Rectangle region,
+                int pattern) {
+  Vector2 position;
+  bomaqs::sample_spawn_point(grid, region, SPAWN_DISTANCE,
+                             [&](int min, int max) { return world_random(world, min, max); },
+                             &position);
+  bomaqs::add_spawn_occupant(grid, position, SPAWN_ENEMY_CLEARANCE);
+  float x = position.x, y = position.y;
+
+  unsigned int id = world.next_entity_id++;
+  EnemyCore core = {
       .position = {x, y},
-      .color = enemy_colors[GetRandomValue(0, 2)],
       .velocity = {0, 0},
-      .type = type,
+      .last_position = {x, y},
       .state = ActorState::LIVE,
-      .fire_rate = BULLET_FIRE_RATE_MIN,
-      .shots_fired = 0,
-      .shots_per_round = RIFLE_SHOTS_PER_ROUND,
-      .reload_timer = 0,
-      .trail_pos = {},
+      .timer = {0, 0},
+      .id = id,
+      .next_think = bomaqs::ai_first_think(world.frames_count, id),
   };
-  return enemy;
+  Color color = enemy_colors[world_random(world, 0, 2)];
+  auto emitter = bomaqs::create_emitter(pattern, BULLET_FIRE_RATE_MIN, BULLET_VELOCITY);
+  return add_enemy(world, type, core, color, emitter);
 }
 
-std::vector<Bullet> update_bullets(std::vector<Bullet> &bullets) {
-  std::vector<Bullet> updated;
-  for (auto bullet : bullets) {
-    if (CheckCollisionPointRec(bullet.position, BULLET_BOUNDS)) {
-      bullet.position.x += bullet.velocity.x;
-      bullet.position.y += bullet.velocity.y;
-      updated.push_back(bullet);
-    }
+// Into the archetype of its type, emitter is only kept for shooters. Returns the slot, -1 if that
+// archetype is full.
+int add_enemy(GameWorld &world, EnemyType type, const EnemyCore &core, Color color,
+               const bomaqs::PatternEmitter &emitter) {
+  switch (type) {
+    case EnemyType::SHOOTER:
+      return world.shooters.push_back(core, {color, {}, emitter.rate, emitter});
+    case EnemyType::DASHER:
+      return world.dashers.push_back(core, {color, {}});
+    default:
+      return world.homers.push_back(core, {color, {}});
   }
-
-  return updated;
 }
 
-bool check_bullet_collisions(Player player, std::vector<Bullet> &bullets) {
+void update_bullets(BulletList &bullets) {
+  // Integrate in parallel, every bullet only touches itself
+  char in_bounds[BULLET_CAPACITY];
+  bomaqs::JobCounter integrated = {};
+  bomaqs::parallel_for(
+      bomaqs::job_system, bullets.size(), BULLET_JOB_GRAIN,
+      [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+          Bullet &bullet = bullets[i];
+          in_bounds[i] = CheckCollisionPointRec(bullet.position, BULLET_BOUNDS);
+          if (in_bounds[i]) {
+            bullet.last_position = bullet.position;
+            bullet.position.x += bullet.velocity.x;
+            bullet.position.y += bullet.velocity.y;
+          }
+        }
+      },
+      &integrated);
+  bomaqs::wait_for_counter(bomaqs::job_system, &integrated);
+
+  // Compact in order so the simulation stays deterministic
+  int kept = 0;
   for (int i = 0; i < bullets.size(); i++) {
-    if (bullets[i].state == ActorState::DEAD) {
-      continue;
+    if (in_bounds[i]) {
+      bullets[kept++] = bullets[i];
     }
+  }
+  bullets.count = kept;
+}
 
-    if (CheckCollisionCircles(player.position, PLAYER_RADIUS, bullets[i].position, BULLET_RADIUS)) {
-      bullets[i].state = ActorState::DEAD;
-      return true;
-    }
+bool check_bullet_collisions(Player player, BulletList &bullets) {
+  // Sweep bullets in parallel, only the first hit in bullet order counts, same as a serial scan
+  int count = bullets.size();
+  std::atomic<int> first_hit(count);
+  bomaqs::JobCounter swept = {};
+  bomaqs::parallel_for(
+      bomaqs::job_system, count, BULLET_JOB_GRAIN,
+      [&](int begin, int end) {
+        for (int i = begin; i < end && i < first_hit; i++) {
+          if (bullets[i].state == ActorState::DEAD) {
+            continue;
+          }
+
+          // sweep the bullet's last move so fast bullets can't skip over the player
+          if (bomaqs::sweep_circles(bullets[i].last_position, bullets[i].position, BULLET_RADIUS,
+                                    player.position, player.position, PLAYER_RADIUS, nullptr)) {
+            int hit = first_hit;
+            while (i < hit && !first_hit.compare_exchange_weak(hit, i)) {
+            }
+            return;
+          }
+        }
+      },
+      &swept);
+  bomaqs::wait_for_counter(bomaqs::job_system, &swept);
+
+  if (first_hit < count) {
+    bullets[first_hit].state = ActorState::DEAD;
+    return true;
   }
 
   return false;
 }
 
-std::vector<int> check_enemy_collisions(Player player, std::vector<Enemy> enemies) {
-  std::vector<int> out;
-  for (int i = 0; i < enemies.size(); i++) {
-    Rectangle enemy_rect = {
-        .x = enemies[i].position.x - 10,
-        .y = enemies[i].position.y - 10,
-        .width = 20,
-        .height = 20,
-    };
-    if (CheckCollisionCircleRec(player.position, PLAYER_RADIUS, enemy_rect)) {
-      out.push_back(i);
+std::vector<EnemyRef> check_enemy_collisions(Player player, const GameWorld &world) {
+  std::vector<EnemyRef> out;
+  for_each_archetype(world, [&](EnemyType type, const auto &enemies) {
+    for (int i = 0; i < enemies.size(); i++) {
+      const EnemyCore &enemy = enemies.hot[i];
+      Rectangle enemy_rect = {
+          .x = enemy.last_position.x - 10,
+          .y = enemy.last_position.y - 10,
+          .width = 20,
+          .height = 20,
+      };
+      // In the enemy's frame the player moves against the enemy's last move, catches dashers
+      // passing through the player within a single frame
+      Vector2 player_end = {player.position.x - (enemy.position.x - enemy.last_position.x),
+                            player.position.y - (enemy.position.y - enemy.last_position.y)};
+      if (bomaqs::sweep_circle_rec(player.position, player_end, PLAYER_RADIUS, enemy_rect,
+                                   nullptr)) {
+        out.push_back({type, i});
+      }
     }
-  }
+  });
 
   return out;
 }
 
-bool check_homer_blast_collisions(Player player, std::vector<Enemy> enemies) {
-  for (int i = 0; i < enemies.size(); i++) {
+bool check_homer_blast_collisions(Player player, const GameWorld &world) {
+  for (int i = 0; i < world.homers.size(); i++) {
     // skip non blast mode enemies. blast mode enemies will have state DESTRUCT
-    if (enemies[i].state != ActorState::DESTRUCT || enemies[i].reload_timer > 0) {
+    const EnemyCore &homer = world.homers.hot[i];
+    if (homer.state != ActorState::DESTRUCT || bomaqs::timer_active(world.timers, homer.timer)) {
       continue;
     }
 
     // check if player hit box(circle) is colliding with blast/explosion circle
-    if (CheckCollisionCircles(player.position, PLAYER_RADIUS, enemies[i].position,
-                              HOMER_BLAST_RADIUS)) {
+    if (within_distance(player.position, homer.position, PLAYER_RADIUS + HOMER_BLAST_RADIUS)) {
       return true;
     }
   }
@@ -416,28 +1141,52 @@ bool check_homer_blast_collisions(Player player, std::vector<Enemy> enemies) {
   return false;
 }
 
-std::vector<int> check_enemy_enemy_collisions(std::vector<Enemy> enemies) {
-  std::vector<int> out;
-  int enemies_count = enemies.size();
+// Sweep and prune: the boxes each enemy covered over its last move are sorted by left edge, only
+// pairs whose boxes overlap get the exact sweep. O(n log n) rather than every pair, the enemy
+// count can go into the thousands.
+std::vector<EnemyRef> check_enemy_enemy_collisions(const GameWorld &world) {
+  typedef struct {
+    float left, right, top, bottom;
+    Rectangle rect;  // at the last position
+    Vector2 move;
+    EnemyRef enemy;
+  } SweptEnemy;
+
+  std::vector<SweptEnemy> swept;
+  swept.reserve(enemy_count(world));
+  for_each_archetype(world, [&](EnemyType type, const auto &enemies) {
+    for (int i = 0; i < enemies.size(); i++) {
+      const EnemyCore &enemy = enemies.hot[i];
+      Rectangle rect = {enemy.last_position.x - 10, enemy.last_position.y - 10, 20, 20};
+      Vector2 move = {enemy.position.x - enemy.last_position.x,
+                      enemy.position.y - enemy.last_position.y};
+      swept.push_back({std::min(rect.x, rect.x + move.x), std::max(rect.x, rect.x + move.x) + 20,
+                       std::min(rect.y, rect.y + move.y), std::max(rect.y, rect.y + move.y) + 20,
+                       rect, move, {type, i}});
+    }
+  });
 
-  for (int i = 0; i < enemies_count; i++) {
-    Rectangle enemy_rect_1 = {
-        .x = enemies[i].position.x - 10,
-        .y = enemies[i].position.y - 10,
-        .width = 20,
-        .height = 20,
-    };
-    for (int j = i + 1; j < enemies_count; j++) {
-      Rectangle enemy_rect_2 = {
-          .x = enemies[j].position.x - 10,
-          .y = enemies[j].position.y - 10,
-          .width = 20,
-          .height = 20,
-      };
+  // Ties broken by type and slot, so the pairs come out in the same order on every run
+  std::sort(swept.begin(), swept.end(), [](const SweptEnemy &a, const SweptEnemy &b) {
+    if (a.left != b.left) {
+      return a.left < b.left;
+    }
+    return a.enemy.type != b.enemy.type ? a.enemy.type < b.enemy.type : a.enemy.slot < b.enemy.slot;
+  });
+
+  std::vector<EnemyRef> out;
+  int count = swept.size();
+  for (int i = 0; i < count; i++) {
+    for (int j = i + 1; j < count && swept[j].left <= swept[i].right; j++) {
+      if (swept[j].top > swept[i].bottom || swept[j].bottom < swept[i].top) {
+        continue;
+      }
+      Vector2 relative_move = {swept[i].move.x - swept[j].move.x,
+                               swept[i].move.y - swept[j].move.y};
       // if enemy i and j collides, they both die, bonus score!!
-      if (CheckCollisionRecs(enemy_rect_1, enemy_rect_2)) {
-        out.push_back(i);
-        out.push_back(j);
+      if (bomaqs::sweep_recs(swept[i].rect, relative_move, swept[j].rect, nullptr)) {
+        out.push_back(swept[i].enemy);
+        out.push_back(swept[j].enemy);
       }
     }
   }
@@ -445,48 +1194,39 @@ std::vector<int> check_enemy_enemy_collisions(std::vector<Enemy> enemies) {
   return out;
 }
 
-void draw_bullets(std::vector<Bullet> bullets) {
+void draw_bullets(const BulletList &bullets) {
   for (int i = 0; i < bullets.size(); i++) {
     DrawCircle(bullets[i].position.x, bullets[i].position.y, BULLET_RADIUS, YELLOW);
   }
 }
 
-void draw_enemies(std::vector<Enemy> enemies) {
-  for (int i = 0; i < enemies.size(); i++) {
-    auto enemy = enemies[i];
-    Color color = enemy.color;
-    if (enemy.state == ActorState::RELOADING) {
-      color = GetRandomValue(0, 1) ? RED : color;
-    }
-
-    switch (enemy.type) {
-      case EnemyType::HOMING:
-        DrawRectangleLines(enemy.position.x - 10, enemy.position.y - 10, 20, 20, color);
-        if (enemy.reload_timer > 0) {
-          // draw a blast radius indicator as a circle based on current progress towars blast from
-          // reload timer calculated as a percentage function
-          auto blast_radi = (1 - (enemy.reload_timer / ENEMY_RELOAD_TIMER)) * HOMER_BLAST_RADIUS;
-          DrawCircleLines(enemy.position.x, enemy.position.y, blast_radi, ORANGE);
-        }
-        break;
-      case EnemyType::DASHER: {
-        DrawRectangleLines(enemy.position.x - 10, enemy.position.y - 10, 20, 20, color);
-        break;
+void draw_enemies(const GameWorld &world) {
+  for_each_archetype(world, [&](EnemyType type, const auto &enemies) {
+    for (int i = 0; i < enemies.size(); i++) {
+      const EnemyCore &enemy = enemies.hot[i];
+      const EnemyTrail &trail = enemies.cold[i].trail;
+      Color color = enemies.cold[i].color;
+      if (enemy.state == ActorState::RELOADING) {
+        color = GetRandomValue(0, 1) ? RED : color;
       }
-      default:
-        DrawRectangleLines(enemy.position.x - 10, enemy.position.y - 10, 20, 20, color);
-        break;
-    }
-
-    if (enemy.state == ActorState::LIVE && enemy.velocity.x != 0 && enemy.velocity.y != 0) {
-      // Draw movement trail
-      for (int i = MAX_ENEMY_TRAIL - 1; i >= 0; i -= 1) {
-        auto trail_pos = enemy.trail_pos[i];
-        color.a /= 2;
-        auto width = 20 - MAX_ENEMY_TRAIL + i;
-        DrawRectangleLines(trail_pos.x - (width / 2), trail_pos.y - (width / 2), width, width,
-                           color);
+
+      DrawRectangleLines(enemy.position.x - 10, enemy.position.y - 10, 20, 20, color);
+      if (type == EnemyType::HOMING && bomaqs::timer_active(world.timers, enemy.timer)) {
+        // draw a blast radius indicator as a circle based on current progress towars blast
+        auto blast_radi = bomaqs::timer_progress(world.timers, enemy.timer) * HOMER_BLAST_RADIUS;
+        DrawCircleLines(enemy.position.x, enemy.position.y, blast_radi, ORANGE);
+      }
+
+      if (enemy.state == ActorState::LIVE && enemy.velocity.x != 0 && enemy.velocity.y != 0) {
+        // Draw movement trail, newest first
+        for (int n = trail.count - 1; n >= 0; n -= 1) {
+          auto trail_pos = trail.positions[(trail.start + n) % MAX_ENEMY_TRAIL];
+          color.a /= 2;
+          auto width = 20 - trail.count + n;
+          DrawRectangleLines(trail_pos.x - (width / 2), trail_pos.y - (width / 2), width, width,
+                             color);
+        }
       }
     }
-  }
+  });
 }
@@ -1,13 +1,26 @@
+#pragma once
+
 #include <raylib.h>
 
+#include <cstdint>
+#include <type_traits>
 #include <vector>
 
+#include "utils/ai-scheduler.hpp"
+#include "utils/archetype.hpp"
+#include "utils/bullet-pattern.hpp"
+#include "utils/fixed-vector.hpp"
+#include "utils/spawn-grid.hpp"
+#include "utils/timer-wheel.hpp"
+
 #define SCREEN_WIDTH 540
 #define SCREEN_HEIGHT 960
 #define FRAME_RATE 60
+#define STARTUP_BUDGET_MS 1000  // launch to the first interactive frame
 
 #define PLAYER_RADIUS 20
 #define INITIAL_PLAYER_SHIELDS 3
+#define MAX_TICK_TAPS 8  // taps a tick applies, later ones wait in the input queue for the next
 
 #define ENEMY_KILL_BONUS 50
 #define ENEMY_SELF_KILL_BONUS 100
@@ -15,22 +28,46 @@
 #define BULLET_RADIUS 3
 #define BULLET_FIRE_RATE_MIN 20
 #define BULLET_FIRE_RATE_MAX 10
-#define MAX_BULLETS 100
-#define RIFLE_SHOTS_PER_ROUND 25
+#define MAX_BULLETS 100  // live at once in a game, stress scenarios raise it
 #define BAZOOKA_SHOTS_PER_ROUND 1
 #define BULLET_VELOCITY 5
 #define FIRE_RATE_RAMPUP_INTERVAL 300
+#define BULLET_JOB_GRAIN 32  // bullets per job for integration and collision sweeps
+#define PATTERN_RELOAD_CHECK_FRAMES FRAME_RATE  // how often pattern files are checked for changes
 
-#define MAX_ENEMIES 4
+#define MAX_ENEMIES 4  // live at once in a game, the spawn pace
 #define MAX_ENEMY_TRAIL 10
+#define MAX_WORLD_TIMERS (ENEMY_ARCHETYPE_CAPACITY * 3)  // an enemy runs one at a time
+#define AI_THINK_BUDGET 256  // thinks per tick for each enemy type, the rest wait for the next one
 
 #define DASHER_VELOCITY 8
 #define HOMING_VELOCITY 2
-#define ENEMY_RELOAD_TIMER 1.5f
+#define ENEMY_RELOAD_TICKS (FRAME_RATE * 3 / 2)  // reloads and homer fuses
 
 #define HOMER_BLAST_RADIUS 60
 #define HOMER_BLAST_TRIGGER_DISTANCE 50
 
+// Storage. Every snapshot, rollback and saved session copies the whole world, so games keep just
+// what play needs and stress scenario builds get pools the size of their scenarios. Thousands of
+// enemies are only possible in BOMAQS_STRESS_CAPACITY builds, others hold MAX_ENEMIES of each type.
+#if defined(BOMAQS_STRESS_CAPACITY)
+#define BULLET_CAPACITY 10240          // the most any bullet limit can be
+#define ENEMY_ARCHETYPE_CAPACITY 1024  // per enemy type
+#else
+#define BULLET_CAPACITY MAX_BULLETS
+#define ENEMY_ARCHETYPE_CAPACITY MAX_ENEMIES
+#endif
+
+#define SPAWN_CELL_SIZE 40
+#define SPAWN_PLAYER_CLEARANCE 150  // px kept free around players
+#define SPAWN_ENEMY_CLEARANCE 15    // enemy footprint, on top of SPAWN_DISTANCE
+#define SPAWN_DISTANCE 45           // px from every clearance circle
+
+#define SESSION_SCHEMA_VERSION 6  // bump when anything in GameWorld changes layout
+
+#define HASH_RUN_SEED 1
+#define HASH_RUN_TAP_TICKS 45
+
 #define DASHER_BOUNDS \
   CLITERAL(Rectangle) { 50, 50, SCREEN_WIDTH - 100, SCREEN_HEIGHT - 100 }
 #define BULLET_BOUNDS \
@@ -43,6 +80,13 @@ enum EnemyType {
   HOMING,
 };
 
+// Tags of enemy timers, their data is the enemy's slot
+enum EnemyTimer {
+  TIMER_SHOOTER_RELOAD,
+  TIMER_DASHER_RELOAD,
+  TIMER_HOMER_FUSE,
+};
+
 enum ActorState {
   LIVE,
   DEAD,
@@ -61,20 +105,51 @@ typedef struct {
   Color color;
   Vector2 velocity;
   ActorState state;
+  Vector2 last_position;  // position before the last move, for swept collisions
+  unsigned int id;        // stable across ticks, matches entities between network snapshots
 } Bullet;
 
+// Enemies are stored per type, each type updated by its own systems. EnemyCore is what those
+// systems touch every tick, the rest is only read when drawing or by a single system.
 typedef struct {
   Vector2 position;
-  Color color;
   Vector2 velocity;
-  EnemyType type;
+  Vector2 last_position;  // position before the last move, for swept collisions
   ActorState state;
+  bomaqs::TimerHandle timer;  // reload, or a homer's fuse
+  unsigned int id;
+  uint32_t next_think;  // frame of the next AI think, see ai-scheduler.hpp
+} EnemyCore;
+
+// Last positions of a moving enemy, a ring so a move appends without shifting
+typedef struct {
+  Vector2 positions[MAX_ENEMY_TRAIL];
+  uint8_t start;  // oldest
+  uint8_t count;
+} EnemyTrail;
+
+typedef struct {
+  Color color;
+  EnemyTrail trail;
+} EnemyExtra;
+
+typedef struct {
+  Color color;
+  EnemyTrail trail;
   int fire_rate;
-  int shots_fired;
-  int shots_per_round;
-  float reload_timer;
-  std::vector<Vector2> trail_pos;
-} Enemy;
+  bomaqs::PatternEmitter emitter;
+} ShooterExtra;
+
+typedef bomaqs::Archetype<EnemyCore, ShooterExtra, ENEMY_ARCHETYPE_CAPACITY> ShooterArchetype;
+typedef bomaqs::Archetype<EnemyCore, EnemyExtra, ENEMY_ARCHETYPE_CAPACITY> EnemyArchetype;
+
+// An enemy this tick, slots change when enemies are removed
+typedef struct {
+  EnemyType type;
+  int slot;
+} EnemyRef;
+
+typedef bomaqs::FixedVector<Bullet, BULLET_CAPACITY> BulletList;
 
 typedef struct {
   Vector2 position;
@@ -83,25 +158,122 @@ typedef struct {
   int shield;
 } Player;
 
+// Everything a tick reads from the outside world, so ticks replay the same on any thread
+typedef struct {
+  int taps;  // since the last tick, in the order they happened
+  Vector2 tap_positions[MAX_TICK_TAPS];
+  bool in_background;
+  float frame_time;
+  const bomaqs::PatternLibrary *patterns;  // shooter patterns, replaced when files are reloaded
+
+  // Second player, only in networked games
+  bool partner_present;
+  bool partner_tap;
+  Vector2 partner_touch_position;
+} TickInput;
+
 typedef struct {
   Player player;
-  std::vector<Enemy> enemies;
-  std::vector<Bullet> bullets;
+  Player partner;  // DEAD unless a second player is connected and has shields left
+  ShooterArchetype shooters;
+  EnemyArchetype dashers;
+  EnemyArchetype homers;
+  BulletList bullets;
+  int bullet_limit;  // live bullets, MAX_BULLETS unless a scenario changed it
   WorldState state;
+  unsigned long long frames_count;
+  float score;
+  int total_enemies_spawned;
+  unsigned int rng;  // xorshift state, the simulation never touches raylib's RNG
+  unsigned int next_entity_id;
+  bomaqs::AiSchedule dasher_ai;
+  bomaqs::AiSchedule homer_ai;
+  bomaqs::TimerWheel<MAX_WORLD_TIMERS> timers;  // ticks are frames_count
+
+  // Running event counts, the renderer plays effects when they go up between snapshots
+  unsigned int teleports;
+  unsigned int explosions;
 } GameWorld;
 
+// Flat, so snapshots, rollbacks and the simulation pipeline copy it without touching the heap.
+// Too big for the stack with every archetype at capacity, keep worlds static or on the heap.
+static_assert(std::is_trivially_copyable<GameWorld>::value, "GameWorld must stay flat");
+
+// visit(type, archetype) for each enemy type, in a fixed order
+template <typename World, typename Visit>
+inline void for_each_archetype(World &world, Visit visit) {
+  visit(EnemyType::SHOOTER, world.shooters);
+  visit(EnemyType::DASHER, world.dashers);
+  visit(EnemyType::HOMING, world.homers);
+}
+
+inline EnemyCore &enemy_core(GameWorld &world, EnemyRef enemy) {
+  switch (enemy.type) {
+    case EnemyType::SHOOTER:
+      return world.shooters.hot[enemy.slot];
+    case EnemyType::DASHER:
+      return world.dashers.hot[enemy.slot];
+    default:
+      return world.homers.hot[enemy.slot];
+  }
+}
+
+inline EnemyTimer enemy_timer_tag(EnemyType type) {
+  switch (type) {
+    case EnemyType::SHOOTER:
+      return TIMER_SHOOTER_RELOAD;
+    case EnemyType::DASHER:
+      return TIMER_DASHER_RELOAD;
+    default:
+      return TIMER_HOMER_FUSE;
+  }
+}
+
+inline int enemy_count(const GameWorld &world) {
+  return world.shooters.size() + world.dashers.size() + world.homers.size();
+}
+
 Vector2 get_homing_velocity(Vector2 pos1, Vector2 pos2, int velocity);
+bool within_distance(Vector2 pos1, Vector2 pos2, float distance);
+
+bool save_session(const GameWorld &world);
+bool load_session(GameWorld &world);
+
+uint64_t hash_game_world(const GameWorld &world);
+int run_hash_ticks(int ticks);
+int run_scenario(const char *path, bool rendered);
 
-GameWorld create_game_world();
+void reset_game_world(GameWorld &world, unsigned int seed);
+int world_random(GameWorld &world, int min, int max);
+void update_game_world(GameWorld &world, const TickInput &input);
+void step_timed_game_world(GameWorld &world, const TickInput &input);
+void draw_game_world(const GameWorld &world);
 
-std::vector<Bullet> update_bullets(std::vector<Bullet> &bullets);
-Bullet create_bullet(Enemy enemy, Player player);
-void draw_bullets(std::vector<Bullet> bullets);
+void update_bullets(BulletList &bullets);
+void fire_shooter_patterns(GameWorld &world, const bomaqs::PatternLibrary &patterns);
+void draw_bullets(const BulletList &bullets);
 
-Enemy create_enemy(int current_count);
-void draw_enemies(std::vector<Enemy> enemies);
+void build_spawn_grid(const GameWorld &world, bomaqs::SpawnGrid &grid);
+bool create_enemy(GameWorld &world, bomaqs::SpawnGrid &grid);
+Rectangle spawn_region(GameWorld &world, EnemyType type);
+int spawn_enemy(GameWorld &world, bomaqs::SpawnGrid &grid, EnemyType type, Rectangle region,
+                int pattern);
+int add_enemy(GameWorld &world, EnemyType type, const EnemyCore &core, Color color,
+               const bomaqs::PatternEmitter &emitter);
+void start_enemy_timer(GameWorld &world, EnemyTimer tag, int slot);
+void fire_enemy_timer(GameWorld &world, uint32_t tag, uint32_t slot);
+void remove_dead_enemies(GameWorld &world);
+void ramp_up_shooters(ShooterArchetype &shooters);
+int enemy_think_cadence(const GameWorld &world, Vector2 position);
+int think_dasher(const GameWorld &world, EnemyCore &dasher);
+int think_homer(GameWorld &world, int slot);
+void stop_dashers_at_bounds(GameWorld &world);
+void move_enemies(EnemyArchetype &enemies);
+void push_trail(EnemyTrail &trail, Vector2 position);
+void draw_enemies(const GameWorld &world);
 
-bool check_bullet_collisions(Player player, std::vector<Bullet> &bullets);
-std::vector<int> check_enemy_collisions(Player player, std::vector<Enemy> enemies);
-std::vector<int> check_enemy_enemy_collisions(std::vector<Enemy> enemies);
-bool check_homer_blast_collisions(Player player, std::vector<Enemy> enemies);
+int check_player_hits(GameWorld &world, Player &player);
+bool check_bullet_collisions(Player player, BulletList &bullets);
+std::vector<EnemyRef> check_enemy_collisions(Player player, const GameWorld &world);
+std::vector<EnemyRef> check_enemy_enemy_collisions(const GameWorld &world);
+bool check_homer_blast_collisions(Player player, const GameWorld &world);
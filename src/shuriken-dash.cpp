@@ -0,0 +1,529 @@
+#include <raylib.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "utils/collision.hpp"
+#include "utils/fixed.hpp"
+#include "utils/input-queue.hpp"
+#include "utils/scenario.hpp"
+#include "utils/session.hpp"
+#include "utils/startup-trace.hpp"
+#include "utils/state-hash.hpp"
+
+#define SCREEN_WIDTH 450
+#define SCREEN_HEIGHT 800
+#define WINDOW_TITLE "Shuriken Dash"
+#define FRAME_RATE 60
+#define STARTUP_BUDGET_MS 500  // launch to the first frame
+
+#define PLATFORM_HEIGHT 250
+#define PLAYER_HEIGHT 50
+#define MAX_PLATFORMS 20  // size of the platform ring streamed around the camera
+#define PLATFORM_WIDTH_MIN 100
+#define PLATFORM_WIDTH_MAX 150
+#define PLATFORM_GAP_MIN 50
+#define PLATFORM_GAP_MAX 70
+#define GRAVITY 98
+
+#define SHURIKEN_SPEED 400
+
+// How far past the camera view platforms are generated ahead
+#define STREAM_AHEAD SCREEN_WIDTH
+
+#define SESSION_SCHEMA_VERSION 1  // bump when anything in GameWorld changes layout
+
+#define HASH_RUN_SEED 1
+#define HASH_RUN_HOLD_TICKS 30  // scripted throws hold this long, then wait as long again
+
+typedef Rectangle Platform;
+
+typedef enum PlayerState {
+  PLAYER_STATE_DEAD,
+  PLAYER_STATE_DASHING,
+  PLAYER_STATE_IDLE,
+} PlayerState;
+
+typedef struct {
+  Vector2 position;
+  PlayerState state;
+} Player;
+
+typedef struct GameWorld {
+  Player player;
+  Vector2 shuriken;
+  int throwDistance;
+  // Ring of platforms sorted by x, firstPlatform is the ring index of the left-most one
+  Platform platforms[MAX_PLATFORMS];
+  int firstPlatform;
+  unsigned int rng;  // xorshift state, platforms don't come from raylib's (libc's) RNG
+} GameWorld;
+
+// Everything a tick reads from outside, so a scripted run plays like a real one
+typedef struct {
+  int gesture;
+  int lastGesture;
+  float delta;
+} TickInput;
+
+// xorshift32, the same sequence on every platform
+int WorldRandom(GameWorld *world, int min, int max) {
+  world->rng ^= world->rng << 13;
+  world->rng ^= world->rng >> 17;
+  world->rng ^= world->rng << 5;
+  return min + (int)(world->rng % (unsigned int)(max - min + 1));
+}
+
+// Distance covered at speed px/s over delta. Fixed point in BOMAQS_FIXED_SIM builds
+float TickDistance(int speed, float delta) {
+#ifdef BOMAQS_FIXED_SIM
+  bomaqs::fixed distance = bomaqs::fixed_mul(bomaqs::int_to_fixed(speed), bomaqs::to_fixed(delta));
+  return bomaqs::fixed_to_float(distance);
+#else
+  return speed * delta;
+#endif
+}
+
+// Platform i in left to right order
+Platform *PlatformAt(GameWorld *world, int i) {
+  return &world->platforms[(world->firstPlatform + i) % MAX_PLATFORMS];
+}
+
+Platform NextPlatform(GameWorld *world, Platform prev) {
+  int width = WorldRandom(world, PLATFORM_WIDTH_MIN, PLATFORM_WIDTH_MAX);
+  int gap = WorldRandom(world, PLATFORM_GAP_MIN, PLATFORM_GAP_MAX);
+
+  return (Platform){
+      .x = prev.x + prev.width + gap,
+      .y = SCREEN_HEIGHT - PLATFORM_HEIGHT,
+      .width = (float)width,
+      .height = PLATFORM_HEIGHT,
+  };
+}
+
+// Index of the first platform whose right edge reaches x, MAX_PLATFORMS if none
+int FindPlatform(GameWorld *world, float x) {
+  int low = 0, high = MAX_PLATFORMS;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    Platform *platform = PlatformAt(world, mid);
+    if (platform->x + platform->width < x) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+Rectangle GetCameraView(Camera2D camera) {
+  return (Rectangle){
+      .x = camera.target.x - (camera.offset.x / camera.zoom),
+      .y = camera.target.y - (camera.offset.y / camera.zoom),
+      .width = SCREEN_WIDTH / camera.zoom,
+      .height = SCREEN_HEIGHT / camera.zoom,
+  };
+}
+
+// Recycle platforms from behind the camera to the front of the ring until the view plus
+// STREAM_AHEAD is covered. Runs at most MAX_PLATFORMS times no matter how far the player went.
+void StreamPlatforms(GameWorld *world, Rectangle view) {
+  for (int i = 0; i < MAX_PLATFORMS; i++) {
+    Platform last = *PlatformAt(world, MAX_PLATFORMS - 1);
+    if (last.x + last.width >= view.x + view.width + STREAM_AHEAD) {
+      break;
+    }
+
+    world->platforms[world->firstPlatform] = NextPlatform(world, last);
+    world->firstPlatform = (world->firstPlatform + 1) % MAX_PLATFORMS;
+  }
+}
+
+bool CheckCollisionPlatforms(GameWorld *world, Rectangle rect) {
+  for (int i = FindPlatform(world, rect.x); i < MAX_PLATFORMS; i++) {
+    Platform *platform = PlatformAt(world, i);
+    if (platform->x > rect.x + rect.width) {
+      break;
+    }
+    if (CheckCollisionRecs(rect, *platform)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Moves rect by delta and returns how far it got, as a fraction, before hitting a platform
+float SweepPlatforms(GameWorld *world, Rectangle rect, Vector2 delta) {
+  float left = fminf(rect.x, rect.x + delta.x);
+  float right = fmaxf(rect.x, rect.x + delta.x) + rect.width;
+  float toi = 1.0f;
+
+  for (int i = FindPlatform(world, left); i < MAX_PLATFORMS; i++) {
+    Platform *platform = PlatformAt(world, i);
+    if (platform->x > right) {
+      break;
+    }
+
+    float hit;
+    if (bomaqs::sweep_recs(rect, delta, *platform, &hit)) {
+      toi = fminf(toi, hit);
+    }
+  }
+  return toi;
+}
+
+GameWorld CreateWorld(unsigned int seed) {
+  GameWorld world;
+  world.rng = seed ? seed : 1;
+  world.throwDistance = 0;
+
+  // generate platforms
+  world.firstPlatform = 0;
+  world.platforms[0] = (Platform){
+      .x = 0,
+      .y = SCREEN_HEIGHT - PLATFORM_HEIGHT,
+      .width = (float)WorldRandom(&world, PLATFORM_WIDTH_MIN, PLATFORM_WIDTH_MAX),
+      .height = PLATFORM_HEIGHT,
+  };
+  for (int i = 1; i < MAX_PLATFORMS; i++) {
+    world.platforms[i] = NextPlatform(&world, world.platforms[i - 1]);
+  }
+
+  Platform firstPlatform = world.platforms[0];
+  int playerX = firstPlatform.x + (firstPlatform.width / 2) - (PLAYER_HEIGHT / 2);
+  int playerY = SCREEN_HEIGHT - firstPlatform.height - (PLAYER_HEIGHT * 1.5);
+
+  world.player = (Player){{(float)playerX, (float)playerY}, PLAYER_STATE_IDLE};
+  world.shuriken = world.player.position;
+
+  return world;
+}
+
+// Camera following the shuriken, platforms stream in around its view
+Camera2D FollowCamera(const GameWorld *world) {
+  Camera2D camera = {0};
+  camera.target = (Vector2){world->shuriken.x + 20.0f, world->shuriken.y + 20.0f};
+  camera.offset = (Vector2){SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f};
+  camera.rotation = 0.0f;
+  camera.zoom = 1.0f;
+  return camera;
+}
+
+void UpdateWorld(GameWorld *world, TickInput input) {
+  StreamPlatforms(world, GetCameraView(FollowCamera(world)));
+
+  // set shuriken throw distance on tap and hold
+  if (world->player.state == PLAYER_STATE_IDLE && input.gesture == GESTURE_HOLD) {
+    world->throwDistance += TickDistance(SHURIKEN_SPEED, input.delta);
+  }
+
+  // on release tap and hold
+  if (input.lastGesture == GESTURE_HOLD && input.gesture != input.lastGesture) {
+    if (world->throwDistance < 25) {
+      world->throwDistance = 0;
+    } else {
+      world->player.state = PLAYER_STATE_DASHING;
+    }
+  }
+
+  // Move shuriken forward, never past the throw distance even on a long frame
+  if (world->player.state == PLAYER_STATE_DASHING && world->throwDistance > 0) {
+    float displacement = fminf(TickDistance(SHURIKEN_SPEED, input.delta), world->throwDistance);
+    world->shuriken.x += displacement;
+    world->throwDistance -= displacement;
+  }
+
+  // Teleport player after shuriken reaches throw distance
+  if (world->player.state == PLAYER_STATE_DASHING && world->throwDistance <= 0) {
+    world->player.state = PLAYER_STATE_IDLE;
+    world->player.position = world->shuriken;
+    world->throwDistance = 0;
+  }
+
+  // Player gravity and collision
+  Rectangle playerRect = {.x = world->player.position.x - (PLAYER_HEIGHT / 4),
+                          .y = world->player.position.y - (PLAYER_HEIGHT / 2),
+                          .width = PLAYER_HEIGHT / 4,
+                          .height = PLAYER_HEIGHT};
+  int playerOnPlatform = CheckCollisionPlatforms(world, playerRect);
+
+  // Sweep the fall so a frame hitch lands the player on top of a platform instead of through it
+  if (!playerOnPlatform && world->player.state == PLAYER_STATE_IDLE) {
+    float fall = TickDistance(GRAVITY, input.delta);
+    float toi = SweepPlatforms(world, playerRect, (Vector2){0, fall});
+#ifdef BOMAQS_FIXED_SIM
+    world->player.position.y +=
+        bomaqs::fixed_to_float(bomaqs::fixed_mul(bomaqs::to_fixed(fall), bomaqs::to_fixed(toi)));
+#else
+    world->player.position.y += fall * toi;
+#endif
+  }
+
+  if (world->player.position.y > (SCREEN_HEIGHT - 75)) {
+    world->player.state = PLAYER_STATE_DEAD;
+  }
+}
+
+// Call between BeginDrawing and EndDrawing, the camera follows the shuriken
+void DrawWorld(GameWorld *world) {
+  Camera2D camera = FollowCamera(world);
+  Rectangle cameraView = GetCameraView(camera);
+  BeginMode2D(camera);
+
+  // Draw platforms inside the camera view
+  for (int i = FindPlatform(world, cameraView.x); i < MAX_PLATFORMS; i++) {
+    Platform *platform = PlatformAt(world, i);
+    if (platform->x > cameraView.x + cameraView.width) {
+      break;
+    }
+    DrawRectangleRec(*platform, MAROON);
+  }
+
+  // Draw shuriken
+  if (world->player.state == PLAYER_STATE_DASHING) {
+    DrawCircle(world->shuriken.x, world->shuriken.y, 10, BLACK);
+  }
+
+  // Draw Player
+  Vector2 playerPos = world->player.position;
+  DrawRectangle(playerPos.x, playerPos.y, PLAYER_HEIGHT / 2, PLAYER_HEIGHT, DARKBLUE);
+
+  EndMode2D();
+
+  if (world->player.state == PLAYER_STATE_DEAD) {
+    DrawText("You Died", SCREEN_WIDTH / 2 - 75, SCREEN_HEIGHT / 2 - 25, 25, ORANGE);
+  }
+}
+
+// The world is flat, it's saved as a single record and read back straight from the file
+bool SaveSession(GameWorld *world) {
+  bomaqs::SessionWriter writer;
+  bomaqs::begin_session(writer, SESSION_SCHEMA_VERSION);
+  bomaqs::add_session_records(writer, "WRLD", world, 1);
+  return bomaqs::write_session(writer, bomaqs::session_path("shuriken-dash").data());
+}
+
+bool LoadSession(GameWorld *world) {
+  bomaqs::SessionFile session;
+  if (!bomaqs::open_session(session, bomaqs::session_path("shuriken-dash").data(),
+                            SESSION_SCHEMA_VERSION)) {
+    return false;
+  }
+
+  int count = 0;
+  const GameWorld *saved = bomaqs::session_records<GameWorld>(session, "WRLD", &count);
+  if (count == 1) {
+    *world = *saved;
+  }
+  bomaqs::close_session(session);
+  return count == 1;
+}
+
+uint64_t HashWorld(GameWorld *world) {
+  bomaqs::StateHash hash = bomaqs::start_state_hash();
+  bomaqs::hash_value(hash, world->player.position);
+  bomaqs::hash_value(hash, world->player.state);
+  bomaqs::hash_value(hash, world->shuriken);
+  bomaqs::hash_value(hash, world->throwDistance);
+  for (int i = 0; i < MAX_PLATFORMS; i++) {
+    bomaqs::hash_value(hash, *PlatformAt(world, i));
+  }
+  bomaqs::hash_value(hash, world->rng);
+  return hash.value;
+}
+
+// Headless run with a fixed seed and scripted throws, prints the world hash after every tick.
+// Builds that simulate the same print the same lines, see check-determinism.sh
+int RunHashTicks(int ticks) {
+  GameWorld world = CreateWorld(HASH_RUN_SEED);
+  int lastGesture = GESTURE_NONE;
+
+  for (int tick = 1; tick <= ticks; tick++) {
+    int gesture = (tick / HASH_RUN_HOLD_TICKS) % 2 ? GESTURE_HOLD : GESTURE_NONE;
+    UpdateWorld(&world, (TickInput){gesture, lastGesture, 1.0f / FRAME_RATE});
+    lastGesture = gesture;
+
+    // Start over once the player falls, the run keeps exercising throws
+    if (world.player.state == PLAYER_STATE_DEAD) {
+      world = CreateWorld(world.rng);
+    }
+    bomaqs::print_state_hash(tick, {HashWorld(&world)});
+  }
+  return 0;
+}
+
+// Stress scenario, see src/utils/scenario.hpp. Shuriken Dash's directives:
+//   throw <hold ticks> <wait ticks>   scripted throws, like --hash-ticks
+//   throw auto                        every throw aimed at the middle of the next platform
+// Platforms stream through a ring of MAX_PLATFORMS, a long run of auto throws passes thousands of
+// them. The world starts over when the player falls.
+int RunScenario(const char *path, bool rendered) {
+  bomaqs::Scenario scenario;
+  if (!bomaqs::load_scenario(path, "shuriken-dash", scenario)) {
+    return 1;
+  }
+
+  int holdTicks = HASH_RUN_HOLD_TICKS, waitTicks = HASH_RUN_HOLD_TICKS;
+  bool autoThrow = false;
+  bool valid = true;
+  std::vector<float> numbers;
+  for (auto &line : scenario.lines) {
+    if (line.directive != "throw") {
+      bomaqs::scenario_warning(scenario, line, "isn't a Shuriken Dash directive");
+      valid = false;
+    } else if (line.words.size() == 1 && line.words[0] == "auto") {
+      autoThrow = true;
+    } else if (bomaqs::scenario_numbers(scenario, line, 2, 2, numbers)) {
+      holdTicks = numbers[0];
+      waitTicks = numbers[1];
+      autoThrow = false;
+    } else {
+      valid = false;
+    }
+  }
+  if (!valid) {
+    return 1;
+  }
+
+  if (rendered) {
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, WINDOW_TITLE);
+  }
+  GameWorld world = CreateWorld(scenario.seed);
+  int lastGesture = GESTURE_NONE;
+  int streamed = 0, falls = 0;
+
+  bomaqs::ScenarioStats stats;
+  bomaqs::start_scenario_stats(stats, scenario);
+  for (int tick = 1; tick <= scenario.ticks && !(rendered && WindowShouldClose()); tick++) {
+    int gesture = GESTURE_NONE;
+    if (autoThrow && world.player.state == PLAYER_STATE_IDLE) {
+      // Hold until the throw reaches the middle of the platform after the one below the player
+      int next = std::min(FindPlatform(&world, world.player.position.x) + 1, MAX_PLATFORMS - 1);
+      Platform *platform = PlatformAt(&world, next);
+      gesture = world.throwDistance < platform->x + (platform->width / 2) - world.shuriken.x
+                    ? GESTURE_HOLD
+                    : GESTURE_NONE;
+    } else if (!autoThrow) {
+      gesture = tick % (holdTicks + waitTicks) >= waitTicks ? GESTURE_HOLD : GESTURE_NONE;
+    }
+
+    int firstPlatform = world.firstPlatform;
+    UpdateWorld(&world, (TickInput){gesture, lastGesture, 1.0f / FRAME_RATE});
+    lastGesture = gesture;
+    streamed += (world.firstPlatform - firstPlatform + MAX_PLATFORMS) % MAX_PLATFORMS;
+    if (world.player.state == PLAYER_STATE_DEAD) {
+      world = CreateWorld(world.rng);
+      lastGesture = GESTURE_NONE;
+      falls += 1;
+    }
+
+    if (rendered) {
+      BeginDrawing();
+      ClearBackground(WHITE);
+      DrawWorld(&world);
+      DrawFPS(10, 10);
+      EndDrawing();
+    }
+    bomaqs::record_scenario_tick(stats);
+  }
+
+  if (rendered) {
+    CloseWindow();
+  }
+  return bomaqs::report_scenario(scenario, stats, rendered,
+                                 TextFormat("%d platforms streamed, %d falls", streamed, falls));
+}
+
+// The windowless part of a cold start: session storage and the saved world. Exits with 1 when that
+// alone takes longer than budgetMs.
+int RunStartupCheck(double budgetMs) {
+  bomaqs::start_startup_trace("shuriken-dash", budgetMs);
+  bomaqs::trace_startup_phase("mount_sessions", [] { bomaqs::mount_session_storage(); });
+  GameWorld world = CreateWorld(time(NULL));
+  bomaqs::trace_startup_phase("load_session", [&] { LoadSession(&world); });
+  return bomaqs::finish_startup_trace() > budgetMs;
+}
+
+#ifndef BOMAQS_NO_MAIN  // tests/ compile the game in without its main
+int main(int argc, char **argv) {
+  // shuriken-dash [--hash-ticks ticks | --startup-check [budget ms] | --scenario file [--render]]
+  if (argc > 2 && strcmp(argv[1], "--hash-ticks") == 0) {
+    return RunHashTicks(atoi(argv[2]));
+  }
+  if (argc > 1 && strcmp(argv[1], "--startup-check") == 0) {
+    return RunStartupCheck(argc > 2 ? atof(argv[2]) : STARTUP_BUDGET_MS);
+  }
+  if (argc > 2 && strcmp(argv[1], "--scenario") == 0) {
+    return RunScenario(argv[2], argc > 3 && strcmp(argv[3], "--render") == 0);
+  }
+
+  // initialization
+  bomaqs::start_startup_trace("shuriken-dash", STARTUP_BUDGET_MS);
+  bomaqs::trace_startup_phase("init_window",
+                              [] { InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, WINDOW_TITLE); });
+  bomaqs::init_input_queue(bomaqs::input_queue);
+
+  // resources
+
+  SetTargetFPS(FRAME_RATE);
+
+  // Game variables, from the last session if it was sent to the background mid game
+  bomaqs::trace_startup_phase("mount_sessions", [] { bomaqs::mount_session_storage(); });
+  GameWorld world = CreateWorld(time(NULL));
+  bomaqs::trace_startup_phase("load_session", [&] { LoadSession(&world); });
+  int lastGesture = GESTURE_NONE;
+  int currentGesture = GESTURE_NONE;
+  bool wasBackground = false;
+
+  // Game loop
+  while (!WindowShouldClose()) {
+    TickInput input = {.delta = GetFrameTime()};
+#ifdef BOMAQS_FIXED_SIM
+    // Ticks can't depend on how long this machine's frames took
+    input.delta = 1.0f / FRAME_RATE;
+#endif
+
+    // Update & Input
+    lastGesture = currentGesture;
+    currentGesture = GetGestureDetected();
+
+    // Restart game on R, wherever it is among the keys pressed since the last frame
+    bomaqs::poll_input_events(bomaqs::input_queue);
+    bomaqs::InputEvent event;
+    while (bomaqs::pop_input_event(bomaqs::input_queue, &event)) {
+      if (event.type == bomaqs::INPUT_KEY && event.code == KEY_R) {
+        world = CreateWorld(time(NULL));
+        lastGesture = GESTURE_NONE;
+        currentGesture = GESTURE_NONE;
+      }
+    }
+
+    input.gesture = currentGesture;
+    input.lastGesture = lastGesture;
+    UpdateWorld(&world, input);
+
+    // Going to the background may be the last thing the app does, save the session now
+    bool inBackground = IsWindowMinimized() || !IsWindowFocused();
+    if (inBackground && !wasBackground) {
+      SaveSession(&world);
+    }
+    wasBackground = inBackground;
+
+    // Draw
+    BeginDrawing();
+    ClearBackground(WHITE);
+    DrawWorld(&world);
+    DrawFPS(10, 10);
+    EndDrawing();
+    bomaqs::finish_startup_trace();  // only the first frame, no-op after
+  }
+
+  // Unload and terminate
+  SaveSession(&world);
+  CloseWindow();
+  return 0;
+}
+#endif
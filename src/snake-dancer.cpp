@@ -1,12 +1,20 @@
 #include <raylib.h>
 #include <raymath.h>
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <vector>
 
 #include "utils/data-loader.hpp"
+#include "utils/input-queue.hpp"
+#include "utils/latency-probe.hpp"
+#include "utils/music-streamer.hpp"
+#include "utils/scenario.hpp"
+#include "utils/startup-trace.hpp"
 
 #define FRAME_RATE 60
+#define STARTUP_BUDGET_MS 800  // launch to the first frame
 #define CRAYOLA \
   CLITERAL(Color) { 185, 226, 140, 255 }
 #define PURPLE_NAVY \
@@ -22,27 +30,42 @@ void draw_snake(vector<Vector2>);
 void draw_beat_indicators(float progress);
 void move_snake(vector<Vector2> &currentSnake, Vector2 direction);
 void camera_follow_smooth(Camera2D *camera, Vector2 player, float delta, int width, int height);
+int run_startup_check(double budget_ms);
+int run_scenario(const char *path, bool rendered);
 
 const int SCREEN_WIDTH = 450;
 const int SCREEN_HEIGHT = 800;
 const int SNAKE_SCALE = 25;
 
-int main() {
+#ifndef BOMAQS_NO_MAIN
+int main(int argc, char **argv) {
+  // snake-dancer [--startup-check [budget ms] | --scenario file [--render]]
+  if (argc > 1 && strcmp(argv[1], "--startup-check") == 0) {
+    return run_startup_check(argc > 2 ? atof(argv[2]) : STARTUP_BUDGET_MS);
+  }
+  if (argc > 2 && strcmp(argv[1], "--scenario") == 0) {
+    return run_scenario(argv[2], argc > 3 && strcmp(argv[3], "--render") == 0);
+  }
+
   // Initialization
   //--------------------------------------------------------------------------------------
+  bomaqs::start_startup_trace("snake-dancer", STARTUP_BUDGET_MS);
 
   Camera2D camera = {0};
   camera.rotation = 0.0f;
   camera.zoom = 1.0f;
 
-  InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Snake Dancer");
-  InitAudioDevice();
+  bomaqs::trace_startup_phase("init_window",
+                              [] { InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Snake Dancer"); });
+  bomaqs::trace_startup_phase("init_audio", [] { InitAudioDevice(); });
+  bomaqs::init_input_queue(bomaqs::input_queue);
 
   // load resources
-  Music bgm_music = bomaqs::load_music("Funky-Chiptune.mp3");
-  bgm_music.looping = true;
-  SetMusicVolume(bgm_music, 0.9f);
-  PlayMusicStream(bgm_music);
+  bomaqs::MusicStreamer bgm_music;
+  bomaqs::trace_startup_phase(
+      "open_music", [&] { bomaqs::open_music_streamer(bgm_music, "Funky-Chiptune.mp3"); });
+  bomaqs::set_music_streamer_volume(bgm_music, 0.9f);
+  bomaqs::play_music_streamer(bgm_music);
 
   SetTargetFPS(FRAME_RATE);  // Set our game to run at 144 frames-per-second
   //--------------------------------------------------------------------------------------
@@ -61,12 +84,13 @@ int main() {
   float beat_timer = beat_duration;
   bool input_mode = false;
   Vector2 center_circle = {SCREEN_WIDTH / 2, SCREEN_HEIGHT - 75};
+  auto latency_probe = bomaqs::create_latency_probe("snake-dancer");
 
   // Main game loop
   while (!WindowShouldClose()) {
-    UpdateMusicStream(bgm_music);
+    bomaqs::update_music_streamer(bgm_music);
 
-    Vector2 direction = {0, 0};
+    Vector2 direction = prev_direction;
     float delta_time = GetFrameTime();
 
     beat_timer -= delta_time;
@@ -74,31 +98,41 @@ int main() {
     auto beat_progress = 1 - (beat_timer / beat_duration);
     bool is_hit = CheckCollisionCircles((Vector2){center_circle.x * beat_progress, center_circle.y},
                                         20, center_circle, 25);
-    auto key_pressed = GetKeyPressed();
 
-    switch (key_pressed) {
-      case KEY_UP: {
-        direction = {0, -1};
-        break;
-      }
-      case KEY_RIGHT: {
-        direction = {1, 0};
-        break;
+    // Every key since the last frame in order, the last arrow wins
+    int key_pressed = 0;
+    double key_time = 0;
+    bomaqs::poll_input_events(bomaqs::input_queue);
+    bomaqs::InputEvent event;
+    while (bomaqs::pop_input_event(bomaqs::input_queue, &event)) {
+      if (event.type != bomaqs::INPUT_KEY) {
+        continue;
       }
-      case KEY_DOWN: {
-        direction = {0, 1};
-        break;
+      switch (event.code) {
+        case KEY_UP:
+          direction = {0, -1};
+          break;
+        case KEY_RIGHT:
+          direction = {1, 0};
+          break;
+        case KEY_DOWN:
+          direction = {0, 1};
+          break;
+        case KEY_LEFT:
+          direction = {-1, 0};
+          break;
+        default:
+          continue;
       }
-      case KEY_LEFT: {
-        direction = {-1, 0};
-        break;
-      }
-      default:
-        direction = prev_direction;
-        break;
+      key_pressed = event.code;
+      key_time = event.time;
     }
 
     if (is_hit) {
+      // A hit turns the snake on the next beat, that's when the player sees it
+      if (key_pressed) {
+        bomaqs::latency_input(latency_probe, key_time);
+      }
       prev_direction = direction;
     } else {
       direction = prev_direction;
@@ -107,6 +141,7 @@ int main() {
     if (beat_timer <= 0) {
       beat_timer = beat_duration;
       move_snake(positions, direction);
+      bomaqs::latency_effect(latency_probe);
     }
 
     // move_snake(positions, direction);
@@ -135,16 +170,118 @@ int main() {
 
     EndMode2D();
     EndDrawing();
+    bomaqs::latency_frame_end(latency_probe);
+    bomaqs::finish_startup_trace();  // only the first frame, no-op after
   }
 
   // De-Initialization
-  UnloadMusicStream(bgm_music);
+  bomaqs::save_latency_histogram(latency_probe);
+  bomaqs::close_music_streamer(bgm_music);
   //--------------------------------------------------------------------------------------
   CloseWindow();  // Close window and OpenGL context
   //--------------------------------------------------------------------------------------
 
   return 0;
 }
+#endif
+
+// The windowless part of a cold start: audio device and the music stream. Exits with 1 when that
+// alone takes longer than budget_ms.
+int run_startup_check(double budget_ms) {
+  bomaqs::start_startup_trace("snake-dancer", budget_ms);
+  bomaqs::trace_startup_phase("init_audio", [] { InitAudioDevice(); });
+  bomaqs::MusicStreamer bgm_music;
+  bomaqs::trace_startup_phase(
+      "open_music", [&] { bomaqs::open_music_streamer(bgm_music, "Funky-Chiptune.mp3"); });
+  double startup_ms = bomaqs::finish_startup_trace();
+
+  bomaqs::close_music_streamer(bgm_music);
+  CloseAudioDevice();
+  return startup_ms > budget_ms;
+}
+
+// Stress scenario, see src/utils/scenario.hpp. Snake Dancer's directives:
+//   length <n>           segments, in a line behind the head
+//   move every <ticks>   a step every that many ticks, a beat of the music (27) if missing
+//   turn every <ticks>   turns clockwise every that many ticks, never if missing
+int run_scenario(const char *path, bool rendered) {
+  bomaqs::Scenario scenario;
+  if (!bomaqs::load_scenario(path, "snake-dancer", scenario)) {
+    return 1;
+  }
+
+  int length = 8;
+  int move_every = FRAME_RATE * 60 / 129;
+  int turn_every = 0;
+  bool valid = true;
+  vector<float> numbers;
+  for (auto &line : scenario.lines) {
+    bomaqs::ScenarioLine arguments = line;
+    bool every = !line.words.empty() && line.words[0] == "every";
+    if (every) {
+      arguments.words.erase(arguments.words.begin());
+    }
+    bool known = line.directive == "length" || (every && line.directive == "move") ||
+                 (every && line.directive == "turn");
+    if (!known) {
+      bomaqs::scenario_warning(scenario, line, "isn't a Snake Dancer directive");
+      valid = false;
+    } else if (!bomaqs::scenario_numbers(scenario, arguments, 1, 1, numbers) || numbers[0] < 1) {
+      valid = false;
+    } else if (line.directive == "length") {
+      length = numbers[0];
+    } else if (line.directive == "move") {
+      move_every = numbers[0];
+    } else {
+      turn_every = numbers[0];
+    }
+  }
+  if (!valid) {
+    return 1;
+  }
+
+  Camera2D camera = {0};
+  camera.zoom = 1.0f;
+  if (rendered) {
+    InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Snake Dancer");
+  }
+  vector<Vector2> positions(length);
+  for (int i = 0; i < length; i++) {
+    positions[i] = {(float)SCREEN_WIDTH / 2 - i * SNAKE_SCALE, SCREEN_HEIGHT / 2};
+  }
+  const Vector2 turns[] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+  int turn = 0;
+
+  bomaqs::ScenarioStats stats;
+  bomaqs::start_scenario_stats(stats, scenario);
+  for (int tick = 1; tick <= scenario.ticks && !(rendered && WindowShouldClose()); tick++) {
+    if (turn_every && tick % turn_every == 0) {
+      turn = (turn + 1) % 4;
+    }
+    if (tick % move_every == 0) {
+      move_snake(positions, turns[turn]);
+    }
+
+    if (rendered) {
+      camera_follow_smooth(&camera, positions[0], 1.0f / FRAME_RATE, SCREEN_WIDTH, SCREEN_HEIGHT);
+      BeginDrawing();
+      ClearBackground(CRAYOLA);
+      BeginMode2D(camera);
+      draw_snake(positions);
+      EndMode2D();
+      DrawFPS(10, 10);
+      EndDrawing();
+    }
+    bomaqs::record_scenario_tick(stats);
+  }
+
+  if (rendered) {
+    CloseWindow();
+  }
+  return bomaqs::report_scenario(
+      scenario, stats, rendered,
+      TextFormat("%d segments, head at %.0f,%.0f", length, positions[0].x, positions[0].y));
+}
 
 void move_snake(vector<Vector2> &snake, Vector2 direction) {
   if (Vector2Length(direction) == 0) {
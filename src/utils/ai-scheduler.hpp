@@ -0,0 +1,110 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstdint>
+
+// Time-sliced AI. Entities split their update into a think (decisions: aiming, range checks) that
+// the scheduler hands out, and movement the game integrates every tick regardless. Each entity
+// has a next_think frame, and its think returns how many ticks until it wants to think again,
+// usually ai_lod_cadence of its distance to the player: every tick up close, every 2nd or 4th
+// tick further out. First thinks are staggered by entity id so a wave spawned together doesn't
+// think in lockstep.
+//
+// A tick runs at most think_budget thinks. Entities due past the budget wait for the next tick,
+// which starts where this one stopped so nobody starves. The budget counts thinks rather than
+// time so the simulation stays deterministic. Wall time is only measured for the report: games time
+// the ticks that run their schedules from outside the tick, which can't read clocks, and pass it to
+// report_ai_budget. Ticks that took longer than AI_TIME_BUDGET_US are counted and logged every
+// AI_REPORT_TICKS.
+
+#define AI_NEAR_DISTANCE 200  // px, think every tick within
+#define AI_FAR_DISTANCE 450   // px, think every AI_FAR_CADENCE ticks beyond
+#define AI_MID_CADENCE 2
+#define AI_FAR_CADENCE 4
+#define AI_TIME_BUDGET_US 500  // a whole tick, AI and the rest
+#define AI_REPORT_TICKS (60 * 5)
+
+namespace bomaqs {
+
+// Lives in the world, it's simulation state
+typedef struct {
+  int think_budget;    // thinks per tick
+  int cursor;          // where the next tick starts looking
+  unsigned int thinks;    // running counts
+  unsigned int deferred;  // due but pushed to a later tick by the budget
+} AiSchedule;
+
+// Wall time of the AI, only reported, never fed back into the simulation
+typedef struct {
+  int ticks;
+  int overruns;
+  double worst_us;
+  double total_us;
+  unsigned int deferred_seen;
+} AiBudgetReport;
+
+inline AiBudgetReport ai_budget_report;
+
+inline AiSchedule create_ai_schedule(int think_budget) { return {think_budget, 0, 0, 0}; }
+
+inline int ai_lod_cadence(float distance_squared) {
+  if (distance_squared < AI_NEAR_DISTANCE * AI_NEAR_DISTANCE) {
+    return 1;
+  }
+  return distance_squared < AI_FAR_DISTANCE * AI_FAR_DISTANCE ? AI_MID_CADENCE : AI_FAR_CADENCE;
+}
+
+// First think of a new entity, spread over the far cadence
+inline uint32_t ai_first_think(uint32_t frame, unsigned int id) { return frame + id % AI_FAR_CADENCE; }
+
+// deferred is the running deferred count over all of the game's schedules
+inline void report_ai_budget(unsigned int deferred_total, double elapsed_us) {
+  AiBudgetReport &report = ai_budget_report;
+  report.ticks += 1;
+  report.total_us += elapsed_us;
+  report.worst_us = elapsed_us > report.worst_us ? elapsed_us : report.worst_us;
+  report.overruns += elapsed_us > AI_TIME_BUDGET_US;
+  if (report.ticks < AI_REPORT_TICKS) {
+    return;
+  }
+
+  unsigned int deferred = deferred_total - report.deferred_seen;
+  if (report.overruns || deferred) {
+    TraceLog(LOG_WARNING,
+             "AI: %d of %d ticks over the %dus budget (avg %.1fus, worst %.1fus), %u thinks deferred",
+             report.overruns, report.ticks, AI_TIME_BUDGET_US, report.total_us / report.ticks,
+             report.worst_us, deferred);
+  }
+  report = {0, 0, 0, 0, deferred_total};
+}
+
+// Thinks every entity that's due this frame, within the budget. think(index) returns the ticks
+// until entities[index]'s next think.
+template <typename Entity, typename Think>
+inline void run_ai_schedule(AiSchedule &schedule, Entity *entities, int count, uint32_t frame,
+                            Think think) {
+  int budget = schedule.think_budget;
+  int first = count ? schedule.cursor % count : 0;
+  schedule.cursor = first;
+
+  for (int n = 0; n < count; n++) {
+    int index = (first + n) % count;
+    if ((int32_t)(frame - entities[index].next_think) < 0) {
+      continue;
+    }
+    if (budget == 0) {
+      // the first one left waiting goes first next tick
+      if (schedule.cursor == first) {
+        schedule.cursor = index;
+      }
+      schedule.deferred += 1;
+      continue;
+    }
+
+    budget -= 1;
+    schedule.thinks += 1;
+    entities[index].next_think = frame + think(index);
+  }
+}
+}  // namespace bomaqs
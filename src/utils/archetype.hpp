@@ -0,0 +1,67 @@
+#pragma once
+
+#include <type_traits>
+
+// Dense storage for one archetype of entity, every entity in it has the same components. Hot
+// components (read and written every tick) and cold ones (drawing, rarely used state) sit in two
+// parallel arrays indexed by slot, so the per-tick systems only stream through the hot data.
+//
+// Slots aren't stable: swap_remove moves the last entity into the hole, O(1) and no shifting.
+// Refer to entities across ticks by an id in their components, not by slot. Like FixedVector it's
+// trivially copyable when its components are, worlds built from these stay flat.
+
+namespace bomaqs {
+
+template <typename Hot, typename Cold, int Capacity>
+struct Archetype {
+  Hot hot[Capacity];
+  Cold cold[Capacity];
+  int count;
+
+  int size() const { return count; }
+  bool empty() const { return count == 0; }
+  bool full() const { return count == Capacity; }
+  void clear() { count = 0; }
+
+  // Slot of the new entity, -1 when full
+  int push_back(const Hot &hot_item, const Cold &cold_item) {
+    if (count == Capacity) {
+      return -1;
+    }
+    hot[count] = hot_item;
+    cold[count] = cold_item;
+    return count++;
+  }
+
+  void swap_remove(int slot) {
+    count -= 1;
+    hot[slot] = hot[count];
+    cold[slot] = cold[count];
+  }
+
+  // Swap-removes every entity remove(hot) is true for, moved(slot) is called when an entity is
+  // moved into slot. The resulting order only depends on the order before, so it's as
+  // deterministic as the entities.
+  template <typename Remove, typename Moved>
+  void remove_if(Remove remove, Moved moved) {
+    for (int slot = 0; slot < count;) {
+      if (remove(hot[slot])) {
+        swap_remove(slot);
+        if (slot < count) {
+          moved(slot);
+        }
+      } else {
+        slot += 1;
+      }
+    }
+  }
+
+  template <typename Remove>
+  void remove_if(Remove remove) {
+    remove_if(remove, [](int) {});
+  }
+
+  static_assert(std::is_trivially_copyable<Hot>::value && std::is_trivially_copyable<Cold>::value,
+                "components are copied around with the world");
+};
+}  // namespace bomaqs
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define BUNDLE_USE_MMAP
+#endif
+
+// Packed asset bundle, written by tools/bundle-assets.cpp and read by data-loader.hpp.
+//
+// Layout: BundleHeader, entry_count BundleEntry records sorted by name, then payloads each starting
+// on a BUNDLE_ALIGNMENT boundary. Entries flagged BUNDLE_DEFLATE hold CompressData output and are
+// inflated on first read, everything else is handed out as a span straight into the mapping.
+
+#define BUNDLE_MAGIC "BQPK"
+#define BUNDLE_VERSION 1
+#define BUNDLE_ALIGNMENT 16
+#define BUNDLE_NAME_LENGTH 48
+#define BUNDLE_DEFLATE 1
+
+namespace bomaqs {
+
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+} BundleHeader;
+
+typedef struct {
+  char name[BUNDLE_NAME_LENGTH];
+  uint32_t offset;
+  uint32_t size;      // bytes stored in the bundle
+  uint32_t raw_size;  // bytes after inflating
+  uint32_t flags;
+} BundleEntry;
+
+typedef struct {
+  const unsigned char *data;
+  unsigned int size;
+} FileSpan;
+
+typedef struct {
+  unsigned char *data;
+  size_t size;
+  const BundleEntry *entries;
+  uint32_t entry_count;
+  std::mutex mutex;  // guards inflated, lookups happen from asset workers
+  std::map<uint32_t, unsigned char *> inflated;
+} AssetBundle;
+
+inline bool open_bundle(AssetBundle &bundle, const char *path) {
+  bundle.data = NULL;
+  bundle.size = 0;
+  bundle.entry_count = 0;
+
+#ifdef BUNDLE_USE_MMAP
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    void *mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      bundle.data = (unsigned char *)mapping;
+      bundle.size = info.st_size;
+    }
+  }
+  close(fd);
+#else
+  // no mmap here, read the whole bundle once and hand out spans into that buffer
+  if (FileExists(path)) {
+    unsigned int size = 0;
+    bundle.data = LoadFileData(path, &size);
+    bundle.size = size;
+  }
+#endif
+
+  if (!bundle.data) {
+    return false;
+  }
+
+  auto header = (const BundleHeader *)bundle.data;
+  bool valid = bundle.size >= sizeof(BundleHeader) &&
+               memcmp(header->magic, BUNDLE_MAGIC, 4) == 0 && header->version == BUNDLE_VERSION &&
+               sizeof(BundleHeader) + ((size_t)header->entry_count * sizeof(BundleEntry)) <=
+                   bundle.size;
+
+  auto entries = (const BundleEntry *)(bundle.data + sizeof(BundleHeader));
+  for (uint32_t i = 0; valid && i < header->entry_count; i++) {
+    valid = (size_t)entries[i].offset + entries[i].size <= bundle.size;
+  }
+
+  if (!valid) {
+    TraceLog(LOG_WARNING, "BUNDLE: [%s] Invalid or outdated bundle", path);
+#ifdef BUNDLE_USE_MMAP
+    munmap(bundle.data, bundle.size);
+#else
+    UnloadFileData(bundle.data);
+#endif
+    bundle.data = NULL;
+    return false;
+  }
+
+  bundle.entries = entries;
+  bundle.entry_count = header->entry_count;
+  TraceLog(LOG_INFO, "BUNDLE: [%s] Mounted %u entries (%zu bytes)", path, bundle.entry_count,
+           bundle.size);
+  return true;
+}
+
+inline void close_bundle(AssetBundle &bundle) {
+  if (!bundle.data) {
+    return;
+  }
+
+  for (auto &entry : bundle.inflated) {
+    free(entry.second);
+  }
+  bundle.inflated.clear();
+
+#ifdef BUNDLE_USE_MMAP
+  munmap(bundle.data, bundle.size);
+#else
+  UnloadFileData(bundle.data);
+#endif
+  bundle.data = NULL;
+  bundle.entry_count = 0;
+}
+
+inline int find_bundle_entry(AssetBundle &bundle, const char *name) {
+  int low = 0, high = (int)bundle.entry_count - 1;
+  while (low <= high) {
+    int mid = (low + high) / 2;
+    int order = strncmp(bundle.entries[mid].name, name, BUNDLE_NAME_LENGTH);
+    if (order == 0) {
+      return mid;
+    }
+    if (order < 0) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return -1;
+}
+
+// Span for a bundled file, {NULL, 0} when it isn't in the bundle. Spans stay valid until
+// close_bundle, compressed entries are inflated once and cached.
+inline FileSpan read_bundle_entry(AssetBundle &bundle, const char *name) {
+  int index = bundle.data ? find_bundle_entry(bundle, name) : -1;
+  if (index < 0) {
+    return {NULL, 0};
+  }
+
+  const BundleEntry &entry = bundle.entries[index];
+  const unsigned char *payload = bundle.data + entry.offset;
+  if (!(entry.flags & BUNDLE_DEFLATE)) {
+    return {payload, entry.size};
+  }
+
+  std::lock_guard<std::mutex> lock(bundle.mutex);
+  auto cached = bundle.inflated.find(index);
+  if (cached != bundle.inflated.end()) {
+    return {cached->second, entry.raw_size};
+  }
+
+  int size = 0;
+  unsigned char *data = DecompressData((unsigned char *)payload, entry.size, &size);
+  if (!data || (uint32_t)size != entry.raw_size) {
+    TraceLog(LOG_WARNING, "BUNDLE: [%s] Failed to inflate entry", name);
+    return {NULL, 0};
+  }
+  bundle.inflated[index] = data;
+  return {data, entry.raw_size};
+}
+}  // namespace bomaqs
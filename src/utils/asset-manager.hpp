@@ -0,0 +1,615 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "data-loader.hpp"
+#include "music-streamer.hpp"
+#include "startup-trace.hpp"
+
+// Asynchronous asset loading. Files are decoded and parsed on a worker pool (WAV/OGG/MP3 decode,
+// image decode, TTF rasterization, dictionary parsing), anything that needs the GL context is
+// queued and uploaded on the main thread by update_asset_manager. Games poll handles for readiness
+// and can draw a first frame before everything is in.
+//
+// Web builds without pthreads have no workers, update_asset_manager then decodes one asset per call
+// on the main thread so loading is still spread across frames.
+//
+// Every loaded asset is accounted in CPU and GPU bytes. A category (texture, sound, ...) can get a
+// byte budget with set_asset_budget, once over it the least recently used assets of that category
+// are unloaded. Evicted assets reload the next time asset_ready is asked about them. Only textures,
+// sounds and fonts are evicted, and only after ASSET_EVICT_AGE_FRAMES without a get_* call, so a
+// sound still playing or a font copied out by the game isn't pulled from under it (pin_asset keeps
+// an asset resident for good).
+
+#if defined(PLATFORM_WEB) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define ASSET_WORKERS_MAX 0
+#else
+#define ASSET_WORKERS_MAX 4
+#endif
+
+#define ASSET_EVICT_AGE_FRAMES 300
+
+// Budgets the games start with, sized for low-memory Android devices and the 64MB web heap
+#define ASSET_TEXTURE_BUDGET (16 << 20)
+#define ASSET_SOUND_BUDGET (8 << 20)
+#define ASSET_FONT_BUDGET (4 << 20)
+
+namespace bomaqs {
+
+enum AssetType {
+  ASSET_TEXTURE,
+  ASSET_SOUND,
+  ASSET_MUSIC,
+  ASSET_FONT,
+  ASSET_WORD_DICT,
+  ASSET_TYPE_COUNT,
+};
+
+enum AssetState {
+  ASSET_QUEUED,
+  ASSET_DECODED,  // CPU data ready, waiting for main thread upload
+  ASSET_READY,
+  ASSET_FAILED,
+  ASSET_EVICTED,  // unloaded to stay in budget, reloads when asked for
+};
+
+typedef int AssetHandle;
+
+typedef struct {
+  AssetType type;
+  std::string file;
+  int font_size;
+  int char_count;
+  std::atomic<int> state;
+
+  // decoded on a worker, released after upload
+  Image image;
+  Wave wave;
+
+  Texture2D texture;
+  Sound sound;
+  std::unique_ptr<MusicStreamer> music;
+  Font font;
+  word_dict dictionary;
+
+  // accounting, main thread only
+  size_t cpu_bytes;
+  size_t gpu_bytes;
+  unsigned long long last_used;  // frame of the last get_* call
+  bool pinned;
+} Asset;
+
+typedef struct {
+  std::vector<std::unique_ptr<Asset>> assets;
+  std::vector<std::thread> workers;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::deque<Asset *> decode_queue;
+  std::deque<Asset *> upload_queue;
+  bool stopping;
+
+  unsigned long long frame;
+  size_t budgets[ASSET_TYPE_COUNT];  // bytes, CPU + GPU, 0 for no budget
+} AssetManager;
+
+inline const char *asset_type_name(AssetType type) {
+  static const char *names[ASSET_TYPE_COUNT] = {"texture", "sound", "music", "font", "dictionary"};
+  return names[type];
+}
+
+// Worker side: everything here must stay off the GL context
+inline void decode_asset(Asset *asset) {
+  StartupSpan span = begin_startup_phase("decode", asset->file);
+  bool ok = false;
+  switch (asset->type) {
+    case ASSET_TEXTURE:
+      asset->image = decode_image(asset->file);
+      ok = asset->image.data != NULL;
+      break;
+    case ASSET_SOUND:
+      asset->wave = decode_wave(asset->file);
+      ok = asset->wave.data != NULL;
+      break;
+    case ASSET_MUSIC:
+      // opens the decoder and starts its decode thread, raudio guards its stream list with the
+      // device lock
+      asset->music = std::make_unique<MusicStreamer>();
+      ok = open_music_streamer(*asset->music, asset->file);
+      break;
+    case ASSET_FONT:
+      asset->font = decode_font(asset->file, &asset->image, asset->font_size, asset->char_count);
+      ok = asset->font.chars != NULL;
+      break;
+    case ASSET_WORD_DICT:
+      asset->dictionary = load_word_dictionary(asset->file);
+      ok = !asset->dictionary.empty();
+      break;
+    default:
+      break;
+  }
+
+  end_startup_phase(span);
+  asset->state = ok ? ASSET_DECODED : ASSET_FAILED;
+}
+
+inline size_t texture_bytes(Texture2D texture) {
+  return GetPixelDataSize(texture.width, texture.height, texture.format);
+}
+
+// Resident bytes of a loaded asset
+inline void measure_asset(Asset *asset) {
+  asset->cpu_bytes = 0;
+  asset->gpu_bytes = 0;
+  switch (asset->type) {
+    case ASSET_TEXTURE:
+      asset->gpu_bytes = texture_bytes(asset->texture);
+      break;
+    case ASSET_SOUND:
+      // raudio keeps sounds converted to its 32 bit float device format
+      asset->cpu_bytes = (size_t)asset->sound.sampleCount * sizeof(float);
+      break;
+    case ASSET_MUSIC:
+      asset->cpu_bytes = music_streamer_bytes(*asset->music);
+      break;
+    case ASSET_FONT:
+      asset->gpu_bytes = texture_bytes(asset->font.texture);
+      asset->cpu_bytes =
+          (size_t)asset->font.charsCount * (sizeof(CharInfo) + sizeof(Rectangle));
+      break;
+    case ASSET_WORD_DICT:
+      for (auto &entry : asset->dictionary) {
+        for (auto &word : entry.second) {
+          asset->cpu_bytes += sizeof(std::string) + word.capacity();
+        }
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// Main thread side of loading
+inline void upload_asset(Asset *asset) {
+  StartupSpan span = begin_startup_phase("upload", asset->file);
+  switch (asset->type) {
+    case ASSET_TEXTURE:
+      asset->texture = LoadTextureFromImage(asset->image);
+      UnloadImage(asset->image);
+      break;
+    case ASSET_SOUND:
+      asset->sound = LoadSoundFromWave(asset->wave);
+      UnloadWave(asset->wave);
+      break;
+    case ASSET_FONT:
+      asset->font.texture = LoadTextureFromImage(asset->image);
+      UnloadImage(asset->image);
+      // DrawTextEx only needs the atlas and recs, the glyph images would just sit in RAM
+      for (int i = 0; i < asset->font.charsCount; i++) {
+        UnloadImage(asset->font.chars[i].image);
+        asset->font.chars[i].image.data = NULL;
+      }
+      break;
+    default:
+      break;
+  }
+
+  asset->image = {0};
+  asset->wave = {0};
+  measure_asset(asset);
+  asset->state = ASSET_READY;
+  end_startup_phase(span);
+}
+
+// Frees a decoded asset that was never uploaded, none of it is on the GPU or audio device yet
+inline void discard_decoded_asset(Asset *asset) {
+  switch (asset->type) {
+    case ASSET_TEXTURE:
+      UnloadImage(asset->image);
+      break;
+    case ASSET_SOUND:
+      UnloadWave(asset->wave);
+      break;
+    case ASSET_MUSIC:
+      close_music_streamer(*asset->music);
+      break;
+    case ASSET_FONT:
+      UnloadImage(asset->image);
+      UnloadFontData(asset->font.chars, asset->font.charsCount);
+      MemFree(asset->font.recs);
+      break;
+    case ASSET_WORD_DICT:
+      asset->dictionary.clear();
+      break;
+    default:
+      break;
+  }
+  asset->image = {0};
+  asset->wave = {0};
+}
+
+// Frees everything a ready asset holds
+inline void release_asset(Asset *asset) {
+  switch (asset->type) {
+    case ASSET_TEXTURE:
+      UnloadTexture(asset->texture);
+      break;
+    case ASSET_SOUND:
+      UnloadSound(asset->sound);
+      break;
+    case ASSET_MUSIC:
+      close_music_streamer(*asset->music);
+      break;
+    case ASSET_FONT:
+      UnloadFont(asset->font);
+      break;
+    case ASSET_WORD_DICT:
+      asset->dictionary.clear();
+      break;
+    default:
+      break;
+  }
+  asset->cpu_bytes = 0;
+  asset->gpu_bytes = 0;
+}
+
+inline void run_asset_worker(AssetManager *manager) {
+  while (true) {
+    Asset *asset;
+    {
+      std::unique_lock<std::mutex> lock(manager->mutex);
+      manager->wake.wait(lock,
+                         [manager] { return manager->stopping || !manager->decode_queue.empty(); });
+      if (manager->stopping) {
+        return;
+      }
+      asset = manager->decode_queue.front();
+      manager->decode_queue.pop_front();
+    }
+
+    decode_asset(asset);
+
+    if (asset->state == ASSET_DECODED) {
+      std::lock_guard<std::mutex> lock(manager->mutex);
+      manager->upload_queue.push_back(asset);
+    }
+  }
+}
+
+inline void init_asset_manager(AssetManager &manager, int worker_count = ASSET_WORKERS_MAX) {
+  manager.stopping = false;
+  manager.frame = 0;
+  for (auto &budget : manager.budgets) {
+    budget = 0;
+  }
+
+  int cores = std::thread::hardware_concurrency();
+  worker_count = std::min(worker_count, std::max(1, cores - 1));
+  for (int i = 0; i < worker_count; i++) {
+    manager.workers.push_back(std::thread(run_asset_worker, &manager));
+  }
+}
+
+inline AssetHandle queue_asset(AssetManager &manager, AssetType type, std::string file,
+                               int font_size = 16, int char_count = 95) {
+  auto asset = std::make_unique<Asset>();
+  asset->type = type;
+  asset->file = file;
+  asset->font_size = font_size;
+  asset->char_count = char_count;
+  asset->state = ASSET_QUEUED;
+  asset->cpu_bytes = 0;
+  asset->gpu_bytes = 0;
+  asset->last_used = manager.frame;
+  asset->pinned = false;
+
+  {
+    std::lock_guard<std::mutex> lock(manager.mutex);
+    manager.decode_queue.push_back(asset.get());
+  }
+  manager.wake.notify_one();
+
+  manager.assets.push_back(std::move(asset));
+  return manager.assets.size() - 1;
+}
+
+inline AssetHandle queue_texture(AssetManager &manager, std::string file) {
+  return queue_asset(manager, ASSET_TEXTURE, file);
+}
+
+inline AssetHandle queue_sound(AssetManager &manager, std::string file) {
+  return queue_asset(manager, ASSET_SOUND, file);
+}
+
+inline AssetHandle queue_music(AssetManager &manager, std::string file) {
+  return queue_asset(manager, ASSET_MUSIC, file);
+}
+
+inline AssetHandle queue_font(AssetManager &manager, std::string file, int base_size = 16,
+                              int char_count = 95) {
+  return queue_asset(manager, ASSET_FONT, file, base_size, char_count);
+}
+
+inline AssetHandle queue_word_dictionary(AssetManager &manager, std::string file) {
+  return queue_asset(manager, ASSET_WORD_DICT, file);
+}
+
+inline bool evictable(AssetManager &manager, Asset *asset) {
+  return asset->state == ASSET_READY && !asset->pinned &&
+         (asset->type == ASSET_TEXTURE || asset->type == ASSET_SOUND ||
+          asset->type == ASSET_FONT) &&
+         manager.frame - asset->last_used > ASSET_EVICT_AGE_FRAMES;
+}
+
+inline size_t asset_category_bytes(AssetManager &manager, AssetType type) {
+  size_t bytes = 0;
+  for (auto &asset : manager.assets) {
+    if (asset->type == type) {
+      bytes += asset->cpu_bytes + asset->gpu_bytes;
+    }
+  }
+  return bytes;
+}
+
+// Unloads least recently used assets of categories over budget
+inline void enforce_asset_budgets(AssetManager &manager) {
+  for (int type = 0; type < ASSET_TYPE_COUNT; type++) {
+    size_t budget = manager.budgets[type];
+    if (budget == 0) {
+      continue;
+    }
+
+    size_t used = asset_category_bytes(manager, (AssetType)type);
+    while (used > budget) {
+      Asset *oldest = NULL;
+      for (auto &asset : manager.assets) {
+        if (asset->type == type && evictable(manager, asset.get()) &&
+            (!oldest || asset->last_used < oldest->last_used)) {
+          oldest = asset.get();
+        }
+      }
+      if (!oldest) {
+        break;  // everything left is in use, stay over budget
+      }
+
+      used -= oldest->cpu_bytes + oldest->gpu_bytes;
+      TraceLog(LOG_INFO, "ASSETS: [%s] Evicted %zu bytes, %s over budget", oldest->file.data(),
+               oldest->cpu_bytes + oldest->gpu_bytes, asset_type_name(oldest->type));
+      release_asset(oldest);
+      oldest->state = ASSET_EVICTED;
+    }
+  }
+}
+
+// Call once a frame from the main thread. Uploads decoded assets until budget_seconds is spent,
+// always at least one so loading can't stall, then evicts to stay within the memory budgets.
+inline void update_asset_manager(AssetManager &manager, float budget_seconds = 0.004f) {
+  auto start = std::chrono::steady_clock::now();
+  manager.frame += 1;
+
+  if (manager.workers.empty()) {
+    Asset *asset = NULL;
+    {
+      std::lock_guard<std::mutex> lock(manager.mutex);
+      if (!manager.decode_queue.empty()) {
+        asset = manager.decode_queue.front();
+        manager.decode_queue.pop_front();
+      }
+    }
+    if (asset) {
+      decode_asset(asset);
+      if (asset->state == ASSET_DECODED) {
+        upload_asset(asset);
+      }
+    }
+  }
+
+  while (true) {
+    Asset *asset;
+    {
+      std::lock_guard<std::mutex> lock(manager.mutex);
+      if (manager.upload_queue.empty()) {
+        break;
+      }
+      asset = manager.upload_queue.front();
+      manager.upload_queue.pop_front();
+    }
+
+    upload_asset(asset);
+
+    std::chrono::duration<float> elapsed = std::chrono::steady_clock::now() - start;
+    if (elapsed.count() >= budget_seconds) {
+      break;
+    }
+  }
+
+  enforce_asset_budgets(manager);
+}
+
+// Blocks until every queued asset is decoded or failed, without uploading any. For headless runs
+// that have no GL context, games upload with update_asset_manager.
+inline void wait_for_asset_decodes(AssetManager &manager) {
+  while (true) {
+    Asset *asset = NULL;
+    bool pending = false;
+    {
+      std::lock_guard<std::mutex> lock(manager.mutex);
+      if (manager.workers.empty() && !manager.decode_queue.empty()) {
+        asset = manager.decode_queue.front();
+        manager.decode_queue.pop_front();
+      }
+      for (auto &queued : manager.assets) {
+        pending = pending || queued->state == ASSET_QUEUED;
+      }
+    }
+    if (asset) {
+      decode_asset(asset);
+    } else if (pending) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    } else {
+      return;
+    }
+  }
+}
+
+// Byte budget for a category, CPU and GPU together. 0 removes it.
+inline void set_asset_budget(AssetManager &manager, AssetType type, size_t bytes) {
+  manager.budgets[type] = bytes;
+}
+
+// Never evict this asset
+inline void pin_asset(AssetManager &manager, AssetHandle handle) {
+  manager.assets[handle]->pinned = true;
+}
+
+// An evicted asset is queued again and reports ready once reloaded
+inline bool asset_ready(AssetManager &manager, AssetHandle handle) {
+  Asset *asset = manager.assets[handle].get();
+  if (asset->state == ASSET_EVICTED) {
+    asset->state = ASSET_QUEUED;
+    asset->last_used = manager.frame;
+    {
+      std::lock_guard<std::mutex> lock(manager.mutex);
+      manager.decode_queue.push_back(asset);
+    }
+    manager.wake.notify_one();
+  }
+  return asset->state == ASSET_READY;
+}
+
+inline bool asset_failed(AssetManager &manager, AssetHandle handle) {
+  return manager.assets[handle]->state == ASSET_FAILED;
+}
+
+// Fraction of queued assets that finished loading, failed ones count as finished
+inline float asset_progress(AssetManager &manager) {
+  if (manager.assets.empty()) {
+    return 1.0f;
+  }
+
+  int done = 0;
+  for (auto &asset : manager.assets) {
+    done += asset->state == ASSET_READY || asset->state == ASSET_FAILED ||
+            asset->state == ASSET_EVICTED;
+  }
+  return (float)done / manager.assets.size();
+}
+
+inline Texture2D get_texture(AssetManager &manager, AssetHandle handle) {
+  manager.assets[handle]->last_used = manager.frame;
+  return manager.assets[handle]->texture;
+}
+
+inline Sound get_sound(AssetManager &manager, AssetHandle handle) {
+  manager.assets[handle]->last_used = manager.frame;
+  return manager.assets[handle]->sound;
+}
+
+inline MusicStreamer &get_music(AssetManager &manager, AssetHandle handle) {
+  manager.assets[handle]->last_used = manager.frame;
+  return *manager.assets[handle]->music;
+}
+
+inline Font get_font(AssetManager &manager, AssetHandle handle) {
+  manager.assets[handle]->last_used = manager.frame;
+  return manager.assets[handle]->font;
+}
+
+inline word_dict &get_word_dictionary(AssetManager &manager, AssetHandle handle) {
+  manager.assets[handle]->last_used = manager.frame;
+  return manager.assets[handle]->dictionary;
+}
+
+inline const char *asset_state_name(int state) {
+  static const char *names[] = {"queued", "decoded", "ready", "failed", "evicted"};
+  return names[state];
+}
+
+// One line per asset and a total per category, stable order so reports can be diffed
+inline std::string asset_memory_report(AssetManager &manager) {
+  char line[256];
+  snprintf(line, sizeof(line), "%-40s %-10s %-8s %10s %10s %8s\n", "asset", "type", "state", "cpu",
+           "gpu", "idle");
+  std::string report = line;
+
+  for (auto &asset : manager.assets) {
+    snprintf(line, sizeof(line), "%-40s %-10s %-8s %10zu %10zu %8llu\n", asset->file.data(),
+             asset_type_name(asset->type), asset_state_name(asset->state), asset->cpu_bytes,
+             asset->gpu_bytes, manager.frame - asset->last_used);
+    report += line;
+  }
+
+  size_t cpu_total = 0, gpu_total = 0;
+  for (int type = 0; type < ASSET_TYPE_COUNT; type++) {
+    size_t cpu = 0, gpu = 0;
+    for (auto &asset : manager.assets) {
+      if (asset->type == type) {
+        cpu += asset->cpu_bytes;
+        gpu += asset->gpu_bytes;
+      }
+    }
+    cpu_total += cpu;
+    gpu_total += gpu;
+
+    // the state column shows the budget
+    char budget[32] = "-";
+    if (manager.budgets[type]) {
+      snprintf(budget, sizeof(budget), "/%zuk", manager.budgets[type] / 1024);
+    }
+    snprintf(line, sizeof(line), "%-40s %-10s %-8s %10zu %10zu\n", "total",
+             asset_type_name((AssetType)type), budget, cpu, gpu);
+    report += line;
+  }
+  snprintf(line, sizeof(line), "%-40s %-10s %-8s %10zu %10zu\n", "total", "all", "", cpu_total,
+           gpu_total);
+  report += line;
+  return report;
+}
+
+// Writes the report to the log line by line, TraceLog truncates long messages
+inline void log_asset_memory_report(AssetManager &manager) {
+  std::string report = asset_memory_report(manager);
+  size_t start = 0, end;
+  while ((end = report.find('\n', start)) != std::string::npos) {
+    TraceLog(LOG_INFO, "ASSETS: %s", report.substr(start, end - start).data());
+    start = end + 1;
+  }
+}
+
+// Stops the workers and unloads everything, in flight or ready
+inline void unload_assets(AssetManager &manager) {
+  {
+    std::lock_guard<std::mutex> lock(manager.mutex);
+    manager.stopping = true;
+  }
+  manager.wake.notify_all();
+  for (auto &worker : manager.workers) {
+    worker.join();
+  }
+  manager.workers.clear();
+
+  for (auto &asset : manager.assets) {
+    if (asset->state == ASSET_DECODED) {
+      discard_decoded_asset(asset.get());
+    }
+    if (asset->state == ASSET_READY) {
+      release_asset(asset.get());
+    }
+  }
+
+  manager.assets.clear();
+  manager.decode_queue.clear();
+  manager.upload_queue.clear();
+}
+}  // namespace bomaqs
@@ -0,0 +1,381 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "data-loader.hpp"
+#include "fixed.hpp"
+
+// Bullet patterns. A small line based language compiled to 4 byte instructions, run by a VM that
+// steps every emitter once a tick and hands each new bullet to a callback, so bullets go straight
+// into the game's pool. Patterns loop forever, registers (angle, speed) carry over between loops so
+// spirals keep turning.
+//
+//   # comment
+//   aim               point at the target
+//   angle <deg>       absolute direction, 0 is right, 90 is down
+//   turn <deg>        rotate the current direction
+//   speed <px/tick>
+//   fire              one bullet
+//   fan <n> <deg>     n bullets spread over deg, centered on the direction
+//   ring <n>          n bullets evenly around, starting at the direction
+//   wait <ticks>      wait rate uses the emitter's rate register, set by the game
+//   repeat <n> / end
+//   reload            tells the game the emitter is reloading (PATTERN_RELOAD), ends the tick
+//
+// Patterns load from resources/patterns/<name>.txt, through the bundle when one is mounted.
+// reload_changed_patterns recompiles loose files whose mod time changed, a pattern that fails to
+// compile keeps its previous code. Emitters restart when their pattern's code changes.
+//
+// Registers are fixed point, so a spiral turns by exactly the same amount every loop on every
+// platform. Only the trig goes through libm, or through CORDIC in BOMAQS_FIXED_SIM builds.
+
+#define PATTERN_MAX_DEPTH 4
+#define PATTERN_OPS_PER_TICK 64  // guards against repeat loops without a wait
+#define PATTERN_FIXED 16         // angles and speeds are stored in 1/16 units
+
+namespace bomaqs {
+
+enum PatternOpCode : uint8_t {
+  PATTERN_OP_AIM,
+  PATTERN_OP_ANGLE,
+  PATTERN_OP_TURN,
+  PATTERN_OP_SPEED,
+  PATTERN_OP_FIRE,
+  PATTERN_OP_FAN,
+  PATTERN_OP_RING,
+  PATTERN_OP_WAIT,
+  PATTERN_OP_WAIT_RATE,
+  PATTERN_OP_REPEAT,
+  PATTERN_OP_END,
+  PATTERN_OP_RELOAD,
+};
+
+// Signals returned by step_emitter
+#define PATTERN_RELOAD 1
+
+typedef struct {
+  uint8_t op;
+  uint8_t count;
+  int16_t value;  // fixed point angle/speed, ticks, or repeat count
+} PatternOp;
+
+typedef struct {
+  std::string name;
+  long mod_time;
+  unsigned int version;  // bumped on every successful compile
+  std::vector<PatternOp> code;
+} Pattern;
+
+typedef struct {
+  std::vector<Pattern> patterns;
+} PatternLibrary;
+
+typedef struct {
+  uint16_t pattern;
+  uint16_t pc;
+  uint16_t wait;
+  uint8_t depth;
+  uint8_t rate;  // ticks waited by `wait rate`
+  fixed angle;   // radians, kept in [-pi, pi)
+  fixed speed;   // px/tick
+  unsigned int version;
+  uint16_t loop_start[PATTERN_MAX_DEPTH];
+  uint16_t loop_left[PATTERN_MAX_DEPTH];
+} PatternEmitter;
+
+inline std::string pattern_path(std::string name) { return "patterns/" + name + ".txt"; }
+
+// Compiles source into code, false with a warning naming the line on errors
+inline bool compile_pattern(std::string name, std::string source, std::vector<PatternOp> &code) {
+  std::vector<PatternOp> out;
+  std::vector<int> repeats;
+  std::istringstream lines(source);
+  std::string line;
+  int line_number = 0;
+
+  while (std::getline(lines, line)) {
+    line_number += 1;
+    line = line.substr(0, line.find('#'));
+    std::istringstream tokens(line);
+    std::string word;
+    if (!(tokens >> word)) {
+      continue;
+    }
+
+    PatternOp op = {0, 0, 0};
+    float arg1 = 0, arg2 = 0;
+    int args = 0;
+    std::string rest;
+    if (tokens >> rest) {
+      if (word == "wait" && rest == "rate") {
+        args = -1;
+      } else {
+        arg1 = strtof(rest.data(), NULL);
+        args = 1;
+        if (tokens >> arg2) {
+          args = 2;
+        }
+      }
+    }
+
+    auto expect = [&](int count) {
+      if (args != count) {
+        TraceLog(LOG_WARNING, "PATTERN: [%s:%d] '%s' takes %d argument(s)", name.data(),
+                 line_number, word.data(), count);
+        return false;
+      }
+      return true;
+    };
+
+    bool ok = true;
+    if (word == "aim" && (ok = expect(0))) {
+      op.op = PATTERN_OP_AIM;
+    } else if (word == "angle" && (ok = expect(1))) {
+      op.op = PATTERN_OP_ANGLE;
+      op.value = arg1 * PATTERN_FIXED;
+    } else if (word == "turn" && (ok = expect(1))) {
+      op.op = PATTERN_OP_TURN;
+      op.value = arg1 * PATTERN_FIXED;
+    } else if (word == "speed" && (ok = expect(1))) {
+      op.op = PATTERN_OP_SPEED;
+      op.value = arg1 * PATTERN_FIXED;
+    } else if (word == "fire" && (ok = expect(0))) {
+      op.op = PATTERN_OP_FIRE;
+    } else if (word == "fan" && (ok = expect(2))) {
+      op.op = PATTERN_OP_FAN;
+      op.count = arg1;
+      op.value = arg2 * PATTERN_FIXED;
+    } else if (word == "ring" && (ok = expect(1))) {
+      op.op = PATTERN_OP_RING;
+      op.count = arg1;
+    } else if (word == "wait" && args == -1) {
+      op.op = PATTERN_OP_WAIT_RATE;
+    } else if (word == "wait" && (ok = expect(1))) {
+      op.op = PATTERN_OP_WAIT;
+      op.value = arg1;
+    } else if (word == "repeat" && (ok = expect(1))) {
+      op.op = PATTERN_OP_REPEAT;
+      op.value = arg1;
+      repeats.push_back(out.size());
+      if (repeats.size() > PATTERN_MAX_DEPTH) {
+        TraceLog(LOG_WARNING, "PATTERN: [%s:%d] repeats nest deeper than %d", name.data(),
+                 line_number, PATTERN_MAX_DEPTH);
+        ok = false;
+      }
+    } else if (word == "end" && (ok = expect(0))) {
+      if (repeats.empty()) {
+        TraceLog(LOG_WARNING, "PATTERN: [%s:%d] end without repeat", name.data(), line_number);
+        ok = false;
+      }
+      op.op = PATTERN_OP_END;
+      if (ok) {
+        repeats.pop_back();
+      }
+    } else if (word == "reload" && (ok = expect(0))) {
+      op.op = PATTERN_OP_RELOAD;
+    } else if (ok) {
+      TraceLog(LOG_WARNING, "PATTERN: [%s:%d] unknown instruction '%s'", name.data(), line_number,
+               word.data());
+      ok = false;
+    }
+
+    // counts live in a byte, a repeat of 0 would wrap its counter
+    bool counted = op.op == PATTERN_OP_FAN || op.op == PATTERN_OP_RING;
+    if (ok && ((counted && (arg1 < 1 || arg1 > UINT8_MAX)) ||
+               (op.op == PATTERN_OP_REPEAT && (arg1 < 1 || arg1 > INT16_MAX)))) {
+      TraceLog(LOG_WARNING, "PATTERN: [%s:%d] '%s' count out of range", name.data(), line_number,
+               word.data());
+      ok = false;
+    }
+
+    if (!ok) {
+      return false;
+    }
+    out.push_back(op);
+  }
+
+  if (!repeats.empty()) {
+    TraceLog(LOG_WARNING, "PATTERN: [%s] repeat without end", name.data());
+    return false;
+  }
+  if (out.empty() || out.size() > UINT16_MAX) {
+    TraceLog(LOG_WARNING, "PATTERN: [%s] empty or too long", name.data());
+    return false;
+  }
+
+  code = out;
+  return true;
+}
+
+// Loads patterns in order, a pattern's index in names is its id for emitters
+inline PatternLibrary load_pattern_library(std::vector<std::string> names) {
+  PatternLibrary library;
+  for (auto &name : names) {
+    Pattern pattern = {name, GetFileModTime(get_real_path(pattern_path(name)).data()), 1, {}};
+    if (!compile_pattern(name, load_text_file(pattern_path(name)), pattern.code)) {
+      // an emitter on a broken pattern just waits
+      pattern.code = {{PATTERN_OP_WAIT, 0, 60}};
+    }
+    library.patterns.push_back(pattern);
+  }
+  return library;
+}
+
+// Recompiles patterns whose loose file changed, true if any did
+inline bool reload_changed_patterns(PatternLibrary &library) {
+  bool changed = false;
+  for (auto &pattern : library.patterns) {
+    std::string path = get_real_path(pattern_path(pattern.name));
+    long mod_time = GetFileModTime(path.data());
+    if (mod_time == pattern.mod_time) {
+      continue;
+    }
+
+    pattern.mod_time = mod_time;
+    char *source = LoadFileText(path.data());
+    if (source && compile_pattern(pattern.name, source, pattern.code)) {
+      pattern.version += 1;
+      changed = true;
+      TraceLog(LOG_INFO, "PATTERN: [%s] Reloaded", pattern.name.data());
+    }
+    if (source) {
+      UnloadFileText((unsigned char *)source);
+    }
+  }
+  return changed;
+}
+
+inline PatternEmitter create_emitter(int pattern, int rate, float speed) {
+  PatternEmitter emitter = {};
+  emitter.pattern = pattern;
+  emitter.rate = rate;
+  emitter.speed = to_fixed(speed);
+  return emitter;
+}
+
+inline fixed pattern_aim(Vector2 origin, Vector2 target) {
+#ifdef BOMAQS_FIXED_SIM
+  return fixed_atan2(to_fixed(target.y - origin.y), to_fixed(target.x - origin.x));
+#else
+  return to_fixed(atan2f(target.y - origin.y, target.x - origin.x));
+#endif
+}
+
+inline Vector2 pattern_velocity(fixed angle, fixed speed) {
+#ifdef BOMAQS_FIXED_SIM
+  fixed sine, cosine;
+  fixed_sincos(angle, sine, cosine);
+  return {fixed_to_float(fixed_mul(cosine, speed)), fixed_to_float(fixed_mul(sine, speed))};
+#else
+  float radians = fixed_to_float(angle);
+  return {cosf(radians) * fixed_to_float(speed), sinf(radians) * fixed_to_float(speed)};
+#endif
+}
+
+// Runs one tick of an emitter at origin aiming at target. emit(position, velocity) is called for
+// every bullet fired. Returns PATTERN_* signals.
+template <typename Emit>
+inline int step_emitter(const PatternLibrary &library, PatternEmitter &emitter, Vector2 origin,
+                        Vector2 target, Emit &&emit) {
+  if (emitter.pattern >= library.patterns.size()) {
+    return 0;
+  }
+  const Pattern &pattern = library.patterns[emitter.pattern];
+  if (emitter.version != pattern.version) {
+    emitter.version = pattern.version;
+    emitter.pc = 0;
+    emitter.wait = 0;
+    emitter.depth = 0;
+  }
+
+  if (emitter.wait > 0) {
+    emitter.wait -= 1;
+    return 0;
+  }
+
+  auto fire = [&](fixed angle) { emit(origin, pattern_velocity(angle, emitter.speed)); };
+
+  int signals = 0;
+  const PatternOp *code = pattern.code.data();
+  int size = pattern.code.size();
+  for (int budget = PATTERN_OPS_PER_TICK; budget > 0; budget--) {
+    if (emitter.pc >= size) {
+      emitter.pc = 0;
+      emitter.depth = 0;
+    }
+
+    PatternOp op = code[emitter.pc++];
+    switch (op.op) {
+      case PATTERN_OP_AIM:
+        emitter.angle = pattern_aim(origin, target);
+        break;
+      case PATTERN_OP_ANGLE:
+        emitter.angle = fixed_wrap_angle(fixed_degrees(op.value, PATTERN_FIXED));
+        break;
+      case PATTERN_OP_TURN:
+        emitter.angle = fixed_wrap_angle(emitter.angle + fixed_degrees(op.value, PATTERN_FIXED));
+        break;
+      case PATTERN_OP_SPEED:
+        emitter.speed = op.value * (FIXED_ONE / PATTERN_FIXED);
+        break;
+      case PATTERN_OP_FIRE:
+        fire(emitter.angle);
+        break;
+      case PATTERN_OP_FAN: {
+        fixed spread = fixed_degrees(op.value, PATTERN_FIXED);
+        fixed step = op.count > 1 ? spread / (op.count - 1) : 0;
+        fixed start = emitter.angle - (op.count > 1 ? spread / 2 : 0);
+        for (int i = 0; i < op.count; i++) {
+          fire(start + (step * i));
+        }
+        break;
+      }
+      case PATTERN_OP_RING:
+        for (int i = 0; i < op.count; i++) {
+          fire(emitter.angle + (FIXED_TWO_PI * i / op.count));
+        }
+        break;
+      case PATTERN_OP_WAIT:
+      case PATTERN_OP_WAIT_RATE: {
+        int ticks = op.op == PATTERN_OP_WAIT ? op.value : emitter.rate;
+        if (ticks > 0) {
+          emitter.wait = ticks - 1;
+          return signals;
+        }
+        break;
+      }
+      case PATTERN_OP_REPEAT:
+        emitter.loop_start[emitter.depth] = emitter.pc;
+        emitter.loop_left[emitter.depth] = op.value;
+        emitter.depth += 1;
+        break;
+      case PATTERN_OP_END:
+        if (--emitter.loop_left[emitter.depth - 1] > 0) {
+          emitter.pc = emitter.loop_start[emitter.depth - 1];
+        } else {
+          emitter.depth -= 1;
+        }
+        break;
+      case PATTERN_OP_RELOAD:
+        return signals | PATTERN_RELOAD;
+    }
+  }
+
+  return signals;
+}
+
+// Steps a batch of emitters, origins and targets are parallel arrays
+template <typename Emit>
+inline void step_emitters(const PatternLibrary &library, PatternEmitter *emitters,
+                          const Vector2 *origins, const Vector2 *targets, int count, Emit &&emit) {
+  for (int i = 0; i < count; i++) {
+    step_emitter(library, emitters[i], origins[i], targets[i], emit);
+  }
+}
+}  // namespace bomaqs
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cmath>
+
+// Continuous collision queries. Each sweep tests a shape moving from start to end against another
+// shape and reports the time of impact as a fraction of the move in [0, 1], so fast movers or large
+// frame deltas can't tunnel through thin targets. Shapes that already overlap hit at time 0.
+
+namespace bomaqs {
+
+// Segment origin -> origin + delta against a rectangle (slab test)
+inline bool sweep_point_rec(Vector2 origin, Vector2 delta, Rectangle rec, float *toi) {
+  float t_enter = 0.0f;
+  float t_exit = 1.0f;
+  float origins[2] = {origin.x, origin.y};
+  float deltas[2] = {delta.x, delta.y};
+  float mins[2] = {rec.x, rec.y};
+  float maxs[2] = {rec.x + rec.width, rec.y + rec.height};
+
+  for (int axis = 0; axis < 2; axis++) {
+    if (deltas[axis] == 0) {
+      // parallel to this slab, must already be inside it
+      if (origins[axis] < mins[axis] || origins[axis] > maxs[axis]) {
+        return false;
+      }
+      continue;
+    }
+
+    float t1 = (mins[axis] - origins[axis]) / deltas[axis];
+    float t2 = (maxs[axis] - origins[axis]) / deltas[axis];
+    if (t1 > t2) {
+      float swap = t1;
+      t1 = t2;
+      t2 = swap;
+    }
+    t_enter = fmaxf(t_enter, t1);
+    t_exit = fminf(t_exit, t2);
+    if (t_enter > t_exit) {
+      return false;
+    }
+  }
+
+  if (toi) {
+    *toi = t_enter;
+  }
+  return true;
+}
+
+// Segment origin -> origin + delta against a circle
+inline bool sweep_point_circle(Vector2 origin, Vector2 delta, Vector2 center, float radius,
+                               float *toi) {
+  float mx = origin.x - center.x;
+  float my = origin.y - center.y;
+  float c = (mx * mx) + (my * my) - (radius * radius);
+  if (c <= 0) {
+    if (toi) {
+      *toi = 0;
+    }
+    return true;
+  }
+
+  float a = (delta.x * delta.x) + (delta.y * delta.y);
+  float b = (mx * delta.x) + (my * delta.y);
+  // not moving, or moving away
+  if (a == 0 || b > 0) {
+    return false;
+  }
+
+  float discriminant = (b * b) - (a * c);
+  if (discriminant < 0) {
+    return false;
+  }
+
+  float t = (-b - sqrtf(discriminant)) / a;
+  if (t > 1.0f) {
+    return false;
+  }
+
+  if (toi) {
+    *toi = fmaxf(t, 0.0f);
+  }
+  return true;
+}
+
+// Two moving circles, tested as one point against the summed radius in the frame of circle 2
+inline bool sweep_circles(Vector2 start1, Vector2 end1, float radius1, Vector2 start2,
+                          Vector2 end2, float radius2, float *toi) {
+  Vector2 delta = {(end1.x - start1.x) - (end2.x - start2.x),
+                   (end1.y - start1.y) - (end2.y - start2.y)};
+  return sweep_point_circle(start1, delta, start2, radius1 + radius2, toi);
+}
+
+// Moving circle against a static rectangle. The rectangle is grown by the radius with rounded
+// corners, the corners are tested as circles so diagonal misses aren't reported as hits.
+inline bool sweep_circle_rec(Vector2 start, Vector2 end, float radius, Rectangle rec, float *toi) {
+  Vector2 delta = {end.x - start.x, end.y - start.y};
+  Rectangle expanded = {rec.x - radius, rec.y - radius, rec.width + (radius * 2),
+                        rec.height + (radius * 2)};
+
+  float t;
+  if (!sweep_point_rec(start, delta, expanded, &t)) {
+    return false;
+  }
+
+  Vector2 hit = {start.x + (delta.x * t), start.y + (delta.y * t)};
+  bool outside_x = hit.x < rec.x || hit.x > rec.x + rec.width;
+  bool outside_y = hit.y < rec.y || hit.y > rec.y + rec.height;
+
+  if (outside_x && outside_y) {
+    Vector2 corner = {hit.x < rec.x ? rec.x : rec.x + rec.width,
+                      hit.y < rec.y ? rec.y : rec.y + rec.height};
+    return sweep_point_circle(start, delta, corner, radius, toi);
+  }
+
+  if (toi) {
+    *toi = t;
+  }
+  return true;
+}
+
+// Rectangle moved by delta against a static rectangle (Minkowski sum)
+inline bool sweep_recs(Rectangle rec, Vector2 delta, Rectangle other, float *toi) {
+  Rectangle expanded = {other.x - rec.width, other.y - rec.height, other.width + rec.width,
+                        other.height + rec.height};
+  return sweep_point_rec({rec.x, rec.y}, delta, expanded, toi);
+}
+}  // namespace bomaqs
@@ -1,9 +1,13 @@
+#pragma once
+
 #include <raylib.h>
 
 #include <cstring>
 #include <iostream>
 #include <map>
 
+#include "asset-bundle.hpp"
+
 #define ASSET_BASE_DIR "resources/";
 
 namespace bomaqs {
@@ -11,34 +15,98 @@ namespace bomaqs {
 typedef std::vector<std::string> word_list;
 typedef std::map<int, word_list> word_dict;
 
-std::string get_real_path(std::string path) {
+// Bundle mounted with mount_bundle, loaders below read from it first and fall back to loose files
+inline AssetBundle asset_bundle;
+
+// Contents of an asset file, a span into the bundle when packed there, otherwise read from disk
+typedef struct {
+  FileSpan span;
+  unsigned char* owned;
+} AssetFile;
+
+inline std::string get_real_path(std::string path) {
   std::string out = ASSET_BASE_DIR;
   return out.append(path);
 }
 
-std::string load_text_file(std::string file) {
-  std::string contents = LoadFileText(get_real_path(file).data());
+inline bool mount_bundle(std::string file) {
+  return open_bundle(asset_bundle, get_real_path(file).data());
+}
+
+inline void unmount_bundle() { close_bundle(asset_bundle); }
+
+inline AssetFile load_asset_file(std::string file) {
+  AssetFile out = {read_bundle_entry(asset_bundle, file.data()), NULL};
+  if (!out.span.data) {
+    out.owned = LoadFileData(get_real_path(file).data(), &out.span.size);
+    out.span.data = out.owned;
+  }
+  return out;
+}
+
+inline void unload_asset_file(AssetFile& file) {
+  if (file.owned) {
+    UnloadFileData(file.owned);
+  }
+  file = {{NULL, 0}, NULL};
+}
+
+inline std::string load_text_file(std::string file) {
+  FileSpan span = read_bundle_entry(asset_bundle, file.data());
+  if (span.data) {
+    return std::string((const char*)span.data, span.size);
+  }
+
+  char* text = LoadFileText(get_real_path(file).data());
+  if (!text) {
+    return "";
+  }
+  std::string contents = text;
+  UnloadFileText((unsigned char*)text);
   return contents;
 }
 
-Sound load_sound(std::string file) {
-  return LoadSound(get_real_path(file).data());
+// CPU side decoders, safe to call off the GL thread
+inline Image decode_image(std::string file) {
+  FileSpan span = read_bundle_entry(asset_bundle, file.data());
+  if (span.data) {
+    return LoadImageFromMemory(GetFileExtension(file.data()), span.data, span.size);
+  }
+  return LoadImage(get_real_path(file).data());
+}
+
+inline Wave decode_wave(std::string file) {
+  FileSpan span = read_bundle_entry(asset_bundle, file.data());
+  if (span.data) {
+    return LoadWaveFromMemory(GetFileExtension(file.data()), span.data, span.size);
+  }
+  return LoadWave(get_real_path(file).data());
+}
+
+inline Sound load_sound(std::string file) {
+  Wave wave = decode_wave(file);
+  Sound sound = LoadSoundFromWave(wave);
+  UnloadWave(wave);
+  return sound;
 }
 
-Music load_music(std::string file) {
+// Music is streamed from its file while playing, so it is never packed into the bundle
+inline Music load_music(std::string file) {
   return LoadMusicStream(get_real_path(file).data());
 }
 
-Texture2D load_texture(std::string file) {
-  return LoadTexture(get_real_path(file).data());
+inline Texture2D load_texture(std::string file) {
+  Image image = decode_image(file);
+  Texture2D texture = LoadTextureFromImage(image);
+  UnloadImage(image);
+  return texture;
 }
 
-Font load_sdf_font(std::string font_name, int base_size = 16,
-                   int char_count = 95) {
+inline Font load_sdf_font(std::string font_name, int base_size = 16, int char_count = 95) {
   // Loading file to memory
-  unsigned int fileSize = 0;
-  unsigned char* fileData =
-      LoadFileData(get_real_path(font_name).data(), &fileSize);
+  AssetFile file = load_asset_file(font_name);
+  const unsigned char* fileData = file.span.data;
+  unsigned int fileSize = file.span.size;
 
   // SDF font generation from TTF font
   Font fontSDF = {0};
@@ -55,16 +123,19 @@ Font load_sdf_font(std::string font_name, int base_size = 16,
   fontSDF.texture = LoadTextureFromImage(atlas);
   UnloadImage(atlas);
 
-  UnloadFileData(fileData);  // Free memory from loaded file
+  unload_asset_file(file);  // Free memory from loaded file
 
   return fontSDF;
 }
 
-Font load_font(std::string font_name, int base_size = 16, int char_count = 95) {
+// CPU side of load_font, rasterizes glyphs into atlas without touching the GPU so it can run on a
+// worker thread. Upload the atlas with LoadTextureFromImage and unload it afterwards.
+inline Font decode_font(std::string font_name, Image* atlas, int base_size = 16,
+                        int char_count = 95) {
   // Loading file to memory
-  unsigned int fileSize = 0;
-  unsigned char* fileData =
-      LoadFileData(get_real_path(font_name).data(), &fileSize);
+  AssetFile file = load_asset_file(font_name);
+  const unsigned char* fileData = file.span.data;
+  unsigned int fileSize = file.span.size;
 
   // SDF font generation from TTF font
   Font font = {0};
@@ -77,17 +148,24 @@ Font load_font(std::string font_name, int base_size = 16, int char_count = 95) {
       LoadFontData(fileData, fileSize, base_size, 0, char_count, FONT_DEFAULT);
   // Parameters > chars count: 95, font size: 16, chars padding in image: 0 px,
   // pack method: 1 (Skyline algorithm)
-  Image atlas =
+  *atlas =
       GenImageFontAtlas(font.chars, &font.recs, char_count, base_size, 4, 0);
+
+  unload_asset_file(file);  // Free memory from loaded file
+
+  return font;
+}
+
+inline Font load_font(std::string font_name, int base_size = 16, int char_count = 95) {
+  Image atlas = {0};
+  Font font = decode_font(font_name, &atlas, base_size, char_count);
   font.texture = LoadTextureFromImage(atlas);
   UnloadImage(atlas);
 
-  UnloadFileData(fileData);  // Free memory from loaded file
-
   return font;
 }
 
-std::map<int, word_list> load_word_dictionary(std::string file) {
+inline std::map<int, word_list> load_word_dictionary(std::string file) {
   std::map<int, word_list> dictionary;
   std::string contents = load_text_file(file);
 
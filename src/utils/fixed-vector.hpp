@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstring>
+#include <type_traits>
+
+// Vector with inline storage and a fixed capacity. Trivially copyable when T is, so worlds built
+// from these copy with a memcpy: no heap, no pointers to fix up, safe to snapshot into rings or
+// send between threads. push_back past the capacity is dropped and returns false.
+
+namespace bomaqs {
+
+template <typename T, int Capacity>
+struct FixedVector {
+  T items[Capacity];
+  int count;
+
+  int size() const { return count; }
+  bool empty() const { return count == 0; }
+  bool full() const { return count == Capacity; }
+  void clear() { count = 0; }
+
+  T *begin() { return items; }
+  T *end() { return items + count; }
+  const T *begin() const { return items; }
+  const T *end() const { return items + count; }
+  T &operator[](int index) { return items[index]; }
+  const T &operator[](int index) const { return items[index]; }
+
+  bool push_back(const T &item) {
+    if (count == Capacity) {
+      return false;
+    }
+    items[count++] = item;
+    return true;
+  }
+
+  // Keeps order, O(n)
+  void erase_at(int index) {
+    memmove(&items[index], &items[index + 1], sizeof(T) * (count - index - 1));
+    count -= 1;
+  }
+
+  // Keeps the items keep(item) is true for, in order
+  template <typename Keep>
+  void retain(Keep keep) {
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+      if (keep(items[i])) {
+        items[kept++] = items[i];
+      }
+    }
+    count = kept;
+  }
+
+  static_assert(std::is_trivially_copyable<T>::value, "items are moved with memmove");
+};
+}  // namespace bomaqs
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cmath>
+#include <cstdint>
+
+// Q16.16 fixed point for simulations that must match bit for bit across platforms. Everything here
+// is integer math: a digit by digit square root and CORDIC for sin, cos and atan2, so no result
+// depends on the platform's libm.
+//
+// Simulations built with BOMAQS_FIXED_SIM (FIXED_SIM=TRUE for make, -DBOMAQS_FIXED_SIM=ON for
+// cmake) route their trig, square roots and directions through here, and are compiled with float
+// contraction off so the float adds and compares left over round the same everywhere.
+//
+// Conversions from float round to nearest, conversions to float are exact up to 256 and correctly
+// rounded beyond that.
+
+#if defined(BOMAQS_FIXED_SIM) && defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT)
+#define FIXED_PI 205887
+#define FIXED_HALF_PI 102944
+#define FIXED_TWO_PI 411775
+#define FIXED_CORDIC_STEPS 17
+#define FIXED_CORDIC_GAIN 39797  // 1 / prod(sqrt(1 + 2^-2i)), preloaded so sincos needs no scaling
+
+namespace bomaqs {
+
+typedef int32_t fixed;
+
+// atan(2^-i)
+inline const fixed fixed_cordic_angles[FIXED_CORDIC_STEPS] = {
+    51472, 30386, 16055, 8150, 4091, 2047, 1024, 512, 256, 128, 64, 32, 16, 8, 4, 2, 1};
+
+inline fixed to_fixed(float value) { return (fixed)lroundf(value * FIXED_ONE); }
+inline fixed int_to_fixed(int value) { return value * FIXED_ONE; }
+inline float fixed_to_float(fixed value) { return (float)value / FIXED_ONE; }
+
+inline fixed fixed_mul(fixed a, fixed b) { return (fixed)(((int64_t)a * b) >> FIXED_SHIFT); }
+inline fixed fixed_div(fixed a, fixed b) { return (fixed)(((int64_t)a * FIXED_ONE) / b); }
+
+// Rounded down
+inline uint32_t integer_sqrt(uint64_t value) {
+  uint64_t root = 0;
+  uint64_t bit = 1ULL << 62;
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return (uint32_t)root;
+}
+
+inline fixed fixed_sqrt(fixed value) {
+  return value <= 0 ? 0 : integer_sqrt((uint64_t)value << FIXED_SHIFT);
+}
+
+// Squares are summed in Q32.32, so long vectors don't overflow and short ones keep their precision
+inline fixed fixed_length(fixed x, fixed y) {
+  return integer_sqrt((uint64_t)((int64_t)x * x) + (uint64_t)((int64_t)y * y));
+}
+
+// Into [-pi, pi)
+inline fixed fixed_wrap_angle(fixed angle) {
+  angle %= FIXED_TWO_PI;
+  if (angle >= FIXED_PI) {
+    angle -= FIXED_TWO_PI;
+  } else if (angle < -FIXED_PI) {
+    angle += FIXED_TWO_PI;
+  }
+  return angle;
+}
+
+// CORDIC in rotation mode, good to about 1e-4
+inline void fixed_sincos(fixed angle, fixed &sin_out, fixed &cos_out) {
+  // CORDIC converges within about +-1.74 rad, fold the back half onto the front
+  fixed z = fixed_wrap_angle(angle);
+  bool flip = false;
+  if (z > FIXED_HALF_PI) {
+    z -= FIXED_PI;
+    flip = true;
+  } else if (z < -FIXED_HALF_PI) {
+    z += FIXED_PI;
+    flip = true;
+  }
+
+  int64_t x = FIXED_CORDIC_GAIN, y = 0;
+  for (int i = 0; i < FIXED_CORDIC_STEPS; i++) {
+    int64_t dx = x >> i, dy = y >> i;
+    if (z >= 0) {
+      x -= dy;
+      y += dx;
+      z -= fixed_cordic_angles[i];
+    } else {
+      x += dy;
+      y -= dx;
+      z += fixed_cordic_angles[i];
+    }
+  }
+  sin_out = (fixed)(flip ? -y : y);
+  cos_out = (fixed)(flip ? -x : x);
+}
+
+// CORDIC in vectoring mode, in [-pi, pi], 0 for (0, 0) like atan2
+inline fixed fixed_atan2(fixed y, fixed x) {
+  if (x == 0 && y == 0) {
+    return 0;
+  }
+
+  // Left half plane is rotated by pi onto the right one. Inputs are scaled up so small vectors
+  // still have bits to shift away.
+  int64_t vx = (int64_t)x << FIXED_SHIFT, vy = (int64_t)y << FIXED_SHIFT;
+  fixed z = 0;
+  if (vx < 0) {
+    vx = -vx;
+    vy = -vy;
+    z = y >= 0 ? FIXED_PI : -FIXED_PI;
+  }
+
+  for (int i = 0; i < FIXED_CORDIC_STEPS; i++) {
+    int64_t dx = vx >> i, dy = vy >> i;
+    if (vy > 0) {
+      vx += dy;
+      vy -= dx;
+      z += fixed_cordic_angles[i];
+    } else {
+      vx -= dy;
+      vy += dx;
+      z -= fixed_cordic_angles[i];
+    }
+  }
+  return z;
+}
+
+inline fixed fixed_degrees(int degrees, int scale = 1) {
+  return (fixed)((int64_t)degrees * FIXED_PI / (180 * scale));
+}
+
+// Velocity of length speed from from towards to, (speed, 0) when they're the same point. Normalized
+// with the square root rather than through an angle, so it's exact to the last bit of fixed.
+inline Vector2 fixed_direction(Vector2 from, Vector2 to, fixed speed) {
+  fixed dx = to_fixed(to.x - from.x);
+  fixed dy = to_fixed(to.y - from.y);
+  fixed length = fixed_length(dx, dy);
+  if (length == 0) {
+    return {fixed_to_float(speed), 0};
+  }
+  return {fixed_to_float((fixed)((int64_t)dx * speed / length)),
+          fixed_to_float((fixed)((int64_t)dy * speed / length))};
+}
+
+inline fixed fixed_distance(Vector2 a, Vector2 b) {
+  return fixed_length(to_fixed(b.x - a.x), to_fixed(b.y - a.y));
+}
+}  // namespace bomaqs
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <thread>
+
+#include "input-queue.hpp"
+
+#if defined(PLATFORM_WEB)
+#include <emscripten/emscripten.h>
+#endif
+
+// Frame pacing with idle redraw skipping. The scene is drawn into a cached render texture only when
+// something is dirty (input, animation, a visible timer). Idle frames run at a lower rate and,
+// where input comes through the hooked input queue, don't draw or swap at all: the window keeps
+// showing the last presented frame and the frame only polls events. Queued input or window damage
+// makes the next frame a full one again, which also lets raylib roll its key states over. Platforms
+// that poll input through raylib (Android) still present the cache on idle frames. Waiting sleeps
+// for most of the frame and spins the last PACER_SPIN_SECONDS, instead of raylib's SetTargetFPS
+// busy loop. Every minute the process CPU time is logged so battery impact can be compared between
+// builds.
+//
+// Idle frames skip BeginDrawing/EndDrawing, so raylib's frame clock stops with them and the next
+// full frame's GetFrameTime() spans the whole idle stretch. Games read pacer.frame_time instead,
+// the time between the starts of this frame and the last one, drawn or not.
+//
+//   if (bomaqs::begin_scene(pacer)) {
+//     ... draw the scene ...
+//   }
+//   bomaqs::present_scene(pacer);
+//   bomaqs::wait_next_frame(pacer);
+
+#define PACER_IDLE_FPS 20  // keeps input polling and the music feed alive while idle
+#define PACER_SPIN_SECONDS 0.002
+
+namespace bomaqs {
+
+typedef struct {
+  int target_fps;
+  int idle_fps;
+  double next_frame;
+  bool dirty;
+  bool scene_valid;
+  bool drawing_scene;
+  RenderTexture2D scene;
+  unsigned int input_seen;  // input queue write position at the last begin_scene
+  double frame_start;
+  float frame_time;  // seconds since the last frame started, replaces GetFrameTime()
+
+  // stats for the current minute
+  double minute_start;
+  std::clock_t minute_cpu_start;
+  unsigned int redraws;
+  unsigned int idle_frames;
+  double cpu_seconds_per_minute;  // last full minute
+} FramePacer;
+
+// Set by the window system when the window's contents were lost and have to be presented again
+inline bool pacer_window_damaged = false;
+
+#if !defined(INPUT_QUEUE_POLLING)
+inline void pacer_window_refresh_callback(GLFWwindow *) { pacer_window_damaged = true; }
+#endif
+
+inline double pacer_now() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(now).count();
+}
+
+// Sleeps until deadline, spinning for the tail to absorb OS sleep overshoot
+inline void wait_until(double deadline) {
+  double remaining = deadline - pacer_now();
+#if defined(PLATFORM_WEB)
+  // yield to the browser, spinning would block the page
+  if (remaining > 0) {
+    emscripten_sleep((unsigned int)(remaining * 1000));
+  }
+#else
+  if (remaining > PACER_SPIN_SECONDS) {
+    std::this_thread::sleep_for(std::chrono::duration<double>(remaining - PACER_SPIN_SECONDS));
+  }
+  while (pacer_now() < deadline) {
+    std::this_thread::yield();
+  }
+#endif
+}
+
+// Call after InitWindow, takes over from SetTargetFPS
+inline void init_frame_pacer(FramePacer &pacer, int target_fps, int idle_fps = PACER_IDLE_FPS) {
+  pacer.target_fps = target_fps;
+  pacer.idle_fps = idle_fps;
+  pacer.next_frame = pacer_now();
+  pacer.dirty = true;
+  pacer.scene_valid = false;
+  pacer.drawing_scene = false;
+  pacer.scene = LoadRenderTexture(GetScreenWidth(), GetScreenHeight());
+  pacer.input_seen = input_queue.write;
+  pacer.frame_start = pacer.next_frame;
+  pacer.frame_time = 1.0f / target_fps;
+#if !defined(INPUT_QUEUE_POLLING)
+  if (GLFWwindow *window = glfwGetCurrentContext()) {
+    glfwSetWindowRefreshCallback(window, pacer_window_refresh_callback);
+  }
+#endif
+
+  pacer.minute_start = pacer.next_frame;
+  pacer.minute_cpu_start = std::clock();
+  pacer.redraws = 0;
+  pacer.idle_frames = 0;
+  pacer.cpu_seconds_per_minute = 0;
+
+  SetTargetFPS(0);
+}
+
+inline void unload_frame_pacer(FramePacer &pacer) { UnloadRenderTexture(pacer.scene); }
+
+// Something visible changed, the next frame redraws at full rate
+inline void mark_frame_dirty(FramePacer &pacer) { pacer.dirty = true; }
+
+inline bool input_activity() {
+  return GetGestureDetected() != GESTURE_NONE || GetTouchPointsCount() > 0 ||
+         IsMouseButtonDown(MOUSE_LEFT_BUTTON);
+}
+
+// Returns true when the scene has to be redrawn, draw it before calling present_scene
+inline bool begin_scene(FramePacer &pacer) {
+  bool input_queued = input_queue.write != pacer.input_seen;
+  pacer.input_seen = input_queue.write;
+  pacer.dirty = pacer.dirty || !pacer.scene_valid || input_activity() || input_queued ||
+                pacer_window_damaged;
+  pacer.drawing_scene = pacer.dirty;
+  pacer_window_damaged = false;
+
+  if (pacer.drawing_scene) {
+    BeginTextureMode(pacer.scene);
+  }
+  return pacer.drawing_scene;
+}
+
+// Presents the cached scene when it was redrawn, idle frames only poll events where they can
+inline void present_scene(FramePacer &pacer) {
+  if (pacer.drawing_scene) {
+    EndTextureMode();
+    pacer.scene_valid = true;
+    pacer.redraws += 1;
+  } else {
+    pacer.idle_frames += 1;
+#if !defined(INPUT_QUEUE_POLLING)
+    if (input_queue.hooked) {
+      glfwPollEvents();
+      return;
+    }
+#endif
+  }
+
+  BeginDrawing();
+  // render textures are stored upside down
+  Texture2D texture = pacer.scene.texture;
+  DrawTextureRec(texture, (Rectangle){0, 0, (float)texture.width, (float)-texture.height},
+                 (Vector2){0, 0}, WHITE);
+  EndDrawing();
+}
+
+// Waits for the next frame, at idle rate if nothing was redrawn
+inline void wait_next_frame(FramePacer &pacer) {
+  int fps = pacer.drawing_scene ? pacer.target_fps : pacer.idle_fps;
+  pacer.dirty = false;
+
+  // don't try to catch up after a hitch, just pace from now
+  double now = pacer_now();
+  pacer.next_frame = std::max(pacer.next_frame + (1.0 / fps), now);
+  wait_until(pacer.next_frame);
+  double frame_start = pacer_now();
+  pacer.frame_time = (float)(frame_start - pacer.frame_start);
+  pacer.frame_start = frame_start;
+
+  double elapsed = now - pacer.minute_start;
+  if (elapsed >= 60) {
+    double cpu_seconds = (double)(std::clock() - pacer.minute_cpu_start) / CLOCKS_PER_SEC;
+    pacer.cpu_seconds_per_minute = cpu_seconds / (elapsed / 60);
+    TraceLog(LOG_INFO, "PACER: %.2fs CPU per minute, %u redraws, %u idle frames",
+             pacer.cpu_seconds_per_minute, pacer.redraws, pacer.idle_frames);
+    pacer.minute_start = now;
+    pacer.minute_cpu_start = std::clock();
+    pacer.redraws = 0;
+    pacer.idle_frames = 0;
+  }
+}
+}  // namespace bomaqs
@@ -0,0 +1,184 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <chrono>
+
+#if defined(PLATFORM_ANDROID) || defined(PLATFORM_RPI) || defined(PLATFORM_DRM)
+#define INPUT_QUEUE_POLLING
+#else
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+#endif
+
+#if defined(PLATFORM_WEB)
+#include <emscripten/html5.h>
+#endif
+
+// Input events: every press, release and key in the order they happened, with when and where.
+// Polling GetGestureDetected or GetKeyPressed once a frame sees at most one input per frame: two
+// taps within a frame collapse into one, a quick second tap comes out as a double tap, and every
+// input is timed to the frame it was noticed in. Games drain this queue instead, each event once,
+// in order, and consume them in the tick that runs next.
+//
+// Desktop and web builds chain onto raylib's GLFW callbacks (web adds canvas touch listeners next
+// to raylib's own), so events are queued the moment the platform delivers them and stamped with
+// input_now(). Platforms without GLFW (Android) fall back to poll_input_events reading raylib's
+// state once a frame: presses from the tap gestures, keys from GetKeyPressed's queue, no releases.
+//
+// Callbacks run on the main thread inside raylib's event polling, same as the games. Tests and
+// replays push_input_event synthetic events into a queue of their own and never init one.
+
+#define INPUT_QUEUE_CAPACITY 256  // events, power of two
+#define INPUT_TOUCH_MOUSE_GUARD 0.8  // s, mouse events a browser emulates after a touch are ignored
+
+namespace bomaqs {
+
+typedef enum { INPUT_PRESS = 0, INPUT_RELEASE, INPUT_KEY } InputEventType;
+
+typedef struct {
+  InputEventType type;
+  int code;          // raylib key for INPUT_KEY, mouse button or touch id for presses and releases
+  Vector2 position;  // screen position of presses and releases
+  double time;       // input_now() seconds
+} InputEvent;
+
+typedef struct {
+  InputEvent events[INPUT_QUEUE_CAPACITY];
+  unsigned int read;
+  unsigned int write;
+  unsigned int dropped;  // events lost to a full queue
+  bool hooked;           // platform callbacks fill it, poll_input_events has nothing to do
+  double last_touch;
+} InputQueue;
+
+// The queue platform callbacks fill
+inline InputQueue input_queue;
+
+// Same clock as the latency probe, so event stamps can be compared with it
+inline double input_now() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(now).count();
+}
+
+inline int input_event_count(const InputQueue &queue) { return queue.write - queue.read; }
+
+// False if the queue is full, the event is dropped and counted
+inline bool push_input_event(InputQueue &queue, const InputEvent &event) {
+  if (queue.write - queue.read == INPUT_QUEUE_CAPACITY) {
+    if (queue.dropped++ == 0) {
+      TraceLog(LOG_WARNING, "INPUT: Event queue full, dropping events");
+    }
+    return false;
+  }
+  queue.events[queue.write % INPUT_QUEUE_CAPACITY] = event;
+  queue.write += 1;
+  return true;
+}
+
+// Oldest event not consumed yet
+inline bool pop_input_event(InputQueue &queue, InputEvent *event) {
+  if (queue.read == queue.write) {
+    return false;
+  }
+  *event = queue.events[queue.read % INPUT_QUEUE_CAPACITY];
+  queue.read += 1;
+  return true;
+}
+
+// Drops what's queued, for screens that don't take input
+inline void clear_input_events(InputQueue &queue) { queue.read = queue.write; }
+
+#if !defined(INPUT_QUEUE_POLLING)
+inline InputQueue *hooked_input_queue;
+inline GLFWmousebuttonfun raylib_mouse_button_callback;
+inline GLFWkeyfun raylib_key_callback;
+
+inline void input_mouse_button_callback(GLFWwindow *window, int button, int action, int mods) {
+  double now = input_now();
+  InputQueue &queue = *hooked_input_queue;
+  if (now - queue.last_touch > INPUT_TOUCH_MOUSE_GUARD) {
+    double x = 0, y = 0;
+    glfwGetCursorPos(window, &x, &y);
+    push_input_event(queue, {action == GLFW_PRESS ? INPUT_PRESS : INPUT_RELEASE, button,
+                             {(float)x, (float)y}, now});
+  }
+  if (raylib_mouse_button_callback) {
+    raylib_mouse_button_callback(window, button, action, mods);
+  }
+}
+
+// Key repeats aren't presses, like raylib's GetKeyPressed
+inline void input_key_callback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+  if (action == GLFW_PRESS) {
+    push_input_event(*hooked_input_queue, {INPUT_KEY, key, {0, 0}, input_now()});
+  }
+  if (raylib_key_callback) {
+    raylib_key_callback(window, key, scancode, action, mods);
+  }
+}
+#endif
+
+#if defined(PLATFORM_WEB)
+// Touches land in CSS pixels of the canvas, raylib scales them to the screen the same way
+inline EM_BOOL input_touch_callback(int type, const EmscriptenTouchEvent *event, void *) {
+  double now = input_now();
+  InputQueue &queue = *hooked_input_queue;
+  double width = 0, height = 0;
+  emscripten_get_element_css_size("#canvas", &width, &height);
+  for (int i = 0; i < event->numTouches; i++) {
+    const EmscriptenTouchPoint &touch = event->touches[i];
+    if (!touch.isChanged || width <= 0 || height <= 0) {
+      continue;
+    }
+    Vector2 position = {(float)(touch.targetX * GetScreenWidth() / width),
+                        (float)(touch.targetY * GetScreenHeight() / height)};
+    push_input_event(queue, {type == EMSCRIPTEN_EVENT_TOUCHSTART ? INPUT_PRESS : INPUT_RELEASE,
+                             (int)touch.identifier, position, now});
+  }
+  queue.last_touch = now;
+  return EM_FALSE;  // raylib's own listener decides about the default action
+}
+#endif
+
+// Empties the queue and hooks it to the platform's input, after InitWindow
+inline void init_input_queue(InputQueue &queue) {
+  queue.read = 0;
+  queue.write = 0;
+  queue.dropped = 0;
+  queue.hooked = false;
+  queue.last_touch = -INPUT_TOUCH_MOUSE_GUARD;
+
+#if !defined(INPUT_QUEUE_POLLING)
+  GLFWwindow *window = glfwGetCurrentContext();  // raylib's, its context is current on this thread
+  if (!window) {
+    TraceLog(LOG_WARNING, "INPUT: No window to hook, polling input once a frame");
+    return;
+  }
+  hooked_input_queue = &queue;
+  raylib_mouse_button_callback = glfwSetMouseButtonCallback(window, input_mouse_button_callback);
+  raylib_key_callback = glfwSetKeyCallback(window, input_key_callback);
+  queue.hooked = true;
+#if defined(PLATFORM_WEB)
+  emscripten_set_touchstart_callback("#canvas", NULL, 1, input_touch_callback);
+  emscripten_set_touchend_callback("#canvas", NULL, 1, input_touch_callback);
+  emscripten_set_touchcancel_callback("#canvas", NULL, 1, input_touch_callback);
+#endif
+#endif
+}
+
+// Call once a frame before draining, queues what hooked platforms can't deliver as it happens
+inline void poll_input_events(InputQueue &queue) {
+  if (queue.hooked) {
+    return;
+  }
+  double now = input_now();
+  int gesture = GetGestureDetected();
+  if (gesture == GESTURE_TAP || gesture == GESTURE_DOUBLETAP) {
+    push_input_event(queue, {INPUT_PRESS, 0, GetTouchPosition(0), now});
+  }
+  for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) {
+    push_input_event(queue, {INPUT_KEY, key, {0, 0}, now});
+  }
+}
+}  // namespace bomaqs
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing job system. Every worker owns a deque, it pushes and pops its own jobs at the
+// back and steals from the front of the others when it runs dry. Threads that aren't workers (the
+// main thread, the simulation thread) share one extra deque. Jobs can hold off until a counter
+// reaches zero, and any thread waiting on a counter runs jobs meanwhile instead of blocking.
+//
+// Web builds without pthreads get no workers: jobs queue up and run on whichever thread waits for
+// them, so code written against the job system runs unchanged on one thread. With emscripten
+// pthreads std::thread maps to web workers, see WEB_PTHREADS in the Makefile.
+//
+//   bomaqs::JobCounter done = {};
+//   bomaqs::parallel_for(bomaqs::job_system, count, 64, [&](int begin, int end) { ... }, &done);
+//   bomaqs::wait_for_counter(bomaqs::job_system, &done);
+
+#if defined(PLATFORM_WEB) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define JOB_THREADS_MAX 0
+#else
+#define JOB_THREADS_MAX 8
+#endif
+
+namespace bomaqs {
+
+typedef struct {
+  std::atomic<int> pending;
+} JobCounter;
+
+typedef struct {
+  std::function<void()> run;
+  JobCounter *counter;  // decremented once the job has run
+  JobCounter *after;    // held back until this reaches zero
+} Job;
+
+typedef struct {
+  std::mutex mutex;
+  std::deque<Job> jobs;
+} JobQueue;
+
+typedef struct {
+  std::vector<std::unique_ptr<JobQueue>> queues;  // one per worker, the last one for other threads
+  std::vector<std::thread> workers;
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  std::atomic<int> queued;
+  std::atomic<bool> stopping;
+
+  std::mutex held_mutex;  // guards held
+  std::vector<Job> held;  // waiting on their after counter
+
+  std::atomic<unsigned long long> jobs_run;
+  std::atomic<unsigned long long> steals;
+} JobSystem;
+
+// Process wide job system, started by the game with init_job_system. Jobs scheduled before it's
+// started run inline.
+inline JobSystem job_system;
+
+// Queue owned by the calling thread
+inline int &job_queue_index() {
+  thread_local int index = -1;
+  return index;
+}
+
+inline JobQueue &own_job_queue(JobSystem &system) {
+  int index = job_queue_index();
+  return *system.queues[index >= 0 ? index : system.queues.size() - 1];
+}
+
+inline void enqueue_job(JobSystem &system, Job job) {
+  JobQueue &queue = own_job_queue(system);
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  system.queued += 1;
+
+  { std::lock_guard<std::mutex> lock(system.sleep_mutex); }
+  system.wake.notify_one();
+}
+
+// Moves held jobs whose dependency finished onto the queues
+inline void release_held_jobs(JobSystem &system) {
+  std::vector<Job> ready;
+  {
+    std::lock_guard<std::mutex> lock(system.held_mutex);
+    auto split = std::stable_partition(system.held.begin(), system.held.end(),
+                                       [](Job &job) { return job.after->pending > 0; });
+    std::move(split, system.held.end(), std::back_inserter(ready));
+    system.held.erase(split, system.held.end());
+  }
+  for (auto &job : ready) {
+    enqueue_job(system, std::move(job));
+  }
+}
+
+inline void finish_job(JobSystem &system, Job &job) {
+  system.jobs_run += 1;
+  if (job.counter && job.counter->pending.fetch_sub(1) == 1) {
+    release_held_jobs(system);
+  }
+}
+
+// Own queue first, newest job, then the oldest job of another queue
+inline bool pop_job(JobSystem &system, Job &job) {
+  if (system.queued.load() == 0) {
+    return false;
+  }
+
+  JobQueue &own = own_job_queue(system);
+  {
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.jobs.empty()) {
+      job = std::move(own.jobs.back());
+      own.jobs.pop_back();
+      system.queued -= 1;
+      return true;
+    }
+  }
+
+  int count = system.queues.size();
+  int start = std::max(job_queue_index(), 0);
+  for (int i = 1; i <= count; i++) {
+    JobQueue &victim = *system.queues[(start + i) % count];
+    if (&victim == &own) {
+      continue;
+    }
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      job = std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+      system.queued -= 1;
+      system.steals += 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Runs one queued job on the calling thread, false if there was nothing to run
+inline bool run_one_job(JobSystem &system) {
+  Job job;
+  if (!pop_job(system, job)) {
+    return false;
+  }
+  job.run();
+  finish_job(system, job);
+  return true;
+}
+
+inline void run_job_worker(JobSystem *system, int index) {
+  job_queue_index() = index;
+  while (!system->stopping) {
+    if (run_one_job(*system)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(system->sleep_mutex);
+    system->wake.wait(lock, [system] { return system->stopping || system->queued > 0; });
+  }
+}
+
+// thread_count defaults to one less than the core count, the main thread helps while it waits
+inline void init_job_system(JobSystem &system, int thread_count = -1) {
+  int cores = std::thread::hardware_concurrency();
+  if (thread_count < 0) {
+    thread_count = std::max(1, cores - 1);
+  }
+  thread_count = std::min(thread_count, JOB_THREADS_MAX);
+
+  system.queued = 0;
+  system.stopping = false;
+  system.jobs_run = 0;
+  system.steals = 0;
+  for (int i = 0; i <= thread_count; i++) {
+    system.queues.push_back(std::make_unique<JobQueue>());
+  }
+  for (int i = 0; i < thread_count; i++) {
+    system.workers.push_back(std::thread(run_job_worker, &system, i));
+  }
+}
+
+inline void schedule_job(JobSystem &system, std::function<void()> run, JobCounter *counter = NULL,
+                         JobCounter *after = NULL) {
+  if (counter) {
+    counter->pending += 1;
+  }
+  Job job = {std::move(run), counter, after};
+
+  // not started, nothing can be pending either
+  if (system.queues.empty()) {
+    job.run();
+    finish_job(system, job);
+    return;
+  }
+
+  if (after) {
+    std::lock_guard<std::mutex> lock(system.held_mutex);
+    if (after->pending > 0) {
+      system.held.push_back(std::move(job));
+      return;
+    }
+  }
+  enqueue_job(system, std::move(job));
+}
+
+// Splits [0, count) into chunks of at least grain indices. Ranges that fit in a single chunk run
+// inline, so small inputs don't pay for scheduling.
+inline void parallel_for(JobSystem &system, int count, int grain,
+                         std::function<void(int, int)> body, JobCounter *counter) {
+  int chunks = (count + grain - 1) / std::max(grain, 1);
+  if (chunks <= 1 || system.workers.empty()) {
+    if (count > 0) {
+      body(0, count);
+    }
+    return;
+  }
+
+  chunks = std::min(chunks, (int)system.workers.size() * 4);
+  int chunk_size = (count + chunks - 1) / chunks;
+  for (int begin = 0; begin < count; begin += chunk_size) {
+    int end = std::min(begin + chunk_size, count);
+    schedule_job(system, [body, begin, end]() { body(begin, end); }, counter);
+  }
+}
+
+// Runs other jobs until counter reaches zero
+inline void wait_for_counter(JobSystem &system, JobCounter *counter) {
+  while (counter->pending > 0) {
+    if (!run_one_job(system)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+// Stops the workers, jobs still queued or held are dropped
+inline void shutdown_job_system(JobSystem &system) {
+  {
+    std::lock_guard<std::mutex> lock(system.sleep_mutex);
+    system.stopping = true;
+  }
+  system.wake.notify_all();
+  for (auto &worker : system.workers) {
+    worker.join();
+  }
+  system.workers.clear();
+  system.queues.clear();
+  system.held.clear();
+
+  TraceLog(LOG_INFO, "JOBS: %llu jobs run, %llu stolen", (unsigned long long)system.jobs_run,
+           (unsigned long long)system.steals);
+}
+}  // namespace bomaqs
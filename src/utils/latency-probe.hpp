@@ -0,0 +1,130 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <chrono>
+#include <string>
+
+// Input-to-photon latency instrumentation, enabled by building with -DBOMAQS_LATENCY_PROBE.
+// Games stamp an input when they observe it, mark the update that applies its effect, and close the
+// sample right after EndDrawing. Without the define every call is a cheap no-op.
+
+#define LATENCY_BUCKET_MS 1
+#define LATENCY_BUCKETS 100
+#define LATENCY_MAX_FRAMES 16
+
+namespace bomaqs {
+
+typedef struct {
+  std::string game;
+  bool enabled;
+  double pending_input;  // stamp of an observed input whose effect hasn't been applied yet
+  double drawn_input;    // stamp of the input whose effect is in the frame being drawn
+  unsigned long long frame;
+  unsigned long long pending_frame;
+  unsigned long long drawn_frame;
+  unsigned long long samples;
+  double total_ms;
+  unsigned int ms_histogram[LATENCY_BUCKETS + 1];  // last bucket collects overflow
+  unsigned int frame_histogram[LATENCY_MAX_FRAMES + 1];
+} LatencyProbe;
+
+inline double latency_now() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(now).count();
+}
+
+inline LatencyProbe create_latency_probe(std::string game) {
+  LatencyProbe probe = {};
+  probe.game = game;
+#ifdef BOMAQS_LATENCY_PROBE
+  probe.enabled = true;
+#endif
+  return probe;
+}
+
+// Call when an input is observed, with its event time when it has one (input_now stamps share the
+// clock). The first stamp wins until its effect is applied, so repeated inputs don't hide the
+// oldest one.
+inline void latency_input(LatencyProbe &probe, double stamp = 0) {
+  if (!probe.enabled || probe.pending_input > 0) {
+    return;
+  }
+  probe.pending_input = stamp > 0 ? stamp : latency_now();
+  probe.pending_frame = probe.frame;
+}
+
+// Call from the update that applies the stamped input, the result shows up in this frame's draw
+inline void latency_effect(LatencyProbe &probe) {
+  if (!probe.enabled || probe.pending_input <= 0) {
+    return;
+  }
+  probe.drawn_input = probe.pending_input;
+  probe.drawn_frame = probe.pending_frame;
+  probe.pending_input = 0;
+}
+
+// Call when the stamped input turned out to do nothing (a miss, a tap while dead), so its stamp
+// doesn't get charged to the next input that does
+inline void latency_no_effect(LatencyProbe &probe) {
+  probe.pending_input = 0;
+}
+
+// Call right after EndDrawing, records the delay for the input drawn in this frame
+inline void latency_frame_end(LatencyProbe &probe) {
+  if (!probe.enabled) {
+    return;
+  }
+
+  if (probe.drawn_input > 0) {
+    double ms = (latency_now() - probe.drawn_input) * 1000.0;
+    int bucket = (int)(ms / LATENCY_BUCKET_MS);
+    int frames = (int)(probe.frame - probe.drawn_frame);
+
+    probe.ms_histogram[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS] += 1;
+    probe.frame_histogram[frames < LATENCY_MAX_FRAMES ? frames : LATENCY_MAX_FRAMES] += 1;
+    probe.samples += 1;
+    probe.total_ms += ms;
+    probe.drawn_input = 0;
+  }
+
+  probe.frame += 1;
+}
+
+inline double latency_percentile(LatencyProbe &probe, float fraction) {
+  unsigned long long target = probe.samples * fraction;
+  unsigned long long seen = 0;
+  for (int i = 0; i <= LATENCY_BUCKETS; i++) {
+    seen += probe.ms_histogram[i];
+    if (seen > target) {
+      return (i + 1) * LATENCY_BUCKET_MS;
+    }
+  }
+  return 0;
+}
+
+// Writes latency-<game>.csv in the working directory, summary first so two builds diff cleanly
+inline void save_latency_histogram(LatencyProbe &probe) {
+  if (!probe.enabled || probe.samples == 0) {
+    return;
+  }
+
+  std::string out = "# game,samples,mean_ms,p50_ms,p95_ms,p99_ms\n";
+  out.append(TextFormat("# %s,%llu,%.2f,%.0f,%.0f,%.0f\n", probe.game.data(), probe.samples,
+                        probe.total_ms / probe.samples, latency_percentile(probe, 0.50f),
+                        latency_percentile(probe, 0.95f), latency_percentile(probe, 0.99f)));
+
+  out.append("kind,bucket,count\n");
+  for (int i = 0; i <= LATENCY_BUCKETS; i++) {
+    out.append(TextFormat("ms,%d%s,%u\n", i * LATENCY_BUCKET_MS, i == LATENCY_BUCKETS ? "+" : "",
+                          probe.ms_histogram[i]));
+  }
+  for (int i = 0; i <= LATENCY_MAX_FRAMES; i++) {
+    out.append(TextFormat("frames,%d%s,%u\n", i, i == LATENCY_MAX_FRAMES ? "+" : "",
+                          probe.frame_histogram[i]));
+  }
+
+  std::string file = "latency-" + probe.game + ".csv";
+  SaveFileText(file.data(), out.data());
+}
+}  // namespace bomaqs
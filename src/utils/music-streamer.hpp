@@ -0,0 +1,164 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "data-loader.hpp"
+
+// Music playback with decoding moved off the render thread. A decode thread owns the raylib Music
+// and calls UpdateMusicStream, which decodes straight into the stream's sub-buffers whenever the
+// mixer has played one, so a long frame can't stall decoding. The main thread only starts the track
+// and sets its volume, under the streamer's lock.
+//
+// Only raylib's public API is used, and raylib 3.5 only decodes a track incrementally into its
+// AudioStream. The stream's two sub-buffers of MUSIC_FEED_FRAMES are the single producer/single
+// consumer PCM ring between the decode thread and the mixer: the decoder fills a sub-buffer once
+// the mixer has marked it processed. Web builds without pthreads update on the main thread in
+// update_music_streamer.
+//
+// The mixer reads the sub-buffers in turn from the start of the track, so the frames it has played
+// say which one it's on. When it has moved two sub-buffers on since the decoder last filled them,
+// it ran dry and played silence: that's counted as an underrun.
+//
+// A streamer opened as a null sink has no decode thread and needs no audio device, benches time
+// decode_music_null_sink with it.
+
+#if defined(PLATFORM_WEB) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define MUSIC_DECODE_THREAD 0
+#else
+#define MUSIC_DECODE_THREAD 1
+#endif
+
+#define MUSIC_FEED_FRAMES 4096  // stream sub-buffer, ~93ms at 44.1kHz, two of them are queued
+#define MUSIC_UPDATE_MS 5       // decode thread wake up, well under a sub-buffer
+
+namespace bomaqs {
+
+typedef struct {
+  Music music;  // owns the decoder context
+  bool null_sink;
+  bool looping;
+  bool playing;
+  unsigned int played_frames;  // as of the last update, the mixer restarts from 0 on each loop
+
+  std::mutex lock;  // raylib calls on music, from the decode thread and the main thread
+  std::thread decoder;
+  std::atomic<bool> running;
+
+  // stats
+  std::atomic<unsigned int> underruns;  // times the mixer played every queued sub-buffer
+} MusicStreamer;
+
+inline unsigned int music_frames_played(MusicStreamer &streamer) {
+  double seconds = GetMusicTimePlayed(streamer.music);
+  return (unsigned int)(seconds * streamer.music.stream.sampleRate + 0.5);
+}
+
+// Refills the sub-buffers the mixer has played, call under the streamer's lock
+inline void update_music_stream(MusicStreamer &streamer) {
+  unsigned int played = music_frames_played(streamer);
+  if (played >= streamer.played_frames &&
+      played / MUSIC_FEED_FRAMES >= streamer.played_frames / MUSIC_FEED_FRAMES + 2) {
+    streamer.underruns += 1;
+  }
+  streamer.played_frames = played;
+  UpdateMusicStream(streamer.music);
+}
+
+inline void run_music_decoder(MusicStreamer *streamer) {
+  while (streamer->running) {
+    {
+      std::lock_guard<std::mutex> guard(streamer->lock);
+      if (streamer->playing) {
+        update_music_stream(*streamer);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(MUSIC_UPDATE_MS));
+  }
+}
+
+inline bool open_music_streamer(MusicStreamer &streamer, std::string file, bool null_sink = false) {
+  streamer.null_sink = null_sink;
+  streamer.looping = true;
+  streamer.playing = false;
+  streamer.played_frames = 0;
+  streamer.running = false;
+  streamer.underruns = 0;
+
+  // The buffer size is a raudio global read when the stream is created, set it only around our
+  // own streams and put back 0 (the device's period size) for everyone else's
+  static std::mutex buffer_size_lock;
+  {
+    std::lock_guard<std::mutex> guard(buffer_size_lock);
+    SetAudioStreamBufferSizeDefault(MUSIC_FEED_FRAMES);
+    streamer.music = LoadMusicStream(get_real_path(file).data());
+    SetAudioStreamBufferSizeDefault(0);
+  }
+  if (!streamer.music.ctxData) {
+    return false;
+  }
+
+  if (MUSIC_DECODE_THREAD && !null_sink) {
+    streamer.running = true;
+    streamer.decoder = std::thread(run_music_decoder, &streamer);
+  }
+  return true;
+}
+
+inline void play_music_streamer(MusicStreamer &streamer) {
+  if (!streamer.music.ctxData) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(streamer.lock);
+  streamer.music.looping = streamer.looping;
+  PlayMusicStream(streamer.music);
+  streamer.playing = true;
+  streamer.played_frames = 0;
+}
+
+inline void set_music_streamer_volume(MusicStreamer &streamer, float volume) {
+  std::lock_guard<std::mutex> guard(streamer.lock);
+  SetMusicVolume(streamer.music, volume);
+}
+
+// Call once a frame from the main thread, only decodes here without a decode thread
+inline void update_music_streamer(MusicStreamer &streamer) {
+  if (!MUSIC_DECODE_THREAD && !streamer.null_sink && streamer.playing) {
+    update_music_stream(streamer);
+  }
+}
+
+// Without an audio device nothing drains the stream, so each call restarts the track and decodes
+// its first two sub-buffers, 2 * MUSIC_FEED_FRAMES frames. Needs a streamer opened as a null sink.
+inline void decode_music_null_sink(MusicStreamer &streamer) {
+  PlayMusicStream(streamer.music);
+  UpdateMusicStream(streamer.music);
+  StopMusicStream(streamer.music);
+}
+
+// PCM queued in the stream's sub-buffers, the decoder's own state isn't visible
+inline size_t music_streamer_bytes(MusicStreamer &streamer) {
+  return (size_t)2 * MUSIC_FEED_FRAMES * streamer.music.stream.channels *
+         (streamer.music.stream.sampleSize / 8);
+}
+
+inline void close_music_streamer(MusicStreamer &streamer) {
+  if (streamer.running) {
+    streamer.running = false;
+    streamer.decoder.join();
+  }
+  if (streamer.music.ctxData) {
+    UnloadMusicStream(streamer.music);
+    streamer.music.ctxData = NULL;
+  }
+
+  if (streamer.underruns > 0) {
+    TraceLog(LOG_INFO, "MUSIC: %u underruns", (unsigned int)streamer.underruns);
+  }
+}
+}  // namespace bomaqs
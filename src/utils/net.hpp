@@ -0,0 +1,218 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+
+// Minimal UDP for local multiplayer: a non-blocking socket bound to loopback, a byte writer/reader
+// with varints for delta encoded packets, and per-socket traffic counters for bandwidth reports.
+//
+// Only POSIX sockets are wrapped. Windows (winsock's headers clash with raylib's names) and web
+// builds (no UDP in the browser) get sockets that fail to open, the games fall back to local play.
+
+#if defined(_WIN32) || defined(PLATFORM_WEB)
+#define NET_SOCKETS 0
+#else
+#define NET_SOCKETS 1
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#define NET_MAX_PACKET 4096  // loopback has room, keeps every snapshot in one datagram
+
+namespace bomaqs {
+
+typedef struct {
+  uint32_t host;  // network byte order
+  uint16_t port;  // host byte order
+} NetAddress;
+
+typedef struct {
+  unsigned long long packets_sent;
+  unsigned long long packets_received;
+  unsigned long long bytes_sent;
+  unsigned long long bytes_received;
+  unsigned long long packets_dropped;  // simulated loss
+} NetStats;
+
+typedef struct {
+  int fd;
+  NetStats stats;
+  int drop_percent;  // simulated incoming loss, for testing on loopback
+  std::minstd_rand drop_rng;
+} UdpSocket;
+
+inline bool same_address(NetAddress a, NetAddress b) { return a.host == b.host && a.port == b.port; }
+
+inline NetAddress loopback_address(uint16_t port) {
+#if NET_SOCKETS
+  return {htonl(INADDR_LOOPBACK), port};
+#else
+  return {0, port};
+#endif
+}
+
+// Binds to 127.0.0.1:port, port 0 picks any free one
+inline bool open_udp_socket(UdpSocket &socket_out, uint16_t port) {
+  socket_out.fd = -1;
+  socket_out.stats = {};
+  socket_out.drop_percent = 0;
+#if NET_SOCKETS
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    TraceLog(LOG_WARNING, "NET: Can't create socket");
+    return false;
+  }
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  if (bind(fd, (sockaddr *)&address, sizeof(address)) < 0) {
+    TraceLog(LOG_WARNING, "NET: Can't bind port %u", port);
+    close(fd);
+    return false;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+  socket_out.fd = fd;
+  return true;
+#else
+  TraceLog(LOG_WARNING, "NET: UDP sockets aren't supported on this platform");
+  return false;
+#endif
+}
+
+inline void close_udp_socket(UdpSocket &socket) {
+#if NET_SOCKETS
+  if (socket.fd >= 0) {
+    close(socket.fd);
+  }
+#endif
+  socket.fd = -1;
+}
+
+inline bool send_packet(UdpSocket &socket, NetAddress to, const uint8_t *data, int size) {
+#if NET_SOCKETS
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = to.host;
+  address.sin_port = htons(to.port);
+  if (sendto(socket.fd, data, size, 0, (sockaddr *)&address, sizeof(address)) != size) {
+    return false;
+  }
+  socket.stats.packets_sent += 1;
+  socket.stats.bytes_sent += size;
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Next queued datagram, its size or -1 when there's none
+inline int receive_packet(UdpSocket &socket, NetAddress &from, uint8_t *buffer, int capacity) {
+#if NET_SOCKETS
+  while (true) {
+    sockaddr_in address = {};
+    socklen_t length = sizeof(address);
+    int size = recvfrom(socket.fd, buffer, capacity, 0, (sockaddr *)&address, &length);
+    if (size < 0) {
+      return -1;
+    }
+    if (socket.drop_percent > 0 && (int)(socket.drop_rng() % 100) < socket.drop_percent) {
+      socket.stats.packets_dropped += 1;
+      continue;
+    }
+
+    socket.stats.packets_received += 1;
+    socket.stats.bytes_received += size;
+    from = {address.sin_addr.s_addr, ntohs(address.sin_port)};
+    return size;
+  }
+#else
+  return -1;
+#endif
+}
+
+// Packet writer, bounded by NET_MAX_PACKET. Overflows are flagged and the packet dropped by the
+// caller rather than sent truncated.
+typedef struct {
+  uint8_t data[NET_MAX_PACKET];
+  int size;
+  bool overflow;
+} NetWriter;
+
+typedef struct {
+  const uint8_t *data;
+  int size;
+  int position;
+  bool error;  // read past the end or a malformed varint
+} NetReader;
+
+inline void write_u8(NetWriter &writer, uint8_t value) {
+  if (writer.size >= NET_MAX_PACKET) {
+    writer.overflow = true;
+    return;
+  }
+  writer.data[writer.size++] = value;
+}
+
+inline void write_u32(NetWriter &writer, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    write_u8(writer, value >> (i * 8));
+  }
+}
+
+// LEB128, 7 bits a byte
+inline void write_varint(NetWriter &writer, uint32_t value) {
+  while (value >= 0x80) {
+    write_u8(writer, (value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  write_u8(writer, value);
+}
+
+// Small magnitudes of either sign stay small
+inline void write_signed(NetWriter &writer, int32_t value) {
+  write_varint(writer, ((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+}
+
+inline uint8_t read_u8(NetReader &reader) {
+  if (reader.position >= reader.size) {
+    reader.error = true;
+    return 0;
+  }
+  return reader.data[reader.position++];
+}
+
+inline uint32_t read_u32(NetReader &reader) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; i++) {
+    value |= (uint32_t)read_u8(reader) << (i * 8);
+  }
+  return value;
+}
+
+inline uint32_t read_varint(NetReader &reader) {
+  uint32_t value = 0;
+  for (int shift = 0; shift < 35; shift += 7) {
+    uint8_t byte = read_u8(reader);
+    value |= (uint32_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+  reader.error = true;
+  return 0;
+}
+
+inline int32_t read_signed(NetReader &reader) {
+  uint32_t value = read_varint(reader);
+  return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+}  // namespace bomaqs
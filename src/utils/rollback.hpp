@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Snapshot ring and rollback for flat, trivially copyable worlds. save_state copies the world into
+// a preallocated slot (a memcpy, no allocation), load_state copies it back.
+//
+// Rollback keeps the world from before each of the last Capacity frames, plus the input each frame
+// ran with. A late input is written into the past with past_input, then resimulate_from reloads that
+// frame and steps forward to the present again with the corrected inputs. rewind_rollback drops
+// everything after a frame, for undo to a checkpoint. The step must be deterministic, the same rules
+// as SimPipeline's.
+//
+// Worlds are large: allocate rollbacks statically or on the heap, not on the stack.
+
+namespace bomaqs {
+
+template <typename World, int Capacity>
+struct StateRing {
+  World states[Capacity];
+  uint32_t frames[Capacity];  // frame each slot holds, UINT32_MAX when empty
+
+  static_assert(std::is_trivially_copyable<World>::value, "states are saved with memcpy");
+};
+
+template <typename World, int Capacity>
+void clear_states(StateRing<World, Capacity> &ring) {
+  for (auto &frame : ring.frames) {
+    frame = UINT32_MAX;
+  }
+}
+
+template <typename World, int Capacity>
+void save_state(StateRing<World, Capacity> &ring, uint32_t frame, const World &world) {
+  memcpy(&ring.states[frame % Capacity], &world, sizeof(World));
+  ring.frames[frame % Capacity] = frame;
+}
+
+// False if frame was overwritten or never saved
+template <typename World, int Capacity>
+bool load_state(const StateRing<World, Capacity> &ring, uint32_t frame, World &world) {
+  if (ring.frames[frame % Capacity] != frame) {
+    return false;
+  }
+  memcpy(&world, &ring.states[frame % Capacity], sizeof(World));
+  return true;
+}
+
+template <typename World, typename Input, int Capacity>
+struct Rollback {
+  void (*step)(World &, const Input &);
+  World world;     // present
+  uint32_t frame;  // frames stepped so far, the next frame to run
+  StateRing<World, Capacity> before;  // world before each frame ran
+  Input inputs[Capacity];
+
+  unsigned long long rollbacks;
+  unsigned long long frames_resimulated;
+};
+
+template <typename World, typename Input, int Capacity>
+void start_rollback(Rollback<World, Input, Capacity> &rollback, const World &world,
+                    void (*step)(World &, const Input &)) {
+  rollback.step = step;
+  rollback.world = world;
+  rollback.frame = 0;
+  clear_states(rollback.before);
+  rollback.rollbacks = 0;
+  rollback.frames_resimulated = 0;
+}
+
+template <typename World, typename Input, int Capacity>
+void advance_rollback(Rollback<World, Input, Capacity> &rollback, const Input &input) {
+  save_state(rollback.before, rollback.frame, rollback.world);
+  rollback.inputs[rollback.frame % Capacity] = input;
+  rollback.step(rollback.world, input);
+  rollback.frame += 1;
+}
+
+// Input a past frame ran with, NULL if the frame is in the future or too old to roll back to
+template <typename World, typename Input, int Capacity>
+Input *past_input(Rollback<World, Input, Capacity> &rollback, uint32_t frame) {
+  if (frame >= rollback.frame || rollback.before.frames[frame % Capacity] != frame) {
+    return NULL;
+  }
+  return &rollback.inputs[frame % Capacity];
+}
+
+// Re-runs frame up to the present with the stored inputs, returns the frames stepped (0 if frame
+// is out of the window)
+template <typename World, typename Input, int Capacity>
+int resimulate_from(Rollback<World, Input, Capacity> &rollback, uint32_t frame) {
+  uint32_t present = rollback.frame;
+  if (frame >= present || !load_state(rollback.before, frame, rollback.world)) {
+    return 0;
+  }
+
+  for (rollback.frame = frame; rollback.frame < present;) {
+    advance_rollback(rollback, rollback.inputs[rollback.frame % Capacity]);
+  }
+  rollback.rollbacks += 1;
+  rollback.frames_resimulated += present - frame;
+  return present - frame;
+}
+
+// Back to the world as it was before frame ran, later frames are forgotten
+template <typename World, typename Input, int Capacity>
+bool rewind_rollback(Rollback<World, Input, Capacity> &rollback, uint32_t frame) {
+  if (frame >= rollback.frame || !load_state(rollback.before, frame, rollback.world)) {
+    return false;
+  }
+  for (uint32_t later = frame; later < rollback.frame; later++) {
+    rollback.before.frames[later % Capacity] = UINT32_MAX;
+  }
+  rollback.frame = frame;
+  return true;
+}
+}  // namespace bomaqs
@@ -0,0 +1,240 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#define SCENARIO_PEAK_MEMORY
+#endif
+
+// Stress scenarios: whole-game load tests, repeatable from a file. A scenario seeds a game's world
+// with an entity mix and scripted input, the game runs it for a number of ticks, headless or
+// drawing every tick, and reports tick time percentiles and the process' peak memory. Scenarios in
+// bench/scenarios are the standing performance acceptance suite, check-scenarios.sh runs them.
+//
+// The file is line based like bullet patterns:
+//
+//   # comment
+//   game <name>        the game it's for, others refuse it
+//   ticks <n>          how long to run
+//   seed <n>           world seed, 1 if missing
+//   budget <ms>        p99 tick time to stay under, optional
+//   memory <MB>        peak memory to stay under, optional
+//   ...                anything else is the game's own, documented where the game loads it
+//
+// Times are wall time of the whole tick: the simulation, plus drawing and presenting when
+// rendered. Rendered runs don't wait for vsync. Results go to scenario-<name>.json with one result
+// per line, in the same shape as bench results so bench-compare can compare two runs.
+
+#define SCENARIO_DEFAULT_TICKS 600
+
+namespace bomaqs {
+
+typedef struct {
+  int line;
+  std::string directive;
+  std::vector<std::string> words;  // arguments
+} ScenarioLine;
+
+typedef struct {
+  std::string name;  // file name without directory and extension
+  std::string game;
+  int ticks;
+  unsigned int seed;
+  double budget_ms;  // 0 without a budget
+  double memory_mb;
+  std::vector<ScenarioLine> lines;  // the game's directives, in file order
+} Scenario;
+
+typedef struct {
+  std::vector<double> tick_ms;
+  double start;
+} ScenarioStats;
+
+inline void scenario_warning(const Scenario &scenario, const ScenarioLine &line,
+                             const char *message) {
+  TraceLog(LOG_WARNING, "SCENARIO: [%s:%d] '%s' %s", scenario.name.data(), line.line,
+           line.directive.data(), message);
+}
+
+// The line's arguments as numbers, false with a warning unless it has between min and max of them
+inline bool scenario_numbers(const Scenario &scenario, const ScenarioLine &line, int min, int max,
+                             std::vector<float> &numbers) {
+  numbers.clear();
+  for (auto &word : line.words) {
+    char *end = NULL;
+    numbers.push_back(strtof(word.data(), &end));
+    if (*end) {
+      scenario_warning(scenario, line, TextFormat("takes numbers, not '%s'", word.data()));
+      return false;
+    }
+  }
+  if ((int)numbers.size() < min || (int)numbers.size() > max) {
+    scenario_warning(scenario, line,
+                     min == max ? TextFormat("takes %d argument(s)", min)
+                                : TextFormat("takes %d to %d arguments", min, max));
+    return false;
+  }
+  return true;
+}
+
+// Reads the file and the common directives, false with a warning if it can't be read or isn't for
+// game. The game goes through scenario.lines itself.
+inline bool load_scenario(const char *path, const char *game, Scenario &scenario) {
+  std::string file = path;
+  size_t slash = file.find_last_of("/\\");
+  scenario = {file.substr(slash == std::string::npos ? 0 : slash + 1), "", SCENARIO_DEFAULT_TICKS,
+              1, 0, 0, {}};
+  scenario.name = scenario.name.substr(0, scenario.name.rfind('.'));
+
+  char *text = LoadFileText(path);
+  if (!text) {
+    TraceLog(LOG_WARNING, "SCENARIO: [%s] can't read", path);
+    return false;
+  }
+  std::istringstream lines(text);
+  UnloadFileText((unsigned char *)text);
+
+  std::string source_line;
+  int line_number = 0;
+  bool valid = true;
+  while (std::getline(lines, source_line)) {
+    line_number += 1;
+    std::istringstream tokens(source_line.substr(0, source_line.find('#')));
+    ScenarioLine line = {line_number, "", {}};
+    if (!(tokens >> line.directive)) {
+      continue;
+    }
+    for (std::string word; tokens >> word;) {
+      line.words.push_back(word);
+    }
+
+    std::vector<float> numbers;
+    if (line.directive == "game") {
+      scenario.game = line.words.empty() ? "" : line.words[0];
+    } else if (line.directive == "ticks" || line.directive == "seed" ||
+               line.directive == "budget" || line.directive == "memory") {
+      if (!scenario_numbers(scenario, line, 1, 1, numbers)) {
+        valid = false;
+        continue;
+      }
+      if (line.directive == "ticks") {
+        scenario.ticks = (int)numbers[0];
+      } else if (line.directive == "seed") {
+        scenario.seed = (unsigned int)numbers[0];
+      } else if (line.directive == "budget") {
+        scenario.budget_ms = numbers[0];
+      } else {
+        scenario.memory_mb = numbers[0];
+      }
+    } else {
+      scenario.lines.push_back(line);
+    }
+  }
+
+  if (scenario.game != game) {
+    TraceLog(LOG_WARNING, "SCENARIO: [%s] is for '%s', not %s", scenario.name.data(),
+             scenario.game.data(), game);
+    return false;
+  }
+  return valid;
+}
+
+inline double scenario_now() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(now).count();
+}
+
+inline void start_scenario_stats(ScenarioStats &stats, const Scenario &scenario) {
+  stats.tick_ms.clear();
+  stats.tick_ms.reserve(scenario.ticks);
+  stats.start = scenario_now();
+}
+
+// Call at the end of every tick, times it from the end of the last one
+inline void record_scenario_tick(ScenarioStats &stats) {
+  double now = scenario_now();
+  stats.tick_ms.push_back((now - stats.start) * 1000);
+  stats.start = now;
+}
+
+// Peak resident memory of the process in MB, 0 where it can't be read (web, Windows)
+inline double scenario_peak_memory_mb() {
+#ifdef SCENARIO_PEAK_MEMORY
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.0 * 1024.0);  // bytes
+#else
+  return usage.ru_maxrss / 1024.0;  // KB
+#endif
+#else
+  return 0;
+#endif
+}
+
+// Nearest rank, of sorted times
+inline double scenario_percentile(const std::vector<double> &sorted, double percent) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  size_t rank = (size_t)std::ceil(percent / 100 * sorted.size());
+  return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+// Logs and saves the run, summary is the game's own line (entity counts, ...). Returns 1 when over
+// the scenario's budgets.
+inline int report_scenario(const Scenario &scenario, const ScenarioStats &stats, bool rendered,
+                           std::string summary) {
+  std::vector<double> sorted = stats.tick_ms;
+  std::sort(sorted.begin(), sorted.end());
+  double mean = 0;
+  for (double ms : sorted) {
+    mean += ms / sorted.size();
+  }
+  double p50 = scenario_percentile(sorted, 50), p90 = scenario_percentile(sorted, 90),
+         p99 = scenario_percentile(sorted, 99), max = sorted.empty() ? 0 : sorted.back();
+  double peak_mb = scenario_peak_memory_mb();
+  bool over_time = scenario.budget_ms > 0 && p99 > scenario.budget_ms;
+  bool over_memory = scenario.memory_mb > 0 && peak_mb > scenario.memory_mb;
+
+  const char *mode = rendered ? "rendered" : "headless";
+  TraceLog(over_time || over_memory ? LOG_WARNING : LOG_INFO,
+           "SCENARIO: [%s] %d ticks %s, p50 %.3fms p90 %.3fms p99 %.3fms max %.3fms mean %.3fms, "
+           "peak memory %.1fMB",
+           scenario.name.data(), (int)sorted.size(), mode, p50, p90, p99, max, mean, peak_mb);
+  TraceLog(LOG_INFO, "SCENARIO: [%s] %s", scenario.name.data(), summary.data());
+  if (over_time) {
+    TraceLog(LOG_WARNING, "SCENARIO: [%s] p99 over the %.3fms budget", scenario.name.data(),
+             scenario.budget_ms);
+  }
+  if (over_memory) {
+    TraceLog(LOG_WARNING, "SCENARIO: [%s] peak memory over %.1fMB", scenario.name.data(),
+             scenario.memory_mb);
+  }
+
+  std::string out = "[\n";
+  const char *names[] = {"p50", "p90", "p99", "max"};
+  double values[] = {p50, p90, p99, max};
+  for (int i = 0; i < 4; i++) {
+    out.append(TextFormat("  {\"suite\": \"scenario-%s\", \"name\": \"%s %s\", \"size\": %d, "
+                          "\"ns_per_op\": %.1f, \"peak_mb\": %.1f},\n",
+                          mode, scenario.name.data(), names[i], (int)sorted.size(),
+                          values[i] * 1e6, peak_mb));
+  }
+  out.replace(out.size() - 2, 2, "\n]\n");
+  std::string file = "scenario-" + scenario.name + ".json";
+  SaveFileText(file.data(), out.data());
+
+  return over_time || over_memory;
+}
+}  // namespace bomaqs
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SESSION_USE_MMAP
+#endif
+
+#if defined(PLATFORM_WEB)
+#include <emscripten.h>
+#endif
+
+// Saved sessions, so a game the OS or browser kills in the background comes back where it was.
+//
+// Layout: SessionHeader, section_count SessionSection records, then payloads each starting on a
+// SESSION_ALIGNMENT boundary. A section is a run of fixed-layout records (item_size > 0) or raw
+// bytes (item_size 0). Records are read in place from the mapped file, no parsing or copying.
+//
+// Every game has its own schema version, bump it whenever a saved struct changes. Files with
+// another version are ignored, and so is a section whose record size no longer matches, in case
+// the bump was forgotten. Files are written to a temporary and renamed over the old one, so a
+// crash mid-write leaves the previous session intact.
+//
+// Web builds keep sessions in IndexedDB (IDBFS mounted at /sessions), call
+// mount_session_storage before the first open_session.
+
+#define SESSION_MAGIC "BQSS"
+#define SESSION_FORMAT_VERSION 1
+#define SESSION_ALIGNMENT 16
+
+namespace bomaqs {
+
+typedef struct {
+  char magic[4];
+  uint32_t format_version;
+  uint32_t schema_version;  // the game's own
+  uint32_t section_count;
+} SessionHeader;
+
+typedef struct {
+  char tag[4];
+  uint32_t offset;
+  uint32_t size;
+  uint32_t item_size;  // bytes per record, 0 for raw bytes
+} SessionSection;
+
+typedef struct {
+  uint32_t schema_version;
+  std::vector<SessionSection> sections;
+  std::vector<unsigned char> payload;  // sections in order, each padded to SESSION_ALIGNMENT
+} SessionWriter;
+
+typedef struct {
+  unsigned char *data;
+  size_t size;
+  const SessionSection *sections;
+  uint32_t section_count;
+} SessionFile;
+
+inline std::string session_path(const char *game) {
+#if defined(PLATFORM_WEB)
+  return std::string("/sessions/session-") + game + ".bin";
+#else
+  return std::string("session-") + game + ".bin";
+#endif
+}
+
+// Mounts IndexedDB storage and waits for it to load, needs ASYNCIFY. No-op on other platforms.
+inline void mount_session_storage() {
+#if defined(PLATFORM_WEB)
+  EM_ASM({
+    Module.sessionsLoaded = false;
+    FS.mkdir('/sessions');
+    FS.mount(IDBFS, {}, '/sessions');
+    FS.syncfs(true, function() { Module.sessionsLoaded = true; });
+  });
+  while (!EM_ASM_INT({ return Module.sessionsLoaded; })) {
+    emscripten_sleep(1);
+  }
+#endif
+}
+
+inline void begin_session(SessionWriter &writer, uint32_t schema_version) {
+  writer.schema_version = schema_version;
+  writer.sections.clear();
+  writer.payload.clear();
+}
+
+inline void add_session_section(SessionWriter &writer, const char *tag, const void *data,
+                                uint32_t size, uint32_t item_size = 0) {
+  SessionSection section = {{tag[0], tag[1], tag[2], tag[3]}, 0, size, item_size};
+  section.offset = writer.payload.size();  // relative to the payload until written
+  writer.payload.insert(writer.payload.end(), (const unsigned char *)data,
+                        (const unsigned char *)data + size);
+  writer.payload.resize((writer.payload.size() + SESSION_ALIGNMENT - 1) & ~(SESSION_ALIGNMENT - 1));
+  writer.sections.push_back(section);
+}
+
+template <typename T>
+inline void add_session_records(SessionWriter &writer, const char *tag, const T *items, int count) {
+  static_assert(std::is_trivially_copyable<T>::value, "records are read back in place");
+  add_session_section(writer, tag, items, sizeof(T) * count, sizeof(T));
+}
+
+// Writes atomically, false with a warning if the file couldn't be written
+inline bool write_session(const SessionWriter &writer, const char *path) {
+  SessionHeader header = {{SESSION_MAGIC[0], SESSION_MAGIC[1], SESSION_MAGIC[2], SESSION_MAGIC[3]},
+                          SESSION_FORMAT_VERSION, writer.schema_version,
+                          (uint32_t)writer.sections.size()};
+  uint32_t table_size = sizeof(SessionHeader) + sizeof(SessionSection) * writer.sections.size();
+  uint32_t payload_start = (table_size + SESSION_ALIGNMENT - 1) & ~(SESSION_ALIGNMENT - 1);
+
+  std::vector<SessionSection> sections = writer.sections;
+  for (auto &section : sections) {
+    section.offset += payload_start;
+  }
+
+  std::string temporary = std::string(path) + ".tmp";
+  FILE *file = fopen(temporary.data(), "wb");
+  if (!file) {
+    TraceLog(LOG_WARNING, "SESSION: [%s] Can't open file for writing", temporary.data());
+    return false;
+  }
+
+  static const unsigned char padding[SESSION_ALIGNMENT] = {};
+  bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(sections.data(), sizeof(SessionSection), sections.size(), file) ==
+                     sections.size() &&
+                 fwrite(padding, 1, payload_start - table_size, file) == payload_start - table_size &&
+                 fwrite(writer.payload.data(), 1, writer.payload.size(), file) ==
+                     writer.payload.size() &&
+                 fflush(file) == 0;
+#ifdef SESSION_USE_MMAP
+  written = written && fsync(fileno(file)) == 0;
+#endif
+  written = fclose(file) == 0 && written;
+
+#ifdef _WIN32
+  remove(path);  // rename doesn't replace on Windows, a crash right here loses the session
+#endif
+  if (!written || rename(temporary.data(), path) != 0) {
+    TraceLog(LOG_WARNING, "SESSION: [%s] Failed to write session", path);
+    remove(temporary.data());
+    return false;
+  }
+
+#if defined(PLATFORM_WEB)
+  EM_ASM(FS.syncfs(false, function() {}););
+#endif
+  return true;
+}
+
+inline void close_session(SessionFile &session) {
+  if (!session.data) {
+    return;
+  }
+#ifdef SESSION_USE_MMAP
+  munmap(session.data, session.size);
+#else
+  UnloadFileData(session.data);
+#endif
+  session.data = NULL;
+  session.section_count = 0;
+}
+
+// False if there's no session, or it's corrupt or from another schema version
+inline bool open_session(SessionFile &session, const char *path, uint32_t schema_version) {
+  session.data = NULL;
+  session.size = 0;
+  session.section_count = 0;
+
+#ifdef SESSION_USE_MMAP
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    void *mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED) {
+      session.data = (unsigned char *)mapping;
+      session.size = info.st_size;
+    }
+  }
+  close(fd);
+#else
+  if (FileExists(path)) {
+    unsigned int size = 0;
+    session.data = LoadFileData(path, &size);
+    session.size = size;
+  }
+#endif
+
+  if (!session.data) {
+    return false;
+  }
+
+  auto header = (const SessionHeader *)session.data;
+  bool valid = session.size >= sizeof(SessionHeader) &&
+               memcmp(header->magic, SESSION_MAGIC, 4) == 0 &&
+               header->format_version == SESSION_FORMAT_VERSION &&
+               sizeof(SessionHeader) + ((size_t)header->section_count * sizeof(SessionSection)) <=
+                   session.size;
+
+  auto sections = (const SessionSection *)(session.data + sizeof(SessionHeader));
+  for (uint32_t i = 0; valid && i < header->section_count; i++) {
+    valid = (size_t)sections[i].offset + sections[i].size <= session.size &&
+            sections[i].offset % SESSION_ALIGNMENT == 0 &&
+            (sections[i].item_size == 0 || sections[i].size % sections[i].item_size == 0);
+  }
+
+  if (!valid) {
+    TraceLog(LOG_WARNING, "SESSION: [%s] Invalid session file", path);
+  } else if (header->schema_version != schema_version) {
+    TraceLog(LOG_INFO, "SESSION: [%s] Ignoring session from schema version %u, expected %u", path,
+             header->schema_version, schema_version);
+    valid = false;
+  }
+  if (!valid) {
+    close_session(session);
+    return false;
+  }
+
+  session.sections = sections;
+  session.section_count = header->section_count;
+  return true;
+}
+
+// Section data in place, NULL if missing or its record size doesn't match item_size
+inline const void *session_section(const SessionFile &session, const char *tag, uint32_t item_size,
+                                   uint32_t *size) {
+  for (uint32_t i = 0; i < session.section_count; i++) {
+    const SessionSection &section = session.sections[i];
+    if (memcmp(section.tag, tag, 4) != 0) {
+      continue;
+    }
+    if (section.item_size != item_size) {
+      TraceLog(LOG_WARNING, "SESSION: Section %.4s has %u byte records, expected %u", tag,
+               section.item_size, item_size);
+      return NULL;
+    }
+    *size = section.size;
+    return session.data + section.offset;
+  }
+  return NULL;
+}
+
+// Records of a section in place, valid until close_session
+template <typename T>
+inline const T *session_records(const SessionFile &session, const char *tag, int *count) {
+  static_assert(std::is_trivially_copyable<T>::value, "records are read in place");
+  uint32_t size = 0;
+  auto records = (const T *)session_section(session, tag, sizeof(T), &size);
+  *count = records ? size / sizeof(T) : 0;
+  return records;
+}
+}  // namespace bomaqs
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Pipelined simulation. The game step runs on a worker thread while the main thread renders the
+// last published snapshot, so simulation and render cost overlap instead of adding up.
+//
+// The main thread submits one input per tick. The worker applies them strictly in order to its own
+// copy of the world and publishes a snapshot through a lock-free triple buffer: the worker always
+// has a slot to write, the renderer always has a complete slot to read, and neither waits on the
+// other. The step must only read its input and the world (no globals, no raylib RNG or clocks), so
+// the same inputs give the same worlds whether the step runs threaded or inline.
+//
+// Web builds without pthreads, or pipelines started with threaded = false, step inline in
+// submit_sim_input and render the tick they just simulated.
+
+#if defined(PLATFORM_WEB) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define SIM_PIPELINE_THREAD 0
+#else
+#define SIM_PIPELINE_THREAD 1
+#endif
+
+#define SIM_INPUT_QUEUE 8  // ticks the worker may lag behind before submit blocks, power of two
+#define SIM_SLOT_FRESH 4   // set on the ready slot index when it holds an unread snapshot
+
+namespace bomaqs {
+
+template <typename World, typename Input>
+struct SimPipeline {
+  void (*step)(World &, const Input &);
+  bool threaded;
+
+  World sim;  // the worker's world, only touched by the stepping thread
+  World slots[3];
+  int back;                // worker side
+  int front;               // render side
+  std::atomic<int> ready;  // last published slot, shared
+
+  Input inputs[SIM_INPUT_QUEUE];
+  std::atomic<unsigned int> input_write;
+  std::atomic<unsigned int> input_read;
+
+  std::thread worker;
+  std::mutex wake_mutex;  // only used to sleep and wake the worker
+  std::condition_variable wake;
+  std::atomic<bool> running;
+};
+
+template <typename World, typename Input>
+void publish_sim_snapshot(SimPipeline<World, Input> &pipeline) {
+  pipeline.slots[pipeline.back] = pipeline.sim;
+  int previous = pipeline.ready.exchange(pipeline.back | SIM_SLOT_FRESH, std::memory_order_acq_rel);
+  pipeline.back = previous & ~SIM_SLOT_FRESH;
+}
+
+template <typename World, typename Input>
+bool pop_sim_input(SimPipeline<World, Input> &pipeline, Input &input) {
+  unsigned int read = pipeline.input_read.load(std::memory_order_relaxed);
+  if (read == pipeline.input_write.load(std::memory_order_acquire)) {
+    return false;
+  }
+  input = pipeline.inputs[read % SIM_INPUT_QUEUE];
+  pipeline.input_read.store(read + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename World, typename Input>
+void run_sim_worker(SimPipeline<World, Input> *pipeline) {
+  Input input;
+  while (true) {
+    if (!pop_sim_input(*pipeline, input)) {
+      if (!pipeline->running) {
+        return;
+      }
+      std::unique_lock<std::mutex> lock(pipeline->wake_mutex);
+      pipeline->wake.wait(lock, [pipeline] {
+        return !pipeline->running ||
+               pipeline->input_read.load() != pipeline->input_write.load();
+      });
+      continue;
+    }
+
+    pipeline->step(pipeline->sim, input);
+    publish_sim_snapshot(*pipeline);
+  }
+}
+
+template <typename World, typename Input>
+void start_sim_pipeline(SimPipeline<World, Input> &pipeline, const World &world,
+                        void (*step)(World &, const Input &), bool threaded = SIM_PIPELINE_THREAD) {
+  pipeline.step = step;
+  pipeline.threaded = threaded && SIM_PIPELINE_THREAD;
+  pipeline.sim = world;
+  for (auto &slot : pipeline.slots) {
+    slot = world;
+  }
+  pipeline.front = 0;
+  pipeline.ready = 1;
+  pipeline.back = 2;
+  pipeline.input_write = 0;
+  pipeline.input_read = 0;
+  pipeline.running = pipeline.threaded;
+
+  if (pipeline.threaded) {
+    pipeline.worker = std::thread(run_sim_worker<World, Input>, &pipeline);
+  }
+}
+
+// Queues the next tick's input, blocks only if the worker is SIM_INPUT_QUEUE ticks behind
+template <typename World, typename Input>
+void submit_sim_input(SimPipeline<World, Input> &pipeline, const Input &input) {
+  if (!pipeline.threaded) {
+    pipeline.step(pipeline.sim, input);
+    publish_sim_snapshot(pipeline);
+    return;
+  }
+
+  unsigned int write = pipeline.input_write.load(std::memory_order_relaxed);
+  while (write - pipeline.input_read.load(std::memory_order_acquire) >= SIM_INPUT_QUEUE) {
+    std::this_thread::yield();
+  }
+  pipeline.inputs[write % SIM_INPUT_QUEUE] = input;
+  pipeline.input_write.store(write + 1, std::memory_order_release);
+
+  { std::lock_guard<std::mutex> lock(pipeline.wake_mutex); }
+  pipeline.wake.notify_one();
+}
+
+// Latest complete world, stays valid and unchanged until the next call
+template <typename World, typename Input>
+const World &acquire_sim_snapshot(SimPipeline<World, Input> &pipeline) {
+  if (pipeline.ready.load(std::memory_order_acquire) & SIM_SLOT_FRESH) {
+    int previous = pipeline.ready.exchange(pipeline.front, std::memory_order_acq_rel);
+    pipeline.front = previous & ~SIM_SLOT_FRESH;
+  }
+  return pipeline.slots[pipeline.front];
+}
+
+// Joins the worker after it has stepped the inputs already queued
+template <typename World, typename Input>
+void stop_sim_pipeline(SimPipeline<World, Input> &pipeline) {
+  if (!pipeline.threaded) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(pipeline.wake_mutex);
+    pipeline.running = false;
+  }
+  pipeline.wake.notify_one();
+  pipeline.worker.join();
+  pipeline.threaded = false;
+}
+}  // namespace bomaqs
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cmath>
+#include <cstdint>
+
+// Spawn placement. A coarse grid over the playfield buckets everything a spawn has to keep clear
+// of (players, enemies), each with its own clearance radius. A candidate point is accepted when
+// it's at least radius + distance from every occupant, which only looks at the cells around it.
+//
+// sample_spawn_point throws at most SPAWN_ATTEMPTS uniform darts into a region and takes the first
+// clear one. Accepted spawns are added back as occupants, so spawns within a tick keep the same
+// distance from each other: Poisson-disk sampling by dart throwing. When every dart lands too
+// close the one with the most clearance is used, so a crowded field still gets its spawn in
+// bounded time: SPAWN_ATTEMPTS candidates, each checking a fixed neighbourhood of cells.
+//
+// The grid is scratch, built from the world when spawning. Fixed capacity, no allocation, fine to
+// keep on the stack. Randomness comes from the caller so simulations stay deterministic.
+
+#define SPAWN_GRID_MAX_CELLS 1024
+#define SPAWN_GRID_MAX_OCCUPANTS 1024
+#define SPAWN_ATTEMPTS 30
+
+namespace bomaqs {
+
+typedef struct {
+  Rectangle area;
+  float cell_size;
+  int columns;
+  int rows;
+  float max_radius;  // neighbourhoods searched must reach the widest occupant
+  int count;
+  int16_t heads[SPAWN_GRID_MAX_CELLS];  // first occupant per cell, -1 when empty
+  int16_t next[SPAWN_GRID_MAX_OCCUPANTS];
+  Vector2 positions[SPAWN_GRID_MAX_OCCUPANTS];
+  float radii[SPAWN_GRID_MAX_OCCUPANTS];
+} SpawnGrid;
+
+// cell_size is grown if area would need more than SPAWN_GRID_MAX_CELLS cells
+inline void init_spawn_grid(SpawnGrid &grid, Rectangle area, float cell_size) {
+  while (ceilf(area.width / cell_size) * ceilf(area.height / cell_size) > SPAWN_GRID_MAX_CELLS) {
+    cell_size *= 2;
+  }
+  grid.area = area;
+  grid.cell_size = cell_size;
+  grid.columns = (int)ceilf(area.width / cell_size);
+  grid.rows = (int)ceilf(area.height / cell_size);
+  grid.max_radius = 0;
+  grid.count = 0;
+  for (int i = 0; i < grid.columns * grid.rows; i++) {
+    grid.heads[i] = -1;
+  }
+}
+
+// Cell of a point, points off the grid go to the nearest edge cell
+inline int spawn_cell_column(const SpawnGrid &grid, float x) {
+  int column = (int)floorf((x - grid.area.x) / grid.cell_size);
+  return column < 0 ? 0 : column >= grid.columns ? grid.columns - 1 : column;
+}
+
+inline int spawn_cell_row(const SpawnGrid &grid, float y) {
+  int row = (int)floorf((y - grid.area.y) / grid.cell_size);
+  return row < 0 ? 0 : row >= grid.rows ? grid.rows - 1 : row;
+}
+
+// False once the grid is full, later occupants are ignored
+inline bool add_spawn_occupant(SpawnGrid &grid, Vector2 position, float radius) {
+  if (grid.count == SPAWN_GRID_MAX_OCCUPANTS) {
+    return false;
+  }
+  int cell = spawn_cell_row(grid, position.y) * grid.columns + spawn_cell_column(grid, position.x);
+  grid.positions[grid.count] = position;
+  grid.radii[grid.count] = radius;
+  grid.next[grid.count] = grid.heads[cell];
+  grid.heads[cell] = grid.count;
+  grid.count += 1;
+  grid.max_radius = radius > grid.max_radius ? radius : grid.max_radius;
+  return true;
+}
+
+// Smallest gap between point and an occupant's clearance circle, negative inside one. Only looks
+// within reach: returns reach when nothing is closer.
+inline float spawn_clearance(const SpawnGrid &grid, Vector2 point, float reach) {
+  float search = reach + grid.max_radius;
+  int left = spawn_cell_column(grid, point.x - search);
+  int right = spawn_cell_column(grid, point.x + search);
+  int top = spawn_cell_row(grid, point.y - search);
+  int bottom = spawn_cell_row(grid, point.y + search);
+
+  float clearance = reach;
+  for (int row = top; row <= bottom; row++) {
+    for (int column = left; column <= right; column++) {
+      for (int i = grid.heads[row * grid.columns + column]; i >= 0; i = grid.next[i]) {
+        float dx = grid.positions[i].x - point.x;
+        float dy = grid.positions[i].y - point.y;
+        float gap = sqrtf((dx * dx) + (dy * dy)) - grid.radii[i];
+        clearance = gap < clearance ? gap : clearance;
+      }
+    }
+  }
+  return clearance;
+}
+
+// A point in region at least distance from every occupant's clearance radius. random(min, max) is
+// an inclusive integer RNG. False if none of the darts was clear, point is then the best of them.
+template <typename Random>
+inline bool sample_spawn_point(const SpawnGrid &grid, Rectangle region, float distance,
+                               Random &&random, Vector2 *point) {
+  float best = -INFINITY;
+  for (int attempt = 0; attempt < SPAWN_ATTEMPTS; attempt++) {
+    Vector2 candidate = {region.x + (region.width * random(0, 1023) / 1023.0f),
+                         region.y + (region.height * random(0, 1023) / 1023.0f)};
+    float clearance = spawn_clearance(grid, candidate, distance);
+    if (clearance >= distance) {
+      *point = candidate;
+      return true;
+    }
+    if (clearance > best) {
+      best = clearance;
+      *point = candidate;
+    }
+  }
+  return false;
+}
+}  // namespace bomaqs
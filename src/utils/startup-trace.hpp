@@ -0,0 +1,158 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(PLATFORM_WEB)
+#include <time.h>
+#define STARTUP_THREAD_CPU_TIME
+#endif
+
+// Startup profiling, from launch to the first frame the player can act on. A game starts the trace
+// first thing in main and wraps each startup phase (window, audio device, bundle, first level) in
+// trace_startup_phase or begin/end_startup_phase, which record wall time and the CPU time of the
+// thread the phase ran on. The asset manager traces its decodes and uploads itself, on whichever
+// thread they run. finish_startup_trace on the first interactive frame closes the trace, logs the
+// total against the game's cold-start budget with the slowest phases, and writes every phase to
+// startup-<game>.csv.
+//
+// Games also run the windowless part of their startup (audio device, bundle, asset decodes) under
+// --startup-check and exit non-zero when it alone is over budget, check-startup.sh runs that in CI.
+//
+// Web and Windows builds can't read a thread's CPU time, phases there count the whole process.
+// Outside a trace a phase costs an atomic load.
+
+#define STARTUP_LOG_PHASES 5  // slowest phases in the log summary
+
+namespace bomaqs {
+
+typedef struct {
+  const char *name;
+  std::string detail;  // asset file, level, ...
+  bool main_thread;
+  double start_ms;  // since the trace started
+  double wall_ms;
+  double cpu_ms;
+} StartupPhase;
+
+typedef struct {
+  std::string game;
+  double budget_ms;
+  double start;  // startup_wall_time seconds
+  std::thread::id main_thread;
+  std::atomic<bool> active;
+  std::mutex mutex;  // asset workers add phases too
+  std::vector<StartupPhase> phases;
+} StartupTrace;
+
+// Process wide, started by the game with start_startup_trace
+inline StartupTrace startup_trace;
+
+// A phase in flight, handed back to end_startup_phase
+typedef struct {
+  const char *name;
+  std::string detail;
+  double wall;
+  double cpu;
+  bool active;
+} StartupSpan;
+
+inline double startup_wall_time() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return std::chrono::duration<double>(now).count();
+}
+
+// CPU seconds of the calling thread, or of the process where threads can't be told apart
+inline double startup_cpu_time() {
+#ifdef STARTUP_THREAD_CPU_TIME
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec + (now.tv_nsec * 1e-9);
+#else
+  return (double)std::clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+inline void start_startup_trace(std::string game, double budget_ms) {
+  std::lock_guard<std::mutex> lock(startup_trace.mutex);
+  startup_trace.game = game;
+  startup_trace.budget_ms = budget_ms;
+  startup_trace.start = startup_wall_time();
+  startup_trace.main_thread = std::this_thread::get_id();
+  startup_trace.phases.clear();
+  startup_trace.active = true;
+}
+
+inline StartupSpan begin_startup_phase(const char *name, std::string detail = "") {
+  if (!startup_trace.active.load(std::memory_order_relaxed)) {
+    return {name, "", 0, 0, false};
+  }
+  return {name, detail, startup_wall_time(), startup_cpu_time(), true};
+}
+
+inline void end_startup_phase(const StartupSpan &span) {
+  if (!span.active) {
+    return;
+  }
+  double wall = startup_wall_time();
+  double cpu = startup_cpu_time();
+  std::lock_guard<std::mutex> lock(startup_trace.mutex);
+  if (!startup_trace.active) {
+    return;  // finished while the phase ran
+  }
+  startup_trace.phases.push_back({span.name, span.detail,
+                                  std::this_thread::get_id() == startup_trace.main_thread,
+                                  (span.wall - startup_trace.start) * 1000,
+                                  (wall - span.wall) * 1000, (cpu - span.cpu) * 1000});
+}
+
+template <typename Function>
+inline void trace_startup_phase(const char *name, Function function) {
+  StartupSpan span = begin_startup_phase(name);
+  function();
+  end_startup_phase(span);
+}
+
+// Call on the first interactive frame. Returns launch to now in ms, 0 when no trace is running.
+inline double finish_startup_trace() {
+  if (!startup_trace.active) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(startup_trace.mutex);
+  startup_trace.active = false;
+  double total_ms = (startup_wall_time() - startup_trace.start) * 1000;
+  std::vector<StartupPhase> &phases = startup_trace.phases;
+
+  std::string out = "phase,detail,thread,start_ms,wall_ms,cpu_ms\n";
+  for (auto &phase : phases) {
+    out.append(TextFormat("%s,\"%s\",%s,%.3f,%.3f,%.3f\n", phase.name, phase.detail.data(),
+                          phase.main_thread ? "main" : "worker", phase.start_ms, phase.wall_ms,
+                          phase.cpu_ms));
+  }
+  out.append(TextFormat("interactive,\"\",main,%.3f,0,0\n", total_ms));
+  std::string file = "startup-" + startup_trace.game + ".csv";
+  SaveFileText(file.data(), out.data());
+
+  bool over = total_ms > startup_trace.budget_ms;
+  TraceLog(over ? LOG_WARNING : LOG_INFO, "STARTUP: [%s] Interactive after %.1fms, budget %.0fms",
+           startup_trace.game.data(), total_ms, startup_trace.budget_ms);
+  std::sort(phases.begin(), phases.end(), [](const StartupPhase &a, const StartupPhase &b) {
+    return a.wall_ms > b.wall_ms;
+  });
+  for (int i = 0; i < (int)phases.size() && i < STARTUP_LOG_PHASES; i++) {
+    TraceLog(over ? LOG_WARNING : LOG_INFO, "STARTUP:   %s %s %.1fms wall, %.1fms cpu on %s",
+             phases[i].name, phases[i].detail.data(), phases[i].wall_ms, phases[i].cpu_ms,
+             phases[i].main_thread ? "main" : "a worker");
+  }
+  phases.clear();
+  return total_ms;
+}
+}  // namespace bomaqs
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <type_traits>
+
+// FNV-1a hashes of simulation state, for checking that two builds or two runs stay in lockstep.
+// Fields are fed one at a time rather than hashing whole structs, padding bytes aren't state.
+// Floats are hashed by their bits, so a hash only matches if every value matches exactly.
+//
+// Games print one hash per tick with --hash-ticks, check-determinism.sh diffs two builds' output.
+
+namespace bomaqs {
+
+typedef struct {
+  uint64_t value;
+} StateHash;
+
+inline StateHash start_state_hash() { return {14695981039346656037ULL}; }
+
+inline void hash_bytes(StateHash &hash, const void *data, int size) {
+  const uint8_t *bytes = (const uint8_t *)data;
+  for (int i = 0; i < size; i++) {
+    hash.value = (hash.value ^ bytes[i]) * 1099511628211ULL;
+  }
+}
+
+template <typename T>
+inline void hash_value(StateHash &hash, T value) {
+  static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "hash fields one by one");
+  hash_bytes(hash, &value, sizeof(T));
+}
+
+inline void hash_value(StateHash &hash, Vector2 value) {
+  hash_value(hash, value.x);
+  hash_value(hash, value.y);
+}
+
+inline void hash_value(StateHash &hash, Rectangle value) {
+  hash_value(hash, value.x);
+  hash_value(hash, value.y);
+  hash_value(hash, value.width);
+  hash_value(hash, value.height);
+}
+
+// One "<tick> <hash>" line, the format check-determinism.sh compares
+inline void print_state_hash(unsigned long long tick, StateHash hash) {
+  printf("%llu %016llx\n", tick, (unsigned long long)hash.value);
+}
+}  // namespace bomaqs
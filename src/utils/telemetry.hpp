@@ -0,0 +1,300 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Gameplay telemetry: session lengths, death causes, scores, answer times. log_event writes one
+// fixed-size record into a lock-free ring owned by the calling thread (a clock read and a store, no
+// locks or allocation once the thread's ring exists). A background writer drains all rings every
+// TELEMETRY_FLUSH_MS and appends them to telemetry-<game>.bin, rotating it at TELEMETRY_FILE_BYTES.
+// When a ring is full the event is dropped and counted, the game thread never waits on the disk.
+//
+// Decode with tools/telemetry-decode.cpp. Build with -DBOMAQS_NO_TELEMETRY to compile it out.
+
+#if defined(PLATFORM_WEB) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define TELEMETRY_WRITER_THREAD 0  // flushed from log_event when a ring fills, and on stop
+#else
+#define TELEMETRY_WRITER_THREAD 1
+#endif
+
+#define TELEMETRY_MAGIC "BQTL"
+#define TELEMETRY_VERSION 1
+#define TELEMETRY_RING_RECORDS 1024  // per thread, power of two
+#define TELEMETRY_FLUSH_MS 250
+#define TELEMETRY_FILE_BYTES (1 << 20)
+#define TELEMETRY_FILES_KEPT 3  // telemetry-<game>.bin plus .1 and .2
+
+namespace bomaqs {
+
+enum TelemetryEvent {
+  TELEMETRY_SESSION_START,
+  TELEMETRY_SESSION_END,    // value: session seconds
+  TELEMETRY_SHIELD_LOST,    // arg0: cause, arg1: shields left
+  TELEMETRY_GAME_OVER,      // arg0: cause, arg1: ticks played (0 if untracked), value: score
+  TELEMETRY_ENEMY_KILLED,   // arg0: enemy type, arg1: cause, value: score
+  TELEMETRY_ANSWER,         // arg0: 1 correct / 0 wrong, arg1: score, value: answer seconds
+  TELEMETRY_STARTUP,        // arg0: 1 over the cold-start budget, value: ms to interactive
+  TELEMETRY_EVENT_COUNT,
+};
+
+enum TelemetryCause {
+  CAUSE_NONE,
+  CAUSE_BULLET,
+  CAUSE_HOMER_BLAST,
+  CAUSE_ENEMY_CONTACT,  // player ran into a live enemy, or killed a reloading one
+  CAUSE_ENEMY_COLLISION,
+  CAUSE_TIMEOUT,
+  CAUSE_WRONG_ANSWER,
+};
+
+typedef struct {
+  char magic[4];
+  uint32_t version;
+  uint32_t record_size;
+  uint32_t session;
+  char game[32];
+} TelemetryFileHeader;
+
+typedef struct {
+  uint64_t time_us;  // since session start
+  uint32_t sequence;  // per thread, gaps mean dropped records
+  uint16_t event;
+  uint16_t thread;
+  int32_t arg0;
+  int32_t arg1;
+  float value;
+  uint32_t reserved;
+} TelemetryRecord;
+
+static_assert(sizeof(TelemetryRecord) == 32, "telemetry records are written as is");
+
+typedef struct {
+  TelemetryRecord records[TELEMETRY_RING_RECORDS];
+  std::atomic<uint32_t> write;
+  std::atomic<uint32_t> read;
+  uint32_t sequence;
+  uint16_t thread;
+  std::atomic<uint32_t> dropped;
+} TelemetryRing;
+
+typedef struct {
+  std::string game;
+  std::atomic<bool> running;
+  uint32_t session;
+  std::chrono::steady_clock::time_point start;
+
+  std::mutex rings_mutex;  // taken when a thread logs its first event, and by the writer
+  std::vector<std::unique_ptr<TelemetryRing>> rings;
+
+  std::mutex file_mutex;  // writer thread vs flushes from stop or a full ring
+  FILE *file;
+  size_t file_bytes;
+
+  std::thread writer;
+  std::mutex wake_mutex;
+  std::condition_variable wake;
+} Telemetry;
+
+// Process wide, started by the game with start_telemetry
+inline Telemetry telemetry;
+
+inline const char *telemetry_event_name(int event) {
+  static const char *names[TELEMETRY_EVENT_COUNT] = {
+      "session_start", "session_end", "shield_lost", "game_over", "enemy_killed", "answer",
+      "startup",
+  };
+  return event >= 0 && event < TELEMETRY_EVENT_COUNT ? names[event] : "unknown";
+}
+
+inline const char *telemetry_cause_name(int cause) {
+  static const char *names[] = {
+      "none", "bullet", "homer_blast", "enemy_contact", "enemy_collision", "timeout", "wrong_answer",
+  };
+  return cause >= 0 && cause <= CAUSE_WRONG_ANSWER ? names[cause] : "unknown";
+}
+
+inline std::string telemetry_path(Telemetry &log, int index) {
+  std::string path = "telemetry-" + log.game + ".bin";
+  return index ? path + "." + std::to_string(index) : path;
+}
+
+inline void open_telemetry_file(Telemetry &log) {
+  log.file = fopen(telemetry_path(log, 0).data(), "ab");
+  log.file_bytes = 0;
+  if (!log.file) {
+    TraceLog(LOG_WARNING, "TELEMETRY: [%s] Can't open log file", telemetry_path(log, 0).data());
+    return;
+  }
+  fseek(log.file, 0, SEEK_END);
+  log.file_bytes = ftell(log.file);
+
+  // every session starts with a header, so appended and rotated files decode on their own
+  TelemetryFileHeader header = {};
+  memcpy(header.magic, TELEMETRY_MAGIC, 4);
+  header.version = TELEMETRY_VERSION;
+  header.record_size = sizeof(TelemetryRecord);
+  header.session = log.session;
+  snprintf(header.game, sizeof(header.game), "%s", log.game.data());
+  log.file_bytes += fwrite(&header, 1, sizeof(header), log.file);
+}
+
+inline void rotate_telemetry_file(Telemetry &log) {
+  fclose(log.file);
+  for (int i = TELEMETRY_FILES_KEPT - 1; i > 0; i--) {
+    rename(telemetry_path(log, i - 1).data(), telemetry_path(log, i).data());
+  }
+  open_telemetry_file(log);
+}
+
+// Appends everything queued in the rings to the file
+inline void flush_telemetry(Telemetry &log) {
+  std::lock_guard<std::mutex> file_lock(log.file_mutex);
+  std::lock_guard<std::mutex> rings_lock(log.rings_mutex);
+  if (!log.file) {
+    return;
+  }
+
+  for (auto &ring : log.rings) {
+    uint32_t read = ring->read.load(std::memory_order_relaxed);
+    uint32_t write = ring->write.load(std::memory_order_acquire);
+    while (read != write) {
+      // contiguous run up to the end of the ring
+      uint32_t start = read % TELEMETRY_RING_RECORDS;
+      uint32_t count = std::min(write - read, TELEMETRY_RING_RECORDS - start);
+      log.file_bytes += fwrite(&ring->records[start], sizeof(TelemetryRecord), count, log.file) *
+                        sizeof(TelemetryRecord);
+      read += count;
+    }
+    ring->read.store(read, std::memory_order_release);
+  }
+  fflush(log.file);
+
+  if (log.file_bytes >= TELEMETRY_FILE_BYTES) {
+    rotate_telemetry_file(log);
+  }
+}
+
+inline void run_telemetry_writer(Telemetry *log) {
+  while (log->running) {
+    {
+      std::unique_lock<std::mutex> lock(log->wake_mutex);
+      log->wake.wait_for(lock, std::chrono::milliseconds(TELEMETRY_FLUSH_MS),
+                         [log] { return !log->running; });
+    }
+    flush_telemetry(*log);
+  }
+}
+
+inline TelemetryRing *own_telemetry_ring(Telemetry &log) {
+  thread_local TelemetryRing *ring = NULL;
+  thread_local Telemetry *owner = NULL;
+  if (owner != &log) {
+    std::lock_guard<std::mutex> lock(log.rings_mutex);
+    log.rings.push_back(std::make_unique<TelemetryRing>());
+    ring = log.rings.back().get();
+    ring->write = 0;
+    ring->read = 0;
+    ring->sequence = 0;
+    ring->thread = log.rings.size() - 1;
+    ring->dropped = 0;
+    owner = &log;
+  }
+  return ring;
+}
+
+inline void log_event(TelemetryEvent event, int arg0 = 0, int arg1 = 0, float value = 0,
+                      Telemetry &log = telemetry) {
+#ifndef BOMAQS_NO_TELEMETRY
+  if (!log.running) {
+    return;
+  }
+
+  TelemetryRing *ring = own_telemetry_ring(log);
+  uint32_t write = ring->write.load(std::memory_order_relaxed);
+  uint32_t sequence = ring->sequence++;
+  if (write - ring->read.load(std::memory_order_acquire) >= TELEMETRY_RING_RECORDS) {
+    if (TELEMETRY_WRITER_THREAD) {
+      ring->dropped += 1;
+      return;
+    }
+    flush_telemetry(log);
+  }
+
+  auto elapsed = std::chrono::steady_clock::now() - log.start;
+  TelemetryRecord &record = ring->records[write % TELEMETRY_RING_RECORDS];
+  record.time_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  record.sequence = sequence;
+  record.event = event;
+  record.thread = ring->thread;
+  record.arg0 = arg0;
+  record.arg1 = arg1;
+  record.value = value;
+  record.reserved = 0;
+  ring->write.store(write + 1, std::memory_order_release);
+#endif
+}
+
+inline void start_telemetry(std::string game, Telemetry &log = telemetry) {
+#ifndef BOMAQS_NO_TELEMETRY
+  log.game = game;
+  log.session = std::random_device()();
+  log.start = std::chrono::steady_clock::now();
+  {
+    std::lock_guard<std::mutex> lock(log.rings_mutex);
+    for (auto &ring : log.rings) {
+      ring->dropped = 0;
+    }
+  }
+  open_telemetry_file(log);
+  log.running = true;
+
+  if (TELEMETRY_WRITER_THREAD) {
+    log.writer = std::thread(run_telemetry_writer, &log);
+  }
+  log_event(TELEMETRY_SESSION_START, 0, 0, 0, log);
+#endif
+}
+
+inline void stop_telemetry(Telemetry &log = telemetry) {
+  if (!log.running) {
+    return;
+  }
+
+  std::chrono::duration<float> session = std::chrono::steady_clock::now() - log.start;
+  log_event(TELEMETRY_SESSION_END, 0, 0, session.count(), log);
+  {
+    std::lock_guard<std::mutex> lock(log.wake_mutex);
+    log.running = false;
+  }
+  log.wake.notify_one();
+  if (log.writer.joinable()) {
+    log.writer.join();
+  }
+  flush_telemetry(log);
+
+  unsigned int dropped = 0;
+  for (auto &ring : log.rings) {
+    dropped += ring->dropped;
+  }
+  if (dropped > 0) {
+    TraceLog(LOG_WARNING, "TELEMETRY: %u events dropped", dropped);
+  }
+  if (log.file) {
+    fclose(log.file);
+    log.file = NULL;
+  }
+}
+}  // namespace bomaqs
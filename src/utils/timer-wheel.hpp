@@ -0,0 +1,245 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Hierarchical timer wheel, for simulations with lots of countdowns that rarely fire. Timers
+// expire on a tick, each tick only touches the timers that fire on it plus the occasional cascade,
+// nothing is decremented per entity.
+//
+// TIMER_WHEEL_LEVELS wheels of TIMER_WHEEL_SLOTS slots each. Level 0 has a slot per tick, every
+// level above a slot per TIMER_WHEEL_SLOTS slots of the one below. A timer goes into the lowest
+// level its expiry fits in, and higher slots are cascaded down when the ticks reach them. Slots are
+// intrusive doubly linked lists through a fixed pool, so start, cancel and reschedule are O(1).
+//
+// Timers carry a tag and a data word instead of a callback, advance_timers hands both to its fire
+// function. Everything is indices and ticks, the wheel is trivially copyable: it can live in a
+// flat world, be snapshotted, saved and rolled back, and it fires the same way on every run.
+//
+// Handles stay safe after their timer fires or is cancelled: the pool slot's generation moves on
+// and the old handle stops matching. A zeroed handle never matches.
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4  // 2^24 ticks ahead, longer timers wait in the top level
+#define TIMER_WHEEL_RANGE (1u << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS))
+#define TIMER_WHEEL_EXPIRING (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)  // bucket firing right now
+
+namespace bomaqs {
+
+typedef struct {
+  int32_t index;
+  uint32_t generation;
+} TimerHandle;
+
+typedef struct {
+  uint32_t start;
+  uint32_t expires;
+  uint32_t tag;
+  uint32_t data;
+  uint32_t generation;  // moves on whenever the timer is freed
+  int32_t bucket;       // level * TIMER_WHEEL_SLOTS + slot or TIMER_WHEEL_EXPIRING, -1 while free
+  int32_t next;         // in the bucket, or in the free list
+  int32_t prev;
+} Timer;
+
+template <int Capacity>
+struct TimerWheel {
+  uint32_t now;  // last tick advanced to
+  int active;
+  int32_t free;
+  int32_t heads[TIMER_WHEEL_EXPIRING + 1];
+  Timer timers[Capacity];
+};
+
+template <int Capacity>
+inline void init_timer_wheel(TimerWheel<Capacity> &wheel, uint32_t now) {
+  wheel.now = now;
+  wheel.active = 0;
+  wheel.free = 0;
+  for (auto &head : wheel.heads) {
+    head = -1;
+  }
+  for (int i = 0; i < Capacity; i++) {
+    wheel.timers[i] = {0, 0, 0, 0, 1, -1, i + 1 < Capacity ? i + 1 : -1, -1};
+  }
+}
+
+template <int Capacity>
+inline const Timer *find_timer(const TimerWheel<Capacity> &wheel, TimerHandle handle) {
+  if (handle.index < 0 || handle.index >= Capacity) {
+    return NULL;
+  }
+  const Timer &timer = wheel.timers[handle.index];
+  return timer.bucket >= 0 && timer.generation == handle.generation ? &timer : NULL;
+}
+
+// Into the bucket for its expiry as seen from the next tick, overdue timers fire on the next tick
+template <int Capacity>
+inline void link_timer(TimerWheel<Capacity> &wheel, int32_t index) {
+  Timer &timer = wheel.timers[index];
+  uint32_t next_tick = wheel.now + 1;
+  uint32_t delta = (int32_t)(timer.expires - next_tick) < 0 ? 0 : timer.expires - next_tick;
+  delta = delta < TIMER_WHEEL_RANGE ? delta : TIMER_WHEEL_RANGE - 1;
+  uint32_t expires = next_tick + delta;
+
+  int level = 0;
+  while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1u << (TIMER_WHEEL_BITS * (level + 1)))) {
+    level += 1;
+  }
+  timer.bucket = (level * TIMER_WHEEL_SLOTS) +
+                 ((expires >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+  timer.prev = -1;
+  timer.next = wheel.heads[timer.bucket];
+  if (timer.next >= 0) {
+    wheel.timers[timer.next].prev = index;
+  }
+  wheel.heads[timer.bucket] = index;
+}
+
+template <int Capacity>
+inline void unlink_timer(TimerWheel<Capacity> &wheel, int32_t index) {
+  Timer &timer = wheel.timers[index];
+  if (timer.prev >= 0) {
+    wheel.timers[timer.prev].next = timer.next;
+  } else {
+    wheel.heads[timer.bucket] = timer.next;
+  }
+  if (timer.next >= 0) {
+    wheel.timers[timer.next].prev = timer.prev;
+  }
+}
+
+template <int Capacity>
+inline void free_timer(TimerWheel<Capacity> &wheel, int32_t index) {
+  Timer &timer = wheel.timers[index];
+  timer.bucket = -1;
+  timer.generation = timer.generation == UINT32_MAX ? 1 : timer.generation + 1;  // never 0
+  timer.next = wheel.free;
+  wheel.free = index;
+  wheel.active -= 1;
+}
+
+// Fires ticks from now, or from elapsed ticks ago for timers carried over from elsewhere. A zeroed
+// handle if the pool is full.
+template <int Capacity>
+inline TimerHandle start_timer(TimerWheel<Capacity> &wheel, uint32_t ticks, uint32_t tag,
+                               uint32_t data, uint32_t elapsed = 0) {
+  if (wheel.free < 0) {
+    return {0, 0};
+  }
+  int32_t index = wheel.free;
+  Timer &timer = wheel.timers[index];
+  wheel.free = timer.next;
+  wheel.active += 1;
+
+  timer.start = wheel.now - elapsed;
+  timer.expires = timer.start + ticks;
+  timer.tag = tag;
+  timer.data = data;
+  link_timer(wheel, index);
+  return {index, timer.generation};
+}
+
+// False if the timer already fired or was cancelled
+template <int Capacity>
+inline bool cancel_timer(TimerWheel<Capacity> &wheel, TimerHandle handle) {
+  if (!find_timer(wheel, handle)) {
+    return false;
+  }
+  unlink_timer(wheel, handle.index);
+  free_timer(wheel, handle.index);
+  return true;
+}
+
+// Restarts a timer to fire ticks from now, keeping its handle
+template <int Capacity>
+inline bool reschedule_timer(TimerWheel<Capacity> &wheel, TimerHandle handle, uint32_t ticks) {
+  if (!find_timer(wheel, handle)) {
+    return false;
+  }
+  unlink_timer(wheel, handle.index);
+  Timer &timer = wheel.timers[handle.index];
+  timer.start = wheel.now;
+  timer.expires = wheel.now + ticks;
+  link_timer(wheel, handle.index);
+  return true;
+}
+
+// For owners that move, like entities in an archetype
+template <int Capacity>
+inline bool set_timer_data(TimerWheel<Capacity> &wheel, TimerHandle handle, uint32_t data) {
+  if (!find_timer(wheel, handle)) {
+    return false;
+  }
+  wheel.timers[handle.index].data = data;
+  return true;
+}
+
+template <int Capacity>
+inline bool timer_active(const TimerWheel<Capacity> &wheel, TimerHandle handle) {
+  return find_timer(wheel, handle) != NULL;
+}
+
+// Ticks until it fires, 0 for timers that aren't active
+template <int Capacity>
+inline uint32_t timer_remaining(const TimerWheel<Capacity> &wheel, TimerHandle handle) {
+  const Timer *timer = find_timer(wheel, handle);
+  return timer && (int32_t)(timer->expires - wheel.now) > 0 ? timer->expires - wheel.now : 0;
+}
+
+// 0 when started to 1 when it fires, 1 for timers that aren't active
+template <int Capacity>
+inline float timer_progress(const TimerWheel<Capacity> &wheel, TimerHandle handle) {
+  const Timer *timer = find_timer(wheel, handle);
+  if (!timer || timer->expires == timer->start) {
+    return 1;
+  }
+  float progress = (float)(int32_t)(wheel.now - timer->start) / (timer->expires - timer->start);
+  return progress < 0 ? 0 : progress > 1 ? 1 : progress;
+}
+
+// Runs the wheel up to tick, fire(tag, data) for every timer that expires on the way. Timers are
+// freed before their fire is called, so it may start, cancel or reschedule any timer.
+template <int Capacity, typename Fire>
+inline void advance_timers(TimerWheel<Capacity> &wheel, uint32_t tick, Fire fire) {
+  while ((int32_t)(tick - wheel.now) > 0) {
+    uint32_t current = wheel.now + 1;
+
+    // Slots of higher levels whose span starts now are spread over the levels below
+    for (int level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+      if (current & ((1u << (TIMER_WHEEL_BITS * level)) - 1)) {
+        continue;
+      }
+      int bucket = (level * TIMER_WHEEL_SLOTS) +
+                   ((current >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+      int32_t index = wheel.heads[bucket];
+      wheel.heads[bucket] = -1;
+      while (index >= 0) {
+        int32_t next = wheel.timers[index].next;
+        link_timer(wheel, index);
+        index = next;
+      }
+    }
+
+    // The slot is moved aside before firing: a timer started from fire a full turn ahead lands in
+    // this same slot, and must wait for that turn
+    wheel.now = current;
+    int bucket = current & (TIMER_WHEEL_SLOTS - 1);
+    wheel.heads[TIMER_WHEEL_EXPIRING] = wheel.heads[bucket];
+    wheel.heads[bucket] = -1;
+    for (int32_t index = wheel.heads[TIMER_WHEEL_EXPIRING]; index >= 0;) {
+      wheel.timers[index].bucket = TIMER_WHEEL_EXPIRING;
+      index = wheel.timers[index].next;
+    }
+    while (wheel.heads[TIMER_WHEEL_EXPIRING] >= 0) {
+      int32_t index = wheel.heads[TIMER_WHEEL_EXPIRING];
+      const Timer &timer = wheel.timers[index];
+      uint32_t tag = timer.tag, data = timer.data;
+      unlink_timer(wheel, index);
+      free_timer(wheel, index);
+      fire(tag, data);
+    }
+  }
+}
+}  // namespace bomaqs
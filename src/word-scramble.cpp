@@ -1,13 +1,21 @@
 #include <raylib.h>
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <random>
 #include <vector>
 
+#include "utils/asset-manager.hpp"
 #include "utils/camera-2d.hpp"
-#include "utils/data-loader.hpp"
+#include "utils/frame-pacer.hpp"
+#include "utils/input-queue.hpp"
+#include "utils/job-system.hpp"
+#include "utils/latency-probe.hpp"
+#include "utils/session.hpp"
+#include "utils/startup-trace.hpp"
+#include "utils/telemetry.hpp"
 
 #define WINDOW_TITLE "Word Game"
 #define SCREEN_WIDTH 540
@@ -25,6 +33,9 @@
 
 #define ALL_ALPHABETS "abcdefghijklmnopqrstuvwxyz"
 
+#define SESSION_SCHEMA_VERSION 1  // bump when SavedLevel or Letter change layout
+#define STARTUP_BUDGET_MS 1500  // launch to the first playable level
+
 using namespace std;
 
 enum Answer {
@@ -63,139 +74,342 @@ typedef struct GameLevel {
   LevelAnswer answer;
 } GameLevel;
 
-vector<Letter> generate_letters(string, string);
-GameLevel generate_level(bomaqs::word_dict, short);
+// Fixed part of a level and the score as saved in a session, letters and the two words are saved
+// in their own sections
+typedef struct SavedLevel {
+  int score;
+  bool game_running;
+  float timer;
+  short base_word_length;
+  LevelAnswer answer;
+  Rectangle word1_bounds;
+  Rectangle word2_bounds;
+  Color word1_color;
+  Color word2_color;
+} SavedLevel;
+
+// Everything the game streams in
+typedef struct GameAssets {
+  bomaqs::AssetHandle word_dictionary;
+  bomaqs::AssetHandle letter_font;
+  bomaqs::AssetHandle button_font;
+  bomaqs::AssetHandle wrong_answer_sfx;
+  bomaqs::AssetHandle correct_answer_sfx;
+  bomaqs::AssetHandle music;
+} GameAssets;
+
+GameAssets queue_game_assets(bomaqs::AssetManager&);
+int run_startup_check(double);
+bool save_session(const GameLevel&, int, bool);
+bool load_session(GameLevel&, int&, bool&);
+vector<Letter> generate_letters(string, string, mt19937&);
+GameLevel generate_level(const bomaqs::word_dict&, short, unsigned int);
+unsigned int new_level_seed(void);
 Answer check_answer(GameLevel, Vector2);
-Color get_random_color(void);
-char* get_random_word(bomaqs::word_dict, short);
+int get_random_int(mt19937&, int, int);
+Color get_random_color(mt19937&);
+char* get_random_word(const bomaqs::word_dict&, short, mt19937&);
 void draw_level(GameLevel, Font, Font);
 void draw_game_over(int, string);
 void draw_background(Texture2D);
 void draw_hud(GameLevel, int);
+void draw_loading(float, bool);
+
+#ifndef BOMAQS_NO_MAIN
+int main(int argc, char** argv) {
+  // word-scramble [--startup-check [budget ms]]
+  if (argc > 1 && strcmp(argv[1], "--startup-check") == 0) {
+    return run_startup_check(argc > 2 ? atof(argv[2]) : STARTUP_BUDGET_MS);
+  }
 
-int main() {
   //---- Initialization
+  bomaqs::start_startup_trace("word-scramble", STARTUP_BUDGET_MS);
   auto camera = bomaqs::create2dCamera();
 
   // SetConfigFlags(FLAG_MSAA_4X_HINT);
-  InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, WINDOW_TITLE);
-  InitAudioDevice();
-
-  // Resources
-  auto word_dictionary = bomaqs::load_word_dictionary("word-list.txt");
-  // Texture2D background = bomaqs::load_texture("bg1-original.png");
-  Font letter_font = bomaqs::load_font("Cousine-Regular.ttf", LETTER_SIZE);
-  Font button_font = bomaqs::load_font("IBMPlexMono-Regular.ttf", ANSWER_SIZE);
-  Sound wrong_answer_sfx = bomaqs::load_sound("wrong.wav");
-  Sound correct_answer_sfx = bomaqs::load_sound("select.wav");
-  Music music = bomaqs::load_music("mini1111.ogg");
-
-  PlayMusicStream(music);
-  SetTargetFPS(DEFAULT_FPS);
-
-  // Game world
+  bomaqs::trace_startup_phase("init_window",
+                              [] { InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, WINDOW_TITLE); });
+  bomaqs::trace_startup_phase("init_audio", [] { InitAudioDevice(); });
+  bomaqs::init_input_queue(bomaqs::input_queue);
+
+  // Resources, decoded in the background while a loading screen is shown
+  bomaqs::trace_startup_phase("mount_bundle", [] { bomaqs::mount_bundle("word-scramble.pak"); });
+  bomaqs::AssetManager assets;
+  bomaqs::init_asset_manager(assets);
+  GameAssets game_assets = queue_game_assets(assets);
+  bool music_playing = false;
+
+  bomaqs::FramePacer pacer;
+  bomaqs::init_frame_pacer(pacer, DEFAULT_FPS);
+  bomaqs::init_job_system(bomaqs::job_system);
+  bomaqs::start_telemetry("word-scramble");
+
+  // Game world, the first level needs the dictionary and fonts. A level the last session was sent
+  // to the background in is picked up again instead.
   int score = 0;
   bool game_running = true;
-  auto level = generate_level(word_dictionary, GAME_DIFFICULTY);
+  bool level_loaded = false;
+  bomaqs::word_dict word_dictionary;
+  Font letter_font = {0};
+  Font button_font = {0};
+  GameLevel level = {};
+  bomaqs::mount_session_storage();
+  bool resumed = false;
+  bomaqs::trace_startup_phase("load_session",
+                              [&] { resumed = load_session(level, score, game_running); });
+  bool was_background = false;
+  bool interactive = false;
+
+  // The next level is generated on the job system while the current one is played
+  GameLevel next_level = {};
+  bomaqs::JobCounter next_level_ready = {};
+  auto prefetch_level = [&]() {
+    unsigned int seed = new_level_seed();
+    bomaqs::schedule_job(
+        bomaqs::job_system,
+        [&, seed]() { next_level = generate_level(word_dictionary, GAME_DIFFICULTY, seed); },
+        &next_level_ready);
+  };
+  auto take_next_level = [&]() {
+    bomaqs::wait_for_counter(bomaqs::job_system, &next_level_ready);
+    GameLevel taken = next_level;
+    prefetch_level();
+    return taken;
+  };
 
-  // Input handling
-  Vector2 touch_point = {0, 0};
-  int current_gesture = GESTURE_NONE;
-  int last_gesture = GESTURE_NONE;
+  // Input handling, taps older than the game over screen don't restart the game
+  double game_over_time = 0;
+  auto latency_probe = bomaqs::create_latency_probe("word-scramble");
 
   //---- Main game loop
   while (!WindowShouldClose()) {
     //---- Update
-    UpdateMusicStream(music);
+    bomaqs::update_asset_manager(assets);
+    if (IsKeyPressed(KEY_F9)) {
+      bomaqs::log_asset_memory_report(assets);
+    }
+
+    if (!music_playing && bomaqs::asset_ready(assets, game_assets.music)) {
+      bomaqs::play_music_streamer(bomaqs::get_music(assets, game_assets.music));
+      music_playing = true;
+    }
+    if (music_playing) {
+      bomaqs::update_music_streamer(bomaqs::get_music(assets, game_assets.music));
+    }
+
+    if (!level_loaded) {
+      // A font that fails falls back to raylib's, without the dictionary there's nothing to play
+      auto font_done = [&](bomaqs::AssetHandle font) {
+        return bomaqs::asset_ready(assets, font) || bomaqs::asset_failed(assets, font);
+      };
+      auto font_or_default = [&](bomaqs::AssetHandle font) {
+        return bomaqs::asset_ready(assets, font) ? bomaqs::get_font(assets, font)
+                                                 : GetFontDefault();
+      };
+      bool dictionary_failed = bomaqs::asset_failed(assets, game_assets.word_dictionary);
+      if (bomaqs::asset_ready(assets, game_assets.word_dictionary) &&
+          font_done(game_assets.letter_font) && font_done(game_assets.button_font)) {
+        word_dictionary = bomaqs::get_word_dictionary(assets, game_assets.word_dictionary);
+        letter_font = font_or_default(game_assets.letter_font);
+        button_font = font_or_default(game_assets.button_font);
+        if (!resumed) {
+          bomaqs::trace_startup_phase("first_level", [&] {
+            level = generate_level(word_dictionary, GAME_DIFFICULTY, new_level_seed());
+          });
+        }
+        prefetch_level();
+        level_loaded = true;
+      }
+
+      // Taps on the loading screen aren't answers
+      bomaqs::clear_input_events(bomaqs::input_queue);
+      bomaqs::mark_frame_dirty(pacer);
+      if (bomaqs::begin_scene(pacer)) {
+        ClearBackground(RAYWHITE);
+        draw_loading(bomaqs::asset_progress(assets), dictionary_failed);
+      }
+      bomaqs::present_scene(pacer);
+      bomaqs::wait_next_frame(pacer);
+      continue;
+    }
+
+    // Going to the background may be the last thing the app does, save the session now
+    bool in_background = IsWindowMinimized() || !IsWindowFocused();
+    if (in_background && !was_background) {
+      save_session(level, score, game_running);
+    }
+    was_background = in_background;
 
     if (game_running) {
-      level.timer -= GetFrameTime();
+      level.timer -= pacer.frame_time;
     }
 
     // game over condition 1 timeout
-    if (level.timer <= 0) {
+    if (game_running && level.timer <= 0) {
       game_running = false;
+      game_over_time = bomaqs::input_now();
+      bomaqs::log_event(bomaqs::TELEMETRY_GAME_OVER, bomaqs::CAUSE_TIMEOUT, 0, score);
     }
 
-    // Check button press, correct answer go to next level, give score
-    last_gesture = current_gesture;
-    current_gesture = GetGestureDetected();
-    touch_point = GetTouchPosition(0);
-
-    if (current_gesture != last_gesture && current_gesture == GESTURE_TAP) {
+    // Check button presses in order, correct answer go to next level, give score
+    bomaqs::poll_input_events(bomaqs::input_queue);
+    bomaqs::InputEvent event;
+    while (bomaqs::pop_input_event(bomaqs::input_queue, &event)) {
+      if (event.type != bomaqs::INPUT_PRESS) {
+        continue;
+      }
       if (game_running) {
-        switch (check_answer(level, touch_point)) {
+        bomaqs::latency_input(latency_probe, event.time);
+        float answer_seconds = GAME_SPEED - level.timer;
+        switch (check_answer(level, event.position)) {
           case CORRECT_ANSWER:
             score += GAME_SPEED;
-            level = generate_level(word_dictionary, GAME_DIFFICULTY);
-            PlaySoundMulti(correct_answer_sfx);
+            bomaqs::log_event(bomaqs::TELEMETRY_ANSWER, 1, score, answer_seconds);
+            level = take_next_level();
+            if (bomaqs::asset_ready(assets, game_assets.correct_answer_sfx)) {
+              PlaySoundMulti(bomaqs::get_sound(assets, game_assets.correct_answer_sfx));
+            }
+            bomaqs::latency_effect(latency_probe);
             break;
           case WRONG_ANSWER:
             game_running = false;
-            PlaySoundMulti(wrong_answer_sfx);
+            game_over_time = bomaqs::input_now();
+            bomaqs::log_event(bomaqs::TELEMETRY_ANSWER, 0, score, answer_seconds);
+            bomaqs::log_event(bomaqs::TELEMETRY_GAME_OVER, bomaqs::CAUSE_WRONG_ANSWER, 0, score);
+            if (bomaqs::asset_ready(assets, game_assets.wrong_answer_sfx)) {
+              PlaySoundMulti(bomaqs::get_sound(assets, game_assets.wrong_answer_sfx));
+            }
+            bomaqs::latency_effect(latency_probe);
             break;
           default:
+            bomaqs::latency_no_effect(latency_probe);
             break;
         }
-      } else {
+      } else if (event.time > game_over_time) {
+        bomaqs::latency_input(latency_probe, event.time);
         score = 0;
         game_running = true;
-        level = generate_level(word_dictionary, GAME_DIFFICULTY);
+        level = take_next_level();
+        bomaqs::latency_effect(latency_probe);
       }
     }
 
     //---- Draw
-    BeginDrawing();
-    ClearBackground(RAYWHITE);
-    BeginMode2D(camera);
-
-    // Draw game world
+    // The timer ticks while a level runs, the game over screen is static until the next tap
     if (game_running) {
-      // draw_background(background);
-      draw_hud(level, score);
-      draw_level(level, letter_font, button_font);
-    } else {
-      auto message = level.timer <= 0 ? GAME_OVER_TIMEOUT_MESSAGE
-                                      : GAME_OVER_INCORRECT_MESSAGE;
-      draw_game_over(score, message);
+      bomaqs::mark_frame_dirty(pacer);
     }
 
-    EndMode2D();
-    EndDrawing();
+    if (bomaqs::begin_scene(pacer)) {
+      ClearBackground(RAYWHITE);
+      BeginMode2D(camera);
+
+      // Draw game world
+      if (game_running) {
+        // draw_background(background);
+        draw_hud(level, score);
+        draw_level(level, letter_font, button_font);
+      } else {
+        auto message = level.timer <= 0 ? GAME_OVER_TIMEOUT_MESSAGE
+                                        : GAME_OVER_INCORRECT_MESSAGE;
+        draw_game_over(score, message);
+      }
+
+      EndMode2D();
+    }
+    bomaqs::present_scene(pacer);
+    bomaqs::latency_frame_end(latency_probe);
+    if (!interactive) {
+      // First frame with a level to play
+      double startup_ms = bomaqs::finish_startup_trace();
+      bomaqs::log_event(bomaqs::TELEMETRY_STARTUP, startup_ms > STARTUP_BUDGET_MS, 0, startup_ms);
+      interactive = true;
+    }
+    bomaqs::wait_next_frame(pacer);
   }
 
   //---- De-Initialization
+  if (level_loaded) {
+    save_session(level, score, game_running);
+  }
+  bomaqs::wait_for_counter(bomaqs::job_system, &next_level_ready);
+  bomaqs::shutdown_job_system(bomaqs::job_system);
+  bomaqs::stop_telemetry();
+  bomaqs::save_latency_histogram(latency_probe);
+  bomaqs::unload_frame_pacer(pacer);
   StopSoundMulti();
-  UnloadMusicStream(music);
-  UnloadSound(correct_answer_sfx);
-  UnloadSound(wrong_answer_sfx);
+  bomaqs::unload_assets(assets);
+  bomaqs::unmount_bundle();
   CloseAudioDevice();
   CloseWindow();
 
   return 0;
 }
+#endif
 
-GameLevel generate_level(bomaqs::word_dict word_dictionary, short difficulty) {
-  short word1_length = GetRandomValue(difficulty, difficulty + 1);
-  short word2_length =
-      word1_length + GetRandomValue(word1_length == 3 ? 0 : -1, 1);
+GameAssets queue_game_assets(bomaqs::AssetManager& assets) {
+  bomaqs::set_asset_budget(assets, bomaqs::ASSET_SOUND, ASSET_SOUND_BUDGET);
+  bomaqs::set_asset_budget(assets, bomaqs::ASSET_FONT, ASSET_FONT_BUDGET);
+  GameAssets game_assets;
+  game_assets.word_dictionary = bomaqs::queue_word_dictionary(assets, "word-list.txt");
+  // Texture2D background = bomaqs::load_texture("bg1-original.png");
+  game_assets.letter_font = bomaqs::queue_font(assets, "Cousine-Regular.ttf", LETTER_SIZE);
+  game_assets.button_font = bomaqs::queue_font(assets, "IBMPlexMono-Regular.ttf", ANSWER_SIZE);
+  // copied out once the level loads, so they must never be evicted
+  bomaqs::pin_asset(assets, game_assets.letter_font);
+  bomaqs::pin_asset(assets, game_assets.button_font);
+  game_assets.wrong_answer_sfx = bomaqs::queue_sound(assets, "wrong.wav");
+  game_assets.correct_answer_sfx = bomaqs::queue_sound(assets, "select.wav");
+  game_assets.music = bomaqs::queue_music(assets, "mini1111.ogg");
+  return game_assets;
+}
+
+// The windowless part of a cold start: audio device, bundle, asset decodes and the first level,
+// no uploads. Exits with 1 when that alone takes longer than budget_ms.
+int run_startup_check(double budget_ms) {
+  bomaqs::start_startup_trace("word-scramble", budget_ms);
+  bomaqs::trace_startup_phase("init_audio", [] { InitAudioDevice(); });
+  bomaqs::trace_startup_phase("mount_bundle", [] { bomaqs::mount_bundle("word-scramble.pak"); });
+  bomaqs::AssetManager assets;
+  bomaqs::init_asset_manager(assets);
+  GameAssets game_assets = queue_game_assets(assets);
+  bomaqs::wait_for_asset_decodes(assets);
+  // the dictionary is ready once decoded, it never goes through an upload
+  if (!bomaqs::asset_failed(assets, game_assets.word_dictionary)) {
+    auto& dictionary = bomaqs::get_word_dictionary(assets, game_assets.word_dictionary);
+    bomaqs::trace_startup_phase(
+        "first_level", [&] { generate_level(dictionary, GAME_DIFFICULTY, new_level_seed()); });
+  }
+  double startup_ms = bomaqs::finish_startup_trace();
 
-  char* word1 = get_random_word(word_dictionary, word1_length);
-  char* word2 = get_random_word(word_dictionary, word2_length);
+  bomaqs::unload_assets(assets);
+  CloseAudioDevice();
+  return startup_ms > budget_ms;
+}
+
+// Levels are generated on job threads, so they draw from their own generator seeded by the caller
+// instead of raylib's GetRandomValue and rand(), which share one unguarded state with the main thread
+GameLevel generate_level(const bomaqs::word_dict& word_dictionary, short difficulty,
+                         unsigned int level_seed) {
+  mt19937 rng(level_seed);
+  short word1_length = get_random_int(rng, difficulty, difficulty + 1);
+  short word2_length =
+      word1_length + get_random_int(rng, word1_length == 3 ? 0 : -1, 1);
 
-  vector<Letter> letters = generate_letters(word1, word2);
+  char* word1 = get_random_word(word_dictionary, word1_length, rng);
+  char* word2 = get_random_word(word_dictionary, word2_length, rng);
 
   Button word1_button = {
       .title = word1,
       .bounds = (Rectangle){0, SCREEN_HEIGHT - 120, (SCREEN_WIDTH / 2 - 15), 80},
-      .color = get_random_color()};
+      .color = get_random_color(rng)};
 
   Button word2_button = {
       word2,
       (Rectangle){SCREEN_WIDTH / 2, SCREEN_HEIGHT - 120, SCREEN_WIDTH / 2, 80},
-      get_random_color()};
+      get_random_color(rng)};
 
-  auto answer_order = static_cast<LevelAnswer>(GetRandomValue(0, 2));
+  auto answer_order = static_cast<LevelAnswer>(get_random_int(rng, 0, 2));
   string answer = answer_order == RIGHT_WORD ? word2 : word1;
   string seed = answer_order == BOTH_WORDS ? word2 : "";
 
@@ -215,17 +429,87 @@ GameLevel generate_level(bomaqs::word_dict word_dictionary, short difficulty) {
   return (GameLevel){
       .timer = GAME_SPEED,
       .base_word_length = difficulty,
-      .letters = generate_letters(answer, seed),
+      .letters = generate_letters(answer, seed, rng),
       .word1_button = word1_button,
       .word2_button = word2_button,
       .answer = answer_order,
   };
 }
 
+bool save_session(const GameLevel& level, int score, bool game_running) {
+  SavedLevel saved = {
+      .score = score,
+      .game_running = game_running,
+      .timer = level.timer,
+      .base_word_length = level.base_word_length,
+      .answer = level.answer,
+      .word1_bounds = level.word1_button.bounds,
+      .word2_bounds = level.word2_button.bounds,
+      .word1_color = level.word1_button.color,
+      .word2_color = level.word2_button.color,
+  };
+  // both words, each with its terminator
+  string words = string(level.word1_button.title) + '\0' + level.word2_button.title + '\0';
+
+  bomaqs::SessionWriter writer;
+  bomaqs::begin_session(writer, SESSION_SCHEMA_VERSION);
+  bomaqs::add_session_records(writer, "LEVL", &saved, 1);
+  bomaqs::add_session_records(writer, "LETR", level.letters.data(), level.letters.size());
+  bomaqs::add_session_section(writer, "WORD", words.data(), words.size());
+  return bomaqs::write_session(writer, bomaqs::session_path("word-scramble").data());
+}
+
+bool load_session(GameLevel& level, int& score, bool& game_running) {
+  bomaqs::SessionFile session;
+  if (!bomaqs::open_session(session, bomaqs::session_path("word-scramble").data(),
+                            SESSION_SCHEMA_VERSION)) {
+    return false;
+  }
+
+  int saved_count = 0, letter_count = 0;
+  uint32_t words_size = 0;
+  auto saved = bomaqs::session_records<SavedLevel>(session, "LEVL", &saved_count);
+  auto letters = bomaqs::session_records<Letter>(session, "LETR", &letter_count);
+  auto words = (const char*)bomaqs::session_section(session, "WORD", 0, &words_size);
+
+  // two terminated words, the second ending the section
+  const char* word2 = words ? (const char*)memchr(words, '\0', words_size) : NULL;
+  bool valid = saved_count == 1 && letters && word2 && word2 + 1 < words + words_size &&
+               words[words_size - 1] == '\0';
+  if (valid) {
+    word2 += 1;
+    score = saved->score;
+    game_running = saved->game_running;
+    level = (GameLevel){
+        .timer = saved->timer,
+        .base_word_length = saved->base_word_length,
+        .letters = vector<Letter>(letters, letters + letter_count),
+        .word1_button = {strcpy(new char[strlen(words) + 1], words), saved->word1_bounds,
+                         saved->word1_color},
+        .word2_button = {strcpy(new char[strlen(word2) + 1], word2), saved->word2_bounds,
+                         saved->word2_color},
+        .answer = saved->answer,
+    };
+  }
+  bomaqs::close_session(session);
+  return valid;
+}
+
 void draw_background(Texture2D background) {
   DrawTextureEx(background, (Vector2){0, 0}, 0.0f, 0.5f, WHITE);
 }
 
+void draw_loading(float progress, bool failed) {
+  if (failed) {
+    const char *text = "Couldn't load the word list";
+    DrawText(text, (SCREEN_WIDTH - MeasureText(text, 20)) / 2, SCREEN_HEIGHT / 2, 20, MAROON);
+    return;
+  }
+  Rectangle bar = {SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2, SCREEN_WIDTH / 2, 8};
+  DrawRectangleRec((Rectangle){bar.x, bar.y, bar.width * progress, bar.height}, LIGHTGRAY);
+  DrawRectangleLinesEx(bar, 1, GRAY);
+}
+
 void draw_level(GameLevel level, Font letter_font, Font button_font) {
   // Draw letters
   int count_letters = level.letters.size();
@@ -287,13 +571,20 @@ void draw_game_over(int score, string message) {
   DrawText(scoreMessage.data(), 180, 420, REGULAR_SIZE, ORANGE);
 }
 
-char* get_random_word(bomaqs::word_dict word_dictionary, short length) {
+// Seeds a level from the main thread
+unsigned int new_level_seed() { return random_device{}(); }
+
+int get_random_int(mt19937& rng, int min, int max) {
+  return uniform_int_distribution<int>(min, max)(rng);
+}
+
+char* get_random_word(const bomaqs::word_dict& word_dictionary, short length, mt19937& rng) {
   // Get random word from list of words of given length
-  auto wordList = word_dictionary[length];
-  unsigned int index = rand() % (wordList.size() - 1);
+  auto& wordList = word_dictionary.at(length);
+  unsigned int index = get_random_int(rng, 0, wordList.size() - 2);
   string word = (string)wordList[index];
 
-  char* buffer = new char[length];
+  char* buffer = new char[length + 1];
   strcpy(buffer, word.c_str());
 
   return buffer;
@@ -302,29 +593,27 @@ char* get_random_word(bomaqs::word_dict word_dictionary, short length) {
 Color color_list[10] = {RED,       MAROON,   BLUE,  VIOLET, DARKGRAY,
                         DARKGREEN, DARKBLUE, BLACK, PURPLE, MAGENTA};
 
-Color get_random_color() { return color_list[GetRandomValue(0, 9)]; }
+Color get_random_color(mt19937& rng) { return color_list[get_random_int(rng, 0, 9)]; }
 
-vector<Letter> generate_letters(string answer, string seed) {
+vector<Letter> generate_letters(string answer, string seed, mt19937& rng) {
   string shuffled_word = answer;
   string modifier = seed;
 
   // Letters get shuffled
-  random_device rd;
-  mt19937 g(rd());
-  shuffle(modifier.begin(), modifier.end(), g);
+  shuffle(modifier.begin(), modifier.end(), rng);
   shuffled_word.append(modifier.substr(0, 3));
-  shuffle(shuffled_word.begin(), shuffled_word.end(), g);
+  shuffle(shuffled_word.begin(), shuffled_word.end(), rng);
 
   vector<Letter> letters = {};
   int row = 160;
-  int per_column = GetRandomValue(2, 3);
+  int per_column = get_random_int(rng, 2, 3);
   int column = 1;
   int count_letters = shuffled_word.length();
   for (int i = 0; i < count_letters; i++) {
     if (column == per_column) {
       row += 160;
       column = 1;
-      per_column = GetRandomValue(2, 3);
+      per_column = get_random_int(rng, 2, 3);
     } else if (i > 0) {
       column += 1;
     }
@@ -333,7 +622,7 @@ vector<Letter> generate_letters(string answer, string seed) {
         .value = shuffled_word[i],
         .x = (float)column * 120,
         .y = (float)row,
-        .color = get_random_color(),
+        .color = get_random_color(rng),
     });
   }
 
@@ -0,0 +1,72 @@
+// Dodge Machina's saved session: a world 900 scripted ticks into a game comes back with the same
+// state and stays in lockstep with the original. A session from the schema version before is
+// ignored.
+//
+// Usage: session-dodge-machina-test
+//
+// Run from the repository root, shooter patterns are read from resources/patterns. Exits 1 on the
+// first failed check, printing it.
+
+#define BOMAQS_NO_MAIN
+#include "dodge-machina.cpp"
+
+#include "session-test.hpp"
+
+#define TEST_TICKS (FRAME_RATE * 15)
+#define TEST_LOCKSTEP_TICKS (FRAME_RATE * 5)
+
+// Same script as run_hash_ticks
+TickInput test_tick_input(int tick, unsigned int &script, const bomaqs::PatternLibrary &patterns) {
+  script = script * 1664525 + 1013904223;
+  return {
+      .taps = tick % HASH_RUN_TAP_TICKS == 0,
+      .tap_positions = {{(float)((script >> 8) % SCREEN_WIDTH),
+                         (float)((script >> 20) % SCREEN_HEIGHT)}},
+      .in_background = false,
+      .frame_time = 1.0f / FRAME_RATE,
+      .patterns = &patterns,
+  };
+}
+
+int check_session(const bomaqs::PatternLibrary &patterns) {
+  static GameWorld world, loaded;
+  reset_game_world(world, HASH_RUN_SEED);
+  unsigned int script = HASH_RUN_SEED;
+  int tick = 1;
+  for (; tick <= TEST_TICKS; tick++) {
+    update_game_world(world, test_tick_input(tick, script, patterns));
+  }
+
+  TEST_CHECK(save_session(world));
+  TEST_CHECK(load_session(loaded));
+  TEST_CHECK(hash_game_world(loaded) == hash_game_world(world));
+
+  // Both play on from the same inputs
+  for (; tick <= TEST_TICKS + TEST_LOCKSTEP_TICKS; tick++) {
+    TickInput input = test_tick_input(tick, script, patterns);
+    update_game_world(world, input);
+    update_game_world(loaded, input);
+    if (hash_game_world(loaded) != hash_game_world(world)) {
+      printf("tick %d: loaded world left lockstep\n", tick);
+      return 1;
+    }
+  }
+
+  make_session_stale(bomaqs::session_path("dodge-machina"));
+  TEST_CHECK(!load_session(loaded));
+  return 0;
+}
+
+int main() {
+  SetTraceLogLevel(LOG_ERROR);
+  bomaqs::init_job_system(bomaqs::job_system);
+  bomaqs::PatternLibrary patterns = bomaqs::load_pattern_library(shooter_patterns);
+  enter_test_directory("bomaqs-session-dodge-machina");
+
+  int status = check_session(patterns);
+  bomaqs::shutdown_job_system(bomaqs::job_system);
+  if (status == 0) {
+    printf("dodge-machina session round trip held lockstep for %d ticks\n", TEST_LOCKSTEP_TICKS);
+  }
+  return status;
+}
@@ -0,0 +1,59 @@
+// Shuriken Dash's saved session: a world 900 scripted ticks in comes back with the same state and
+// stays in lockstep with the original, a session from the schema version before is ignored.
+//
+// Usage: session-shuriken-dash-test
+//
+// Exits 1 on the first failed check, printing it.
+
+#define BOMAQS_NO_MAIN
+#include "shuriken-dash.cpp"
+
+#include "session-test.hpp"
+
+#define TEST_TICKS (FRAME_RATE * 15)
+#define TEST_LOCKSTEP_TICKS (FRAME_RATE * 5)
+
+// Same script as RunHashTicks
+TickInput TestTickInput(int tick, int *lastGesture) {
+  int gesture = (tick / HASH_RUN_HOLD_TICKS) % 2 ? GESTURE_HOLD : GESTURE_NONE;
+  TickInput input = {gesture, *lastGesture, 1.0f / FRAME_RATE};
+  *lastGesture = gesture;
+  return input;
+}
+
+int main() {
+  SetTraceLogLevel(LOG_ERROR);
+  enter_test_directory("bomaqs-session-shuriken-dash");
+
+  GameWorld world = CreateWorld(HASH_RUN_SEED);
+  int lastGesture = GESTURE_NONE;
+  int tick = 1;
+  for (; tick <= TEST_TICKS; tick++) {
+    UpdateWorld(&world, TestTickInput(tick, &lastGesture));
+    if (world.player.state == PLAYER_STATE_DEAD) {
+      world = CreateWorld(world.rng);
+    }
+  }
+
+  GameWorld loaded = CreateWorld(HASH_RUN_SEED + 1);
+  TEST_CHECK(SaveSession(&world));
+  TEST_CHECK(LoadSession(&loaded));
+  TEST_CHECK(HashWorld(&loaded) == HashWorld(&world));
+
+  // Both play on from the same inputs
+  for (; tick <= TEST_TICKS + TEST_LOCKSTEP_TICKS; tick++) {
+    TickInput input = TestTickInput(tick, &lastGesture);
+    UpdateWorld(&world, input);
+    UpdateWorld(&loaded, input);
+    if (HashWorld(&loaded) != HashWorld(&world)) {
+      printf("tick %d: loaded world left lockstep\n", tick);
+      return 1;
+    }
+  }
+
+  make_session_stale(bomaqs::session_path("shuriken-dash"));
+  TEST_CHECK(!LoadSession(&loaded));
+
+  printf("shuriken-dash session round trip held lockstep for %d ticks\n", TEST_LOCKSTEP_TICKS);
+  return 0;
+}
@@ -0,0 +1,139 @@
+// Session file format: record and raw sections come back in place, and files a game can't trust are
+// rejected: another schema version, another record size, another format, cut short anywhere.
+//
+// Usage: session-test
+//
+// Exits 1 on the first failed check, printing it.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "session-test.hpp"
+
+#define TEST_SCHEMA_VERSION 3
+#define TEST_RECORDS 37  // an odd count, the next section starts after padding
+#define TEST_SESSION "session-test.bin"
+#define TEST_TRUNCATED "session-truncated.bin"
+
+typedef struct {
+  int id;
+  float x, y;
+  uint16_t flags;
+} TestRecord;
+
+// Saved under the same tag by an older layout
+typedef struct {
+  int id;
+  float x, y, z;
+  uint16_t flags;
+} OldRecord;
+
+static const char test_text[] = "raw bytes, no records";
+
+void write_test_session(uint32_t schema_version, const std::vector<TestRecord> &records) {
+  bomaqs::SessionWriter writer;
+  bomaqs::begin_session(writer, schema_version);
+  bomaqs::add_session_records(writer, "RECS", records.data(), records.size());
+  bomaqs::add_session_section(writer, "TEXT", test_text, sizeof(test_text));
+  bomaqs::write_session(writer, TEST_SESSION);
+}
+
+// Opens path and closes it again, whether it was accepted
+bool session_opens(const char *path, uint32_t schema_version) {
+  bomaqs::SessionFile session;
+  bool opened = bomaqs::open_session(session, path, schema_version);
+  bomaqs::close_session(session);
+  return opened;
+}
+
+int check_round_trip(const std::vector<TestRecord> &records) {
+  bomaqs::SessionFile session;
+  TEST_CHECK(bomaqs::open_session(session, TEST_SESSION, TEST_SCHEMA_VERSION));
+
+  int count = 0;
+  const TestRecord *saved = bomaqs::session_records<TestRecord>(session, "RECS", &count);
+  TEST_CHECK(saved && count == TEST_RECORDS);
+  TEST_CHECK(memcmp(saved, records.data(), sizeof(TestRecord) * count) == 0);
+  // read in place, aligned for any record
+  TEST_CHECK((const unsigned char *)saved >= session.data &&
+             (const unsigned char *)(saved + count) <= session.data + session.size);
+  TEST_CHECK((uintptr_t)saved % SESSION_ALIGNMENT == 0);
+
+  uint32_t size = 0;
+  auto text = (const char *)bomaqs::session_section(session, "TEXT", 0, &size);
+  TEST_CHECK(text && size == sizeof(test_text) && memcmp(text, test_text, size) == 0);
+  TEST_CHECK((uintptr_t)text % SESSION_ALIGNMENT == 0);
+
+  TEST_CHECK(!bomaqs::session_section(session, "NONE", 0, &size));
+  TEST_CHECK(!bomaqs::session_records<OldRecord>(session, "RECS", &count) && count == 0);
+  bomaqs::close_session(session);
+  return 0;
+}
+
+int main() {
+  SetTraceLogLevel(LOG_ERROR);
+  enter_test_directory("bomaqs-session-test");
+
+  std::vector<TestRecord> records(TEST_RECORDS);
+  for (int i = 0; i < TEST_RECORDS; i++) {
+    records[i] = {i, i * 0.5f, -i * 2.0f, (uint16_t)(i * 977)};
+  }
+  write_test_session(TEST_SCHEMA_VERSION, records);
+  TEST_CHECK(!std::filesystem::exists(TEST_SESSION ".tmp"));
+  if (check_round_trip(records)) {
+    return 1;
+  }
+
+  // Saving again replaces the file
+  records[0].id = -1;
+  write_test_session(TEST_SCHEMA_VERSION, records);
+  if (check_round_trip(records)) {
+    return 1;
+  }
+
+  TEST_CHECK(!session_opens(TEST_SESSION, TEST_SCHEMA_VERSION + 1));
+  TEST_CHECK(!session_opens(TEST_SESSION, TEST_SCHEMA_VERSION - 1));
+  TEST_CHECK(!session_opens("session-missing.bin", TEST_SCHEMA_VERSION));
+
+  // Cut anywhere before the end of the last section's data
+  std::vector<unsigned char> bytes = read_test_file(TEST_SESSION);
+  auto header = (bomaqs::SessionHeader *)bytes.data();
+  auto sections = (bomaqs::SessionSection *)(bytes.data() + sizeof(bomaqs::SessionHeader));
+  size_t end = 0;
+  for (uint32_t i = 0; i < header->section_count; i++) {
+    end = std::max(end, (size_t)sections[i].offset + sections[i].size);
+  }
+  for (size_t size = 0; size < end; size++) {
+    std::vector<unsigned char> truncated(bytes.begin(), bytes.begin() + size);
+    write_test_file(TEST_TRUNCATED, truncated);
+    if (session_opens(TEST_TRUNCATED, TEST_SCHEMA_VERSION)) {
+      printf("session cut to %zu of %zu bytes was accepted\n", size, end);
+      return 1;
+    }
+  }
+
+  // Damaged headers and section tables
+  std::vector<unsigned char> damaged = bytes;
+  damaged[0] ^= 0xff;
+  write_test_file(TEST_TRUNCATED, damaged);
+  TEST_CHECK(!session_opens(TEST_TRUNCATED, TEST_SCHEMA_VERSION));
+
+  damaged = bytes;
+  ((bomaqs::SessionHeader *)damaged.data())->format_version += 1;
+  write_test_file(TEST_TRUNCATED, damaged);
+  TEST_CHECK(!session_opens(TEST_TRUNCATED, TEST_SCHEMA_VERSION));
+
+  damaged = bytes;
+  ((bomaqs::SessionSection *)(damaged.data() + sizeof(bomaqs::SessionHeader)))->offset += 1;
+  write_test_file(TEST_TRUNCATED, damaged);
+  TEST_CHECK(!session_opens(TEST_TRUNCATED, TEST_SCHEMA_VERSION));
+
+  damaged = bytes;
+  ((bomaqs::SessionSection *)(damaged.data() + sizeof(bomaqs::SessionHeader)))->item_size += 1;
+  write_test_file(TEST_TRUNCATED, damaged);
+  TEST_CHECK(!session_opens(TEST_TRUNCATED, TEST_SCHEMA_VERSION));
+
+  printf("session format checked: round trips, %zu truncations, stale and damaged files\n", end);
+  return 0;
+}
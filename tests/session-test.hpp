@@ -0,0 +1,50 @@
+#pragma once
+
+#include <raylib.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "utils/session.hpp"
+
+// Shared by the session tests: a scratch directory to save sessions into and files edited on disk.
+
+// Prints the failed check and fails the test
+#define TEST_CHECK(condition)                                        \
+  if (!(condition)) {                                                \
+    printf("%s:%d: failed %s\n", __FILE__, __LINE__, #condition);   \
+    return 1;                                                        \
+  }
+
+// Games save to the working directory, tests run in an empty one of their own so a player's session
+// is never touched. Resources have to be loaded before.
+inline void enter_test_directory(const char *name) {
+  std::filesystem::path directory = std::filesystem::temp_directory_path() / name;
+  std::filesystem::remove_all(directory);
+  std::filesystem::create_directories(directory);
+  std::filesystem::current_path(directory);
+}
+
+inline std::vector<unsigned char> read_test_file(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::vector<unsigned char>(std::istreambuf_iterator<char>(file),
+                                    std::istreambuf_iterator<char>());
+}
+
+inline void write_test_file(const std::string &path, const std::vector<unsigned char> &bytes) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write((const char *)bytes.data(), bytes.size());
+}
+
+// Rewrites a saved session as if the schema version before wrote it
+inline void make_session_stale(const std::string &path) {
+  std::vector<unsigned char> bytes = read_test_file(path);
+  if (bytes.size() >= sizeof(bomaqs::SessionHeader)) {
+    ((bomaqs::SessionHeader *)bytes.data())->schema_version -= 1;
+  }
+  write_test_file(path, bytes);
+}
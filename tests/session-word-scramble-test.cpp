@@ -0,0 +1,74 @@
+// Word Scramble's saved session: a level, the score and whether it was running come back as saved,
+// letters and both words included, a session from the schema version before is ignored.
+//
+// Usage: session-word-scramble-test
+//
+// Run from the repository root, levels are generated from resources/word-list.txt. Exits 1 on the
+// first failed check, printing it.
+
+#define BOMAQS_NO_MAIN
+#include "word-scramble.cpp"
+
+#include "session-test.hpp"
+
+#define TEST_DICTIONARY "word-list.txt"
+#define TEST_SEED 7
+
+bool same_color(Color a, Color b) { return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a; }
+
+bool same_bounds(Rectangle a, Rectangle b) {
+  return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+bool same_button(const Button& a, const Button& b) {
+  return strcmp(a.title, b.title) == 0 && same_bounds(a.bounds, b.bounds) &&
+         same_color(a.color, b.color);
+}
+
+int check_round_trip(const GameLevel& level, int score, bool game_running) {
+  TEST_CHECK(save_session(level, score, game_running));
+
+  GameLevel loaded = {};
+  int loaded_score = -1;
+  bool loaded_running = !game_running;
+  TEST_CHECK(load_session(loaded, loaded_score, loaded_running));
+  TEST_CHECK(loaded_score == score && loaded_running == game_running);
+  TEST_CHECK(loaded.timer == level.timer && loaded.base_word_length == level.base_word_length &&
+             loaded.answer == level.answer);
+  TEST_CHECK(same_button(loaded.word1_button, level.word1_button));
+  TEST_CHECK(same_button(loaded.word2_button, level.word2_button));
+  TEST_CHECK(loaded.letters.size() == level.letters.size());
+  for (size_t i = 0; i < level.letters.size(); i++) {
+    const Letter& a = loaded.letters[i];
+    const Letter& b = level.letters[i];
+    TEST_CHECK(a.value == b.value && a.x == b.x && a.y == b.y && same_color(a.color, b.color));
+  }
+  return 0;
+}
+
+int main() {
+  SetTraceLogLevel(LOG_ERROR);
+  bomaqs::word_dict dictionary = bomaqs::load_word_dictionary(TEST_DICTIONARY);
+  TEST_CHECK(!dictionary.empty());
+  enter_test_directory("bomaqs-session-word-scramble");
+
+  // A level part way through and a game over screen
+  GameLevel level = generate_level(dictionary, GAME_DIFFICULTY, TEST_SEED);
+  level.timer = GAME_SPEED * 0.4f;
+  if (check_round_trip(level, 12, true)) {
+    return 1;
+  }
+  level = generate_level(dictionary, GAME_DIFFICULTY + 2, TEST_SEED + 1);
+  level.timer = 0;
+  if (check_round_trip(level, 0, false)) {
+    return 1;
+  }
+
+  int score = 0;
+  bool game_running = false;
+  make_session_stale(bomaqs::session_path("word-scramble"));
+  TEST_CHECK(!load_session(level, score, game_running));
+
+  printf("word-scramble session round trips matched\n");
+  return 0;
+}
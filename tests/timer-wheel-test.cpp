@@ -0,0 +1,169 @@
+// Timer wheel against a reference model: random starts, cancels, reschedules and restarts from fire
+// callbacks, checked tick by tick against a plain map of when each timer should fire.
+//
+// Usage: timer-wheel-test [operations] [seed]
+//
+// Exits 1 on the first mismatch, printing the tick and the timers that differ.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "utils/timer-wheel.hpp"
+
+#define TEST_TIMERS 4096
+#define TEST_OPERATIONS 200000
+
+typedef struct {
+  bomaqs::TimerHandle handle;
+  uint32_t expires;  // as started, 0 tick timers expire on the tick they start
+  uint32_t fires;    // tick it has to fire on
+} ModelTimer;
+
+static bomaqs::TimerWheel<TEST_TIMERS> wheel;
+static std::map<uint32_t, ModelTimer> model;  // by id, the timer's data word
+static std::mt19937 rng;
+static uint32_t next_id = 1;
+static long long fired_total = 0;
+
+// Mostly short, some a turn or more of a level ahead, a few past the lower levels
+uint32_t random_ticks() {
+  switch (rng() % 8) {
+    case 0:
+      return 0;
+    case 1:
+      return TIMER_WHEEL_SLOTS * (1 + rng() % 3);
+    case 2:
+      return TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS * (1 + rng() % 2) + rng() % 3 - 1;
+    case 3:
+      return rng() % (TIMER_WHEEL_SLOTS * TIMER_WHEEL_SLOTS * 4);
+    default:
+      return rng() % (TIMER_WHEEL_SLOTS * 2);
+  }
+}
+
+// Overdue timers fire on the next tick
+ModelTimer model_timer(bomaqs::TimerHandle handle, uint32_t ticks) {
+  return {handle, wheel.now + ticks, wheel.now + std::max(ticks, 1u)};
+}
+
+void start(uint32_t ticks) {
+  uint32_t id = next_id++;
+  bomaqs::TimerHandle handle = bomaqs::start_timer(wheel, ticks, 0, id);
+  if (handle.generation) {
+    model[id] = model_timer(handle, ticks);
+  }
+}
+
+bool check_tick(uint32_t tick, std::vector<uint32_t> &fired) {
+  std::vector<uint32_t> expected;
+  for (auto &entry : model) {
+    if (entry.second.fires == tick) {
+      expected.push_back(entry.first);
+    }
+  }
+  std::sort(fired.begin(), fired.end());
+  if (fired == expected) {
+    for (uint32_t id : expected) {
+      if (bomaqs::timer_active(wheel, model[id].handle)) {
+        printf("tick %u: timer %u still active after firing\n", tick, id);
+        return false;
+      }
+      model.erase(id);
+    }
+    fired_total += expected.size();
+    return true;
+  }
+
+  printf("tick %u: fired", tick);
+  for (uint32_t id : fired) {
+    printf(" %u", id);
+  }
+  printf(", expected");
+  for (uint32_t id : expected) {
+    printf(" %u (started for %u)", id, model[id].fires);
+  }
+  printf("\n");
+  return false;
+}
+
+int main(int argc, char **argv) {
+  int operations = argc > 1 ? atoi(argv[1]) : TEST_OPERATIONS;
+  rng.seed(argc > 2 ? atoi(argv[2]) : 1);
+  bomaqs::init_timer_wheel(wheel, rng());
+
+  for (int operation = 0; operation < operations; operation++) {
+    int choice = rng() % 10;
+    if (choice < 4 || model.empty()) {
+      start(random_ticks());
+      continue;
+    }
+
+    auto entry = model.begin();
+    std::advance(entry, rng() % model.size());
+    uint32_t id = entry->first;
+    ModelTimer &timer = entry->second;
+    if (choice == 4) {
+      if (!bomaqs::cancel_timer(wheel, timer.handle)) {
+        printf("timer %u couldn't be cancelled\n", id);
+        return 1;
+      }
+      model.erase(entry);
+    } else if (choice == 5) {
+      uint32_t ticks = random_ticks();
+      if (!bomaqs::reschedule_timer(wheel, timer.handle, ticks)) {
+        printf("timer %u couldn't be rescheduled\n", id);
+        return 1;
+      }
+      timer = model_timer(timer.handle, ticks);
+    } else if (choice == 6) {
+      uint32_t remaining = bomaqs::timer_remaining(wheel, timer.handle);
+      uint32_t expected = (int32_t)(timer.expires - wheel.now) > 0 ? timer.expires - wheel.now : 0;
+      if (remaining != expected) {
+        printf("timer %u has %u ticks left, expected %u\n", id, remaining, expected);
+        return 1;
+      }
+    } else {
+      // Tick by tick so every timer is checked on the tick it fires, some restart from their fire
+      uint32_t steps = 1 + rng() % 40;
+      for (uint32_t step = 0; step < steps; step++) {
+        std::vector<uint32_t> fired;
+        bomaqs::advance_timers(wheel, wheel.now + 1, [&](uint32_t, uint32_t data) {
+          fired.push_back(data);
+          if (rng() % 4 == 0) {
+            start(random_ticks());
+          }
+        });
+        if (!check_tick(wheel.now, fired)) {
+          return 1;
+        }
+      }
+    }
+  }
+
+  // Everything left fires where the model says, however far out. Jumps to the next timer due, a
+  // timer firing early on the way shows up as a mismatch there.
+  while (!model.empty()) {
+    uint32_t wait = UINT32_MAX;
+    for (auto &entry : model) {
+      wait = std::min(wait, entry.second.fires - wheel.now);
+    }
+    std::vector<uint32_t> fired;
+    bomaqs::advance_timers(wheel, wheel.now + wait,
+                           [&](uint32_t, uint32_t data) { fired.push_back(data); });
+    if (!check_tick(wheel.now, fired)) {
+      return 1;
+    }
+  }
+  if (wheel.active != 0) {
+    printf("%d timers left in the wheel after the model ran dry\n", wheel.active);
+    return 1;
+  }
+
+  printf("timer wheel matched the model: %d operations, %lld timers fired\n", operations,
+         fired_total);
+  return 0;
+}
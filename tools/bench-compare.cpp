@@ -0,0 +1,119 @@
+// Compares benchmark results written by the bench-* suites (bench/bench.hpp) against a baseline.
+//
+// Usage: bench-compare <baseline.json> <results.json> [--threshold percent] [--gate word,...]
+//
+// Both files are matched by suite, bench name and size. Benches slower than the baseline by more
+// than the threshold (default 10%) are flagged and make it exit 1, faster ones are only reported.
+// Benches missing from either side are listed, they never fail the comparison. Several suites can
+// be compared at once by concatenating their results, one result per line is all it reads.
+//
+// With --gate only benches whose name ends in one of the words can fail, the rest are reported.
+// "--gate p50,p99" keeps a scenario's max tick, a single outlier, out of the verdict.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#define BENCH_DEFAULT_THRESHOLD 10  // percent
+
+typedef std::tuple<std::string, std::string, int> BenchKey;  // suite, name, size
+
+bool read_bench_results(const char *path, std::map<BenchKey, double> &results) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    fprintf(stderr, "error: [%s] can't open\n", path);
+    return false;
+  }
+
+  char line[512];
+  while (fgets(line, sizeof(line), file)) {
+    char suite[128], name[128];
+    int size = 0;
+    double ns_per_op = 0;
+    if (sscanf(line,
+               " {\"suite\": \"%127[^\"]\", \"name\": \"%127[^\"]\", \"size\": %d, "
+               "\"ns_per_op\": %lf",
+               suite, name, &size, &ns_per_op) == 4) {
+      results[{suite, name, size}] = ns_per_op;
+    }
+  }
+  fclose(file);
+  return true;
+}
+
+// No words gates every bench
+bool bench_gated(const std::string &name, const std::vector<std::string> &gate) {
+  if (gate.empty()) {
+    return true;
+  }
+  for (auto &word : gate) {
+    size_t at = name.size() - std::min(name.size(), word.size());
+    if (name.compare(at, std::string::npos, word) == 0 && (at == 0 || name[at - 1] == ' ')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    printf("usage: %s <baseline.json> <results.json> [--threshold percent] [--gate word,...]\n",
+           argv[0]);
+    return 1;
+  }
+  double threshold = BENCH_DEFAULT_THRESHOLD;
+  std::vector<std::string> gate;
+  for (int i = 3; i + 1 < argc; i++) {
+    threshold = strcmp(argv[i], "--threshold") == 0 ? atof(argv[i + 1]) : threshold;
+    if (strcmp(argv[i], "--gate") == 0) {
+      std::stringstream words(argv[i + 1]);
+      for (std::string word; std::getline(words, word, ',');) {
+        gate.push_back(word);
+      }
+    }
+  }
+
+  std::map<BenchKey, double> baseline, current;
+  if (!read_bench_results(argv[1], baseline) || !read_bench_results(argv[2], current)) {
+    return 1;
+  }
+
+  int regressions = 0;
+  printf("%-16s %-32s %8s %14s %14s %9s\n", "suite", "bench", "size", "baseline ns", "current ns",
+         "change");
+  for (auto &[key, ns_per_op] : current) {
+    auto &[suite, name, size] = key;
+    auto base = baseline.find(key);
+    if (base == baseline.end()) {
+      printf("%-16s %-32s %8d %14s %14.1f %9s\n", suite.data(), name.data(), size, "-", ns_per_op,
+             "new");
+      continue;
+    }
+
+    double change = base->second > 0 ? (ns_per_op / base->second - 1) * 100 : 0;
+    bool regressed = change > threshold && bench_gated(name, gate);
+    regressions += regressed;
+    printf("%-16s %-32s %8d %14.1f %14.1f %+8.1f%%%s\n", suite.data(), name.data(), size,
+           base->second, ns_per_op, change, regressed ? "  REGRESSED" : "");
+  }
+  for (auto &[key, ns_per_op] : baseline) {
+    if (!current.count(key)) {
+      printf("%-16s %-32s %8d %14.1f %14s %9s\n", std::get<0>(key).data(), std::get<1>(key).data(),
+             std::get<2>(key), ns_per_op, "-", "missing");
+    }
+  }
+
+  if (regressions) {
+    printf("%d benches more than %.0f%% slower than the baseline\n", regressions, threshold);
+    return 1;
+  }
+  printf("No %sbench more than %.0f%% slower than the baseline\n", gate.empty() ? "" : "gated ",
+         threshold);
+  return 0;
+}
@@ -0,0 +1,139 @@
+// Packs a game's assets into a single bundle (see src/utils/asset-bundle.hpp).
+//
+// Usage: bundle-assets <list-file> <resources-dir> <out-dir>
+//
+// The list file names one asset per line, relative to resources-dir. Assets are written to
+// <out-dir>/<list name>.pak, music streams are copied next to it as loose files since raylib
+// streams them from disk. Prints loose vs bundled sizes so web preload savings can be compared.
+
+#include <raylib.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "utils/asset-bundle.hpp"
+
+namespace fs = std::filesystem;
+
+typedef struct {
+  std::string name;
+  std::vector<unsigned char> payload;
+  uint32_t raw_size;
+  uint32_t flags;
+} PackedFile;
+
+bool is_streamed(std::string name) {
+  std::string ext = fs::path(name).extension().string();
+  return ext == ".mp3" || ext == ".ogg" || ext == ".flac" || ext == ".xm" || ext == ".mod";
+}
+
+int main(int argc, char **argv) {
+  if (argc != 4) {
+    printf("usage: %s <list-file> <resources-dir> <out-dir>\n", argv[0]);
+    return 1;
+  }
+
+  SetTraceLogLevel(LOG_WARNING);
+  fs::path list_path = argv[1];
+  fs::path resources_dir = argv[2];
+  fs::path out_dir = argv[3];
+  fs::create_directories(out_dir);
+
+  std::vector<PackedFile> packed;
+  size_t loose_total = 0;
+  size_t streamed_total = 0;
+
+  std::ifstream list(list_path);
+  std::string name;
+  while (std::getline(list, name)) {
+    if (name.empty() || name[0] == '#') {
+      continue;
+    }
+    if (name.size() >= BUNDLE_NAME_LENGTH) {
+      printf("error: [%s] name longer than %d chars\n", name.data(), BUNDLE_NAME_LENGTH - 1);
+      return 1;
+    }
+
+    fs::path source = resources_dir / name;
+    if (!fs::exists(source)) {
+      // music isn't always checked in, the game already copes with a missing stream
+      if (is_streamed(name)) {
+        printf("  %-40s    missing  skipped\n", name.data());
+        continue;
+      }
+      printf("error: [%s] not found\n", source.string().data());
+      return 1;
+    }
+    loose_total += fs::file_size(source);
+
+    if (is_streamed(name)) {
+      fs::copy_file(source, out_dir / name, fs::copy_options::overwrite_existing);
+      streamed_total += fs::file_size(source);
+      printf("  %-40s %10ju  loose (streamed)\n", name.data(), (uintmax_t)fs::file_size(source));
+      continue;
+    }
+
+    unsigned int size = 0;
+    unsigned char *data = LoadFileData(source.string().data(), &size);
+
+    PackedFile file = {name, std::vector<unsigned char>(data, data + size), size, 0};
+
+    // keep DEFLATE only when it pays off, images and wav headers often don't shrink much
+    int compressed_size = 0;
+    unsigned char *compressed = CompressData(data, size, &compressed_size);
+    if (compressed && compressed_size < size * 0.9f) {
+      file.payload.assign(compressed, compressed + compressed_size);
+      file.flags |= BUNDLE_DEFLATE;
+    }
+    free(compressed);
+    UnloadFileData(data);
+
+    printf("  %-40s %10u -> %10zu%s\n", name.data(), size, file.payload.size(),
+           (file.flags & BUNDLE_DEFLATE) ? "  deflate" : "");
+    packed.push_back(file);
+  }
+
+  // runtime lookups binary search the index by name
+  std::sort(packed.begin(), packed.end(),
+            [](const PackedFile &a, const PackedFile &b) { return a.name < b.name; });
+
+  bomaqs::BundleHeader header = {};
+  memcpy(header.magic, BUNDLE_MAGIC, 4);
+  header.version = BUNDLE_VERSION;
+  header.entry_count = packed.size();
+
+  std::vector<bomaqs::BundleEntry> entries(packed.size());
+  uint32_t offset = sizeof(header) + (entries.size() * sizeof(bomaqs::BundleEntry));
+  for (size_t i = 0; i < packed.size(); i++) {
+    offset = (offset + BUNDLE_ALIGNMENT - 1) & ~(BUNDLE_ALIGNMENT - 1);
+    strncpy(entries[i].name, packed[i].name.data(), BUNDLE_NAME_LENGTH - 1);
+    entries[i].offset = offset;
+    entries[i].size = packed[i].payload.size();
+    entries[i].raw_size = packed[i].raw_size;
+    entries[i].flags = packed[i].flags;
+    offset += entries[i].size;
+  }
+
+  fs::path out_path = out_dir / list_path.stem().concat(".pak");
+  std::ofstream out(out_path, std::ios::binary);
+  out.write((const char *)&header, sizeof(header));
+  out.write((const char *)entries.data(), entries.size() * sizeof(bomaqs::BundleEntry));
+  for (size_t i = 0; i < packed.size(); i++) {
+    // zero padding up to the aligned payload offset
+    while ((uint32_t)out.tellp() < entries[i].offset) {
+      out.put(0);
+    }
+    out.write((const char *)packed[i].payload.data(), packed[i].payload.size());
+  }
+  out.close();
+
+  size_t bundle_size = fs::file_size(out_path);
+  printf("%s: %zu files, loose %zu bytes -> bundle %zu + streamed %zu bytes (%.1f%%)\n",
+         out_path.string().data(), packed.size(), loose_total, bundle_size, streamed_total,
+         100.0f * (bundle_size + streamed_total) / std::max<size_t>(loose_total, 1));
+  return 0;
+}
@@ -0,0 +1,85 @@
+// Decodes telemetry logs written by src/utils/telemetry.hpp into CSV on stdout.
+//
+// Usage: telemetry-decode <telemetry-file>...
+//
+// Pass rotated files oldest first (telemetry-<game>.bin.2 .bin.1 .bin) to keep sessions in order.
+// A file holds one header per session followed by its records, records from different threads of
+// a session are interleaved by flush, sort by session and time_us to get them in order.
+
+#include <cstdio>
+#include <cstring>
+
+#include "utils/telemetry.hpp"
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    printf("usage: %s <telemetry-file>...\n", argv[0]);
+    return 1;
+  }
+
+  printf("game,session,time_us,thread,sequence,event,arg0,arg1,value\n");
+
+  for (int i = 1; i < argc; i++) {
+    FILE *file = fopen(argv[i], "rb");
+    if (!file) {
+      fprintf(stderr, "error: [%s] can't open\n", argv[i]);
+      return 1;
+    }
+
+    bomaqs::TelemetryFileHeader header = {};
+    bool in_session = false;
+    char chunk[sizeof(bomaqs::TelemetryRecord)];
+    while (fread(chunk, 1, 12, file) == 12) {
+      // a session header or a record. Headers can follow any record, they're told apart by magic,
+      // version and record size, which a record would need a very unlikely time and sequence to match
+      bomaqs::TelemetryFileHeader candidate;
+      memcpy(&candidate, chunk, 12);
+      if (memcmp(candidate.magic, TELEMETRY_MAGIC, 4) == 0 &&
+          candidate.version == TELEMETRY_VERSION &&
+          candidate.record_size == sizeof(bomaqs::TelemetryRecord)) {
+        memcpy(&header, chunk, 12);
+        if (fread((char *)&header + 12, 1, sizeof(header) - 12, file) != sizeof(header) - 12) {
+          fprintf(stderr, "warning: [%s] truncated header at the end\n", argv[i]);
+          break;
+        }
+        in_session = true;
+        continue;
+      }
+
+      if (!in_session) {
+        fprintf(stderr, "error: [%s] records before a header\n", argv[i]);
+        break;
+      }
+      if (fread(chunk + 12, 1, sizeof(chunk) - 12, file) != sizeof(chunk) - 12) {
+        fprintf(stderr, "warning: [%s] truncated record at the end\n", argv[i]);
+        break;
+      }
+
+      bomaqs::TelemetryRecord record;
+      memcpy(&record, chunk, sizeof(record));
+      printf("%s,%u,%llu,%u,%u,%s,", header.game, header.session,
+             (unsigned long long)record.time_us, record.thread, record.sequence,
+             bomaqs::telemetry_event_name(record.event));
+
+      // causes are easier to read by name
+      bool arg0_is_cause =
+          record.event == bomaqs::TELEMETRY_SHIELD_LOST || record.event == bomaqs::TELEMETRY_GAME_OVER;
+      bool arg1_is_cause = record.event == bomaqs::TELEMETRY_ENEMY_KILLED;
+      if (arg0_is_cause) {
+        printf("%s,", bomaqs::telemetry_cause_name(record.arg0));
+      } else {
+        printf("%d,", record.arg0);
+      }
+      if (arg1_is_cause) {
+        printf("%s,", bomaqs::telemetry_cause_name(record.arg1));
+      } else {
+        printf("%d,", record.arg1);
+      }
+      printf("%g\n", record.value);
+    }
+
+    fclose(file);
+  }
+
+  return 0;
+}